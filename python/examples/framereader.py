@@ -0,0 +1,23 @@
+import sys
+
+import numpy
+from PyQt5 import QtCore
+import QtAV
+
+
+# print mean luma of each decoded frame. planes are wrapped by numpy without copy
+def main():
+   app = QtCore.QCoreApplication(sys.argv)
+   if len(sys.argv) < 2:
+      print("usage: framereader.py file")
+      return 1
+   reader = QtAV.FrameReader()
+   reader.setMedia(sys.argv[1])
+   for frame in reader:
+      luma = numpy.asarray(frame.plane(0))
+      print("%.3f: %dx%d mean luma %.1f" % (frame.timestamp(), frame.width(), frame.height(), luma.mean()))
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
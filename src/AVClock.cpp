@@ -19,6 +19,7 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ******************************************************************************/
 #include <QtAV/AVClock.h>
+#include <QtAV/ClockGroup.h>
 #include <QtCore/QTimer>
 #include <QtCore/QTimerEvent>
 #include <QtCore/QDateTime>
@@ -32,6 +33,8 @@ enum {
 };
 AVClock::AVClock(AVClock::ClockType c, QObject *parent):
     QObject(parent)
+  , m_group(0)
+  , has_group(0)
   , auto_clock(true)
   , m_state(kStopped)
   , clock_type(c)
@@ -47,6 +50,8 @@ AVClock::AVClock(AVClock::ClockType c, QObject *parent):
 
 AVClock::AVClock(QObject *parent):
     QObject(parent)
+  , m_group(0)
+  , has_group(0)
   , auto_clock(true)
   , m_state(kStopped)
   , clock_type(AudioClock)
@@ -75,6 +80,12 @@ AVClock::ClockType AVClock::clockType() const
 
 bool AVClock::isActive() const
 {
+    if ((int)has_group) {
+        QMutexLocker lock(&group_mutex);
+        Q_UNUSED(lock);
+        if (m_group)
+            return m_group->clock()->isActive();
+    }
     return clock_type == AudioClock || timer.isValid();
 }
 
@@ -101,7 +112,7 @@ bool AVClock::isClockAuto() const
 
 void AVClock::updateExternalClock(qint64 msecs)
 {
-    if (clock_type == AudioClock)
+    if (clock_type == AudioClock || group())
         return;
     qDebug("External clock change: %f ==> %f", value(), double(msecs) * kThousandth);
     pts_ = double(msecs) * kThousandth; //can not use msec/1000.
@@ -116,7 +127,7 @@ void AVClock::updateExternalClock(qint64 msecs)
 
 void AVClock::updateExternalClock(const AVClock &clock)
 {
-    if (clock_type != ExternalClock)
+    if (clock_type != ExternalClock || group())
         return;
     qDebug("External clock change: %f ==> %f", value(), clock.value());
     pts_ = clock.value();
@@ -127,6 +138,71 @@ void AVClock::updateExternalClock(const AVClock &clock)
     t = QDateTime::currentMSecsSinceEpoch();
 }
 
+ClockGroup* AVClock::group() const
+{
+    if (!(int)has_group)
+        return 0;
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    return m_group;
+}
+
+void AVClock::setGroup(ClockGroup *group)
+{
+    // wait for group functions in other threads
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    m_group = group;
+    has_group = group ? 1 : 0;
+}
+
+bool AVClock::groupValue(double *v) const
+{
+    if (!(int)has_group)
+        return false;
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    if (!m_group)
+        return false;
+    *v = m_group->value();
+    return true;
+}
+
+bool AVClock::groupPresentTime(qreal t, qreal *tick) const
+{
+    if (!(int)has_group)
+        return false;
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    if (!m_group)
+        return false;
+    *tick = m_group->presentTime(t);
+    return true;
+}
+
+bool AVClock::groupCheckLate(qreal tick)
+{
+    if (!(int)has_group)
+        return false;
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    if (!m_group)
+        return false;
+    return m_group->checkLate(this, tick);
+}
+
+bool AVClock::groupFramePresented(qreal t)
+{
+    if (!(int)has_group)
+        return false;
+    QMutexLocker lock(&group_mutex);
+    Q_UNUSED(lock);
+    if (!m_group)
+        return false;
+    m_group->framePresented(this, t);
+    return true;
+}
+
 void AVClock::setSpeed(qreal speed)
 {
     mSpeed = speed;
@@ -24,7 +24,9 @@
 #include "QtAV/AVClock.h"
 #include "QtAV/AVDemuxer.h"
 #include "QtAV/AVDecoder.h"
+#include "QtAV/Statistics.h"
 #include "VideoThread.h"
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTime>
 #include "utils/Logger.h"
 #include <QTimer>
@@ -32,6 +34,7 @@
 #define RESUME_ONCE_ON_SEEK 0
 
 namespace QtAV {
+static const qint64 kStandbyLead = 1000; // ms. max time a standby demuxer reads ahead of real time
 
 class AutoSem {
     QSemaphore *s;
@@ -70,6 +73,86 @@ private:
     AVDemuxThread *mDemuxThread;
 };
 
+/*
+ * Reads the external audio demuxer and puts packets to the audio queue, so a slow read of the external file does not stall
+ * the main demuxer and vice versa. AVDemuxThread::ext_mutex guards the external demuxer state. It's not held when reading,
+ * and seeking the external demuxer is requested by AVDemuxThread and done here, so a slow source (e.g. network) blocks only this thread.
+ */
+class ExternalAudioReader : public QThread
+{
+public:
+    ExternalAudioReader(AVDemuxThread *thread)
+        : QThread()
+        , dt(thread)
+        , stopped(false)
+        , last_pts(0)
+    {}
+    void stop() { stopped = true;}
+    qreal lastPts() const { return last_pts;}
+protected:
+    void run() Q_DECL_OVERRIDE {
+        stopped = false;
+        last_pts = 0;
+        int serial = -1;
+        bool pending = false;
+        Packet pkt;
+        QMutexLocker locker(&dt->ext_mutex);
+        while (!stopped && !dt->end) {
+            AVDemuxer *dmx = dt->ademuxer;
+            PacketBuffer *aqueue = dt->audio_thread ? dt->audio_thread->packetQueue() : 0;
+            // main demuxer eof: eof packet is put by AVDemuxThread. stop reading as no more video
+            if (dt->paused || !dmx || !aqueue || dt->demuxer->atEnd()) {
+                dt->ext_cond.wait(&dt->ext_mutex, 20);
+                continue;
+            }
+            if (serial != dt->ext_serial) { // seek or demuxer changed
+                serial = dt->ext_serial;
+                pending = false;
+            }
+            if (!pending) {
+                const bool seek = dt->ext_seek;
+                const qint64 seek_pos = dt->ext_seek_pos;
+                const SeekType seek_type = dt->ext_seek_type;
+                dt->ext_seek = false;
+                dt->ext_reading = true;
+                locker.unlock();
+                if (seek) {
+                    dmx->setSeekType(seek_type);
+                    dmx->seek(seek_pos);
+                }
+                const bool ok = dmx->readFrame();
+                locker.relock();
+                dt->ext_reading = false;
+                dt->ext_cond.wakeAll();
+                if (serial != dt->ext_serial) // packet read before seeking or from the old demuxer
+                    continue;
+                if (!ok) {
+                    if (dmx->atEnd())
+                        dt->ext_cond.wait(&dt->ext_mutex, 20);
+                    continue;
+                }
+                if (dmx->stream() != dmx->audioStream())
+                    continue;
+                pkt = dmx->packet();
+                pending = true;
+            }
+            // queued even if the audio thread is not running yet (e.g. standby), so audio is ready when it starts.
+            // never block in put(): ext_mutex is held
+            if (aqueue->isFull() && !aqueue->isBuffering()) {
+                dt->ext_cond.wait(&dt->ext_mutex, 10);
+                continue;
+            }
+            aqueue->put(pkt, 0);
+            last_pts = pkt.pts;
+            pending = false;
+        }
+    }
+private:
+    AVDemuxThread *dt;
+    volatile bool stopped;
+    qreal last_pts;
+};
+
 AVDemuxThread::AVDemuxThread(QObject *parent) :
     QThread(parent)
   , paused(false)
@@ -78,8 +161,16 @@ AVDemuxThread::AVDemuxThread(QObject *parent) :
   , end_action(MediaEndAction_Default)
   , m_buffering(false)
   , m_buffer(0)
+  , m_adaptive(false)
+  , m_statistics(0)
+  , m_standby(false)
   , demuxer(0)
   , ademuxer(0)
+  , ext_serial(0)
+  , ext_seek(false)
+  , ext_reading(false)
+  , ext_seek_pos(0)
+  , ext_seek_type(AccurateSeek)
   , audio_thread(0)
   , video_thread(0)
   , clock_type(-1)
@@ -98,6 +189,15 @@ AVDemuxThread::AVDemuxThread(AVDemuxer *dmx, QObject *parent) :
   , end(false)
   , m_buffering(false)
   , m_buffer(0)
+  , m_adaptive(false)
+  , m_statistics(0)
+  , m_standby(false)
+  , ademuxer(0)
+  , ext_serial(0)
+  , ext_seek(false)
+  , ext_reading(false)
+  , ext_seek_pos(0)
+  , ext_seek_type(AccurateSeek)
   , audio_thread(0)
   , video_thread(0)
   , last_seek_pos(0)
@@ -110,6 +210,27 @@ AVDemuxThread::AVDemuxThread(AVDemuxer *dmx, QObject *parent) :
     seek_tasks.blockFull(false);
 }
 
+void AVDemuxThread::setAdaptiveBuffer(bool value, bool shrink, Statistics *statistics)
+{
+    m_adaptive = value;
+    m_buffer_ctrl.setShrinkEnabled(shrink);
+    m_statistics = statistics;
+}
+
+void AVDemuxThread::setStandby(bool value)
+{
+    m_standby = value;
+    if (!value) {
+        cond.wakeAll();
+        ext_cond.wakeAll();
+    }
+}
+
+bool AVDemuxThread::isStandby() const
+{
+    return m_standby;
+}
+
 void AVDemuxThread::setDemuxer(AVDemuxer *dmx)
 {
     demuxer = dmx;
@@ -117,9 +238,15 @@ void AVDemuxThread::setDemuxer(AVDemuxer *dmx)
 
 void AVDemuxThread::setAudioDemuxer(AVDemuxer *demuxer)
 {
-    //QMutexLocker locker(&buffer_mutex);
-    //Q_UNUSED(locker);
+    QMutexLocker locker(&ext_mutex); // external audio reader
+    Q_UNUSED(locker);
+    // the old demuxer may be destroyed by caller
+    while (ext_reading && ademuxer != demuxer)
+        ext_cond.wait(&ext_mutex);
     ademuxer = demuxer;
+    ext_seek = false;
+    ++ext_serial;
+    ext_cond.wakeAll();
 }
 
 void AVDemuxThread::setAVThread(AVThread*& pOld, AVThread *pNew)
@@ -280,6 +407,9 @@ void AVDemuxThread::seek(qint64 external_pos, qint64 pos, SeekType type)
     if (video_thread) {
         video_thread->packetQueue()->clear();
     }
+    // demux thread may be blocked in MediaIO read, e.g. waiting for network data. it's reset in AVDemuxer::seek()
+    if (demuxer && demuxer->mediaIO())
+        demuxer->mediaIO()->abort();
     newSeekRequest(new SeekTask(this, external_pos, pos, type));
 }
 
@@ -289,9 +419,15 @@ void AVDemuxThread::seekInternal(qint64 pos, SeekType type, qint64 external_pos)
     qDebug("seek to %s %lld ms (%f%%)", QTime(0, 0, 0).addMSecs(pos).toString().toUtf8().constData(), pos, double(pos - demuxer->startTime())/double(demuxer->duration())*100.0);
     demuxer->setSeekType(type);
     demuxer->seek(pos);
+    // external audio reader must not put packets read before seeking after the seek packet. the seek is done in the reader
+    QMutexLocker locker(&ext_mutex);
+    Q_UNUSED(locker);
     if (ademuxer) {
-        ademuxer->setSeekType(type);
-        ademuxer->seek(pos);
+        ext_seek = true;
+        ext_seek_pos = pos;
+        ext_seek_type = type;
+        ++ext_serial;
+        ext_cond.wakeAll();
     }
 
     AVThread *watch_thread = 0;
@@ -325,6 +461,7 @@ void AVDemuxThread::seekInternal(qint64 pos, SeekType type, qint64 external_pos)
             watch_thread = t;
         }
     }
+    locker.unlock();
     if (watch_thread) {
         pauseInternal(false);
         Q_EMIT requestClockPause(false); // need direct connection
@@ -417,6 +554,9 @@ void AVDemuxThread::updateBufferState()
 //No more data to put. So stop blocking the queue to take the reset elements
 void AVDemuxThread::stop()
 {
+    // demux thread may be blocked in MediaIO read. reset when the next media is loaded
+    if (demuxer && demuxer->mediaIO())
+        demuxer->mediaIO()->abort();
     //this will not affect the pause state if we pause the output
     //TODO: why remove blockFull(false) can not play another file?
     AVThread* av[] = { audio_thread, video_thread};
@@ -434,6 +574,7 @@ void AVDemuxThread::stop()
     }
     pause(false);
     cond.wakeAll();
+    ext_cond.wakeAll();
     qDebug("all avthread finished. try to exit demux thread<<<<<<");
     end = true;
 }
@@ -444,9 +585,10 @@ void AVDemuxThread::pause(bool p, bool wait)
     if (paused == p)
         return;
     paused = p;
-    if (!paused)
+    if (!paused) {
         cond.wakeAll();
-    else {
+        ext_cond.wakeAll();
+    } else {
         if (wait) {
             // block until current loop finished
             buffer_mutex.lock();
@@ -600,10 +742,14 @@ void AVDemuxThread::run()
 {
     m_buffering = false;
     end = false;
-    if (audio_thread && !audio_thread->isRunning())
-        audio_thread->start(QThread::HighPriority);
-    if (video_thread && !video_thread->isRunning())
-        video_thread->start();
+    // standby: avthreads start when activated
+    bool standby = m_standby;
+    if (!standby) {
+        if (audio_thread && !audio_thread->isRunning())
+            audio_thread->start(QThread::HighPriority);
+        if (video_thread && !video_thread->isRunning())
+            video_thread->start();
+    }
 
     int stream = 0;
     Packet pkt;
@@ -615,19 +761,40 @@ void AVDemuxThread::run()
     AVThread* thread = !video_thread || (audio_thread && demuxer->hasAttacedPicture()) ? audio_thread : video_thread;
     m_buffer = thread->packetQueue();
     const qint64 buf2 = aqueue ? aqueue->bufferValue() : 1; // TODO: may be changed by user. Deal with audio track change
+    if (m_adaptive) {
+        m_buffer_ctrl.reset(m_buffer->bufferValue());
+        if (m_statistics) {
+            m_statistics->buffering = Statistics::Buffering();
+            m_statistics->buffering.value = m_buffer_ctrl.value();
+        }
+    }
     if (aqueue) {
         aqueue->clear();
         aqueue->setBlocking(true);
+        aqueue->setKeepFromKeyFrame(false); // audio packets are all key frames
+        aqueue->setKeepFromPts(-1);
     }
     if (vqueue) {
         vqueue->clear();
         vqueue->setBlocking(true);
+        vqueue->setKeepFromKeyFrame(standby);
     }
+    qreal standby_pts = -1; // pts of the cached key frame
+    qreal standby_pts0 = -1;
+    QElapsedTimer standby_timer; // pace reading to real time in standby mode
     connect(thread, SIGNAL(seekFinished(qint64)), this, SIGNAL(seekFinished(qint64)), Qt::DirectConnection);
     seek_tasks.clear();
     int was_end = 0;
-    if (ademuxer) {
-        ademuxer->seek(0LL);
+    ExternalAudioReader areader(this);
+    {
+        QMutexLocker locker(&ext_mutex);
+        Q_UNUSED(locker);
+        if (ademuxer) {
+            ext_seek = true;
+            ext_seek_pos = 0;
+            ext_seek_type = demuxer->seekType();
+            ++ext_serial;
+        }
     }
     qreal last_apts = 0;
     qreal last_vpts = 0;
@@ -635,6 +802,22 @@ void AVDemuxThread::run()
     AutoSem as(&sem);
     Q_UNUSED(as);
     while (!end) {
+        if (standby && !m_standby) {
+            standby = false;
+            qDebug("activated from standby. cached key frame pts: %f", standby_pts);
+            if (aqueue)
+                aqueue->setKeepFromPts(-1);
+            if (vqueue)
+                vqueue->setKeepFromKeyFrame(false);
+            if (standby_pts >= 0) {
+                thread->clock()->updateValue(standby_pts);
+                thread->clock()->updateExternalClock(qint64((standby_pts - thread->clock()->initialValue())*1000.0));
+            }
+            if (audio_thread && !audio_thread->isRunning())
+                audio_thread->start(QThread::HighPriority);
+            if (video_thread && !video_thread->isRunning())
+                video_thread->start();
+        }
         processNextSeekTask();
         //vthread maybe changed by AVPlayer.setPriority() from no dec case
         vqueue = video_thread ? video_thread->packetQueue() : 0;
@@ -693,33 +876,50 @@ void AVDemuxThread::run()
             continue; //the queue is empty and will block
         }
         updateBufferState();
+        if (m_adaptive && !standby) {
+            const BufferController::Decision decision = m_buffer_ctrl.update(m_buffer);
+            if (m_statistics) {
+                m_statistics->buffering.input_rate = m_buffer_ctrl.inputRate();
+                m_statistics->buffering.value = m_buffer_ctrl.value();
+                if (decision == BufferController::Grow)
+                    m_statistics->buffering.grows++;
+                else if (decision == BufferController::Shrink)
+                    m_statistics->buffering.shrinks++;
+            }
+        }
         if (!demuxer->readFrame()) {
             continue;
         }
         stream = demuxer->stream();
         pkt = demuxer->packet();
+        if (standby && pkt.pts >= 0) {
+            if (standby_pts0 < 0) {
+                standby_pts0 = pkt.pts;
+                standby_timer.start();
+            }
+            // a live source is never ahead of real time. for others, do not read faster than real time
+            qint64 ahead = qint64((pkt.pts - standby_pts0)*1000.0) - standby_timer.elapsed() - kStandbyLead;
+            while (ahead > 0 && m_standby && !end) {
+                msleep(qMin<qint64>(ahead, 20));
+                ahead = qint64((pkt.pts - standby_pts0)*1000.0) - standby_timer.elapsed() - kStandbyLead;
+            }
+        }
         Packet apkt;
         bool audio_has_pic = demuxer->hasAttacedPicture();
-        int a_ext = 0;
-        if (ademuxer) {
-            QMutexLocker locker(&buffer_mutex);
+        // external audio packets are read and put by areader. internal audio packets are dropped
+        bool a_ext = false;
+        {
+            // ademuxer can be replaced in another thread
+            QMutexLocker locker(&ext_mutex);
             Q_UNUSED(locker);
-            if (ademuxer) {
-                a_ext = -1;
+            a_ext = !!ademuxer;
+            if (a_ext)
                 audio_has_pic = ademuxer->hasAttacedPicture();
-                // FIXME: buffer full but buffering!!!
-                // avoid read external track everytime. aqueue may not block full
-                // vqueue will not block if aqueue is not enough
-                if (!aqueue->isFull() || aqueue->isBuffering()) {
-                    if (ademuxer->readFrame()) {
-                        if (ademuxer->stream() == ademuxer->audioStream()) {
-                            a_ext = 1;
-                            apkt = ademuxer->packet();
-                        }
-                    }
-                    // no continue otherwise. ademuxer finished earlier than demuxer
-                }
-            }
+        }
+        if (a_ext) {
+            if (!areader.isRunning())
+                areader.start();
+            last_apts = areader.lastPts();
         }
         //qDebug("vqueue: %d, aqueue: %d/isbuffering %d isfull: %d, buffer: %d/%d", vqueue->size(), aqueue->size(), aqueue->isBuffering(), aqueue->isFull(), aqueue->buffered(), aqueue->bufferValue());
 
@@ -738,39 +938,55 @@ void AVDemuxThread::run()
          */
         //TODO: use cache queue, take from cache queue if not empty?
         const bool a_internal = stream == demuxer->audioStream();
-        if (a_internal || a_ext > 0) {//apkt.isValid()) {
-            if (a_internal && !a_ext) // internal is always read even if external audio used
+        if (a_internal || a_ext) {
+            if (a_internal && !a_ext) { // internal is always read even if external audio used
                 apkt = demuxer->packet();
-            last_apts = apkt.pts;
+                last_apts = apkt.pts;
+            }
             /* if vqueue if not blocked and full, and aqueue is empty, then put to
              * vqueue will block demuex thread
              */
             if (aqueue) {
-                if (!audio_thread || !audio_thread->isRunning()) {
+                if (!standby && (!audio_thread || !audio_thread->isRunning())) {
                     aqueue->clear();
-                    continue;
+                    if (!a_ext)
+                        continue;
                 }
                 // must ensure bufferValue set correctly before continue
                 if (m_buffer != aqueue)
                     aqueue->setBufferValue(m_buffer->isBuffering() ? std::numeric_limits<qint64>::max() : buf2);
                 // always block full if no vqueue because empty callback may set false
                 // attached picture is cover for song, 1 frame
-                aqueue->blockFull(!video_thread || !video_thread->isRunning() || !vqueue || audio_has_pic);
-                // external audio: a_ext < 0, stream = audio_idx=>put invalid packet
-                if (a_ext >= 0)
+                aqueue->blockFull(!standby && (!video_thread || !video_thread->isRunning() || !vqueue || audio_has_pic));
+                if (!a_ext) {
+                    if (standby && !vqueue) { // audio only: keep the last second
+                        standby_pts = qMax<qreal>(0, apkt.pts - 1.0);
+                        aqueue->setKeepFromPts(standby_pts);
+                    }
                     aqueue->put(apkt); //affect video_thread
+                    if (m_adaptive && aqueue == m_buffer)
+                        m_buffer_ctrl.received(apkt);
+                }
             }
         }
         // always check video stream if use external audio
         if (stream == demuxer->videoStream()) {
             if (vqueue) {
-                if (!video_thread || !video_thread->isRunning()) {
+                if (!standby && (!video_thread || !video_thread->isRunning())) {
                     vqueue->clear();
                     continue;
                 }
-                vqueue->blockFull(!audio_thread || !audio_thread->isRunning() || !aqueue || aqueue->isEnough());
+                // aqueue is filled by areader independently if external audio is used
+                vqueue->blockFull(!standby && (a_ext || !audio_thread || !audio_thread->isRunning() || !aqueue || aqueue->isEnough()));
+                if (standby && pkt.hasKeyFrame) { // queued packets before pkt are dropped
+                    standby_pts = pkt.pts;
+                    if (aqueue)
+                        aqueue->setKeepFromPts(pkt.pts);
+                }
                 vqueue->put(pkt); //affect audio_thread
                 last_vpts = pkt.pts;
+                if (m_adaptive && vqueue == m_buffer)
+                    m_buffer_ctrl.received(pkt);
             }
         } else if (demuxer->subtitleStreams().contains(stream)) { //subtitle
             Q_EMIT internalSubtitlePacketRead(demuxer->subtitleStreams().indexOf(stream), pkt);
@@ -780,6 +996,9 @@ void AVDemuxThread::run()
     }
     m_buffering = false;
     m_buffer = 0;
+    areader.stop();
+    ext_cond.wakeAll();
+    areader.wait();
     while (audio_thread && audio_thread->isRunning()) {
         qDebug("waiting audio thread.......");
         Packet quit_pkt(Packet::createEOF());
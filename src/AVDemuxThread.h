@@ -27,12 +27,14 @@
 #include <QtCore/QThread>
 #include <QtCore/QRunnable>
 #include "PacketBuffer.h"
+#include "BufferController.h"
 #include <QTimer>
 
 namespace QtAV {
 
 class AVDemuxer;
 class AVThread;
+class Statistics;
 class AVDemuxThread : public QThread
 {
     Q_OBJECT
@@ -62,6 +64,19 @@ public:
     bool waitForStarted(int msec = -1);
     qint64 lastSeekPos();
     bool hasSeekTasks();
+    /*!
+     * \brief setAdaptiveBuffer
+     * Adjust the primary buffer value by BufferController. Decisions are written to statistics. Set before start
+     */
+    void setAdaptiveBuffer(bool value, bool shrink, Statistics* statistics);
+    /*!
+     * \brief setStandby
+     * If true when started, audio/video threads are not started, packet queues are not blocked and only keep packets
+     * since the last video key frame, and reading is paced to real time. Set false to activate: avthreads start from the
+     * cached key frame.
+     */
+    void setStandby(bool value);
+    bool isStandby() const;
 Q_SIGNALS:
     void requestClockPause(bool value);
     void mediaEndActionPauseTriggered();
@@ -99,12 +114,25 @@ private:
     MediaEndAction end_action;
     bool m_buffering;
     PacketBuffer *m_buffer;
+    bool m_adaptive;
+    BufferController m_buffer_ctrl;
+    Statistics *m_statistics;
+    volatile bool m_standby;
     AVDemuxer *demuxer;
     AVDemuxer *ademuxer;
+    // guarded by ext_mutex
+    int ext_serial; // changed if ademuxer is changed or seeked
+    bool ext_seek; // ademuxer seek requested. it's done in external audio reader
+    bool ext_reading; // external audio reader is using ademuxer without ext_mutex
+    qint64 ext_seek_pos;
+    SeekType ext_seek_type;
     AVThread *audio_thread, *video_thread;
     int audio_stream, video_stream;
     QMutex buffer_mutex;
     QWaitCondition cond;
+    // external audio reader. never held by the reader when reading
+    QMutex ext_mutex;
+    QWaitCondition ext_cond;
     BlockingQueue<QRunnable*> seek_tasks;
     qint64 last_seek_pos;
     QRunnable *current_seek_task;
@@ -116,6 +144,7 @@ private:
     int clock_type; // change happens in different threads(direct connection)
     friend class SeekTask;
     friend class stepBackwardTask;
+    friend class ExternalAudioReader;
 };
 
 } //namespace QtAV
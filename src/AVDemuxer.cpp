@@ -596,6 +596,9 @@ bool AVDemuxer::seek(qint64 pos)
         }
     }
     d->eof = false;
+    // MediaIO read may be aborted by a seek request
+    if (d->input && getInterruptStatus() >= 0)
+        d->input->abort(false);
     // no lock required because in AVDemuxThread read and seek are in the same thread
 #if 0
     //t: unit is s
@@ -819,6 +822,9 @@ bool AVDemuxer::load()
         qDebug() << "force format: " << d->format_forced;
     }
     int ret = 0;
+    // reset abort() by the last stop or seek
+    if (d->input && getInterruptStatus() >= 0)
+        d->input->abort(false);
     // used dict entries will be removed in avformat_open_input
     d->interrupt_hanlder->begin(InterruptHandler::Open);
     if (d->input) {
@@ -1203,6 +1209,9 @@ int AVDemuxer::getInterruptStatus() const
 void AVDemuxer::setInterruptStatus(int interrupt)
 {
     d->interrupt_hanlder->setStatus(interrupt);
+    // ffmpeg interrupt callback can not abort a blocking read of MediaIO
+    if (d->input)
+        d->input->abort(interrupt < 0);
 }
 
 void AVDemuxer::setOptions(const QVariantHash &dict)
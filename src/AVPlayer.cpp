@@ -27,6 +27,7 @@
 #include <QtCore/QEvent>
 #include <QtCore/QDir>
 #include <QtCore/QIODevice>
+#include <QtCore/QSemaphore>
 #include <QtCore/QThreadPool>
 #include <QtCore/QTimer>
 #include "QtAV/AVDemuxer.h"
@@ -35,6 +36,7 @@
 #include "QtAV/MediaIO.h"
 #include "QtAV/VideoRenderer.h"
 #include "QtAV/AVClock.h"
+#include "QtAV/BatchVideoFilter.h"
 #include "QtAV/VideoCapture.h"
 #include "QtAV/VideoCapture.h"
 #include "filter/FilterManager.h"
@@ -62,6 +64,35 @@ static const qint64 kSeekMS = 10000;
 
 Q_GLOBAL_STATIC(QThreadPool, loaderThreadPool)
 
+namespace {
+// a part of load()/play() running in parallel with the caller. runs in the caller thread if no pool thread is available
+class LoadPartTask : public QRunnable {
+public:
+    LoadPartTask() : ok(false), started(false) { setAutoDelete(false);}
+    void start() {
+        started = true;
+        if (!loaderThreadPool()->tryStart(this))
+            run();
+    }
+    bool waitForFinished() {
+        if (started)
+            done.acquire();
+        started = false;
+        return ok;
+    }
+    void run() Q_DECL_OVERRIDE {
+        ok = exec();
+        done.release();
+    }
+protected:
+    virtual bool exec() = 0;
+private:
+    bool ok;
+    bool started;
+    QSemaphore done;
+};
+} //namespace
+
 /// Supported input protocols. A static string list
 const QStringList& AVPlayer::supportedProtocols()
 {
@@ -109,6 +140,9 @@ AVPlayer::~AVPlayer()
     QList<Filter*> filters(FilterManager::instance().videoFilters(this));
     foreach (Filter* f, filters) {
         uninstallFilter(reinterpret_cast<VideoFilter*>(f));
+        // children filters are deleted later in ~QObject. the worker must not run while the subclass is destroyed
+        if (BatchVideoFilter *bf = qobject_cast<BatchVideoFilter*>(f))
+            bf->stop();
     }
     filters = FilterManager::instance().audioFilters(this);
     foreach (Filter* f, filters) {
@@ -647,6 +681,16 @@ bool AVPlayer::isAsyncLoad() const
     return d->async_load;
 }
 
+void AVPlayer::setAsyncVideoFilter(bool value)
+{
+    d->async_vfilter = value;
+}
+
+bool AVPlayer::isAsyncVideoFilter() const
+{
+    return d->async_vfilter;
+}
+
 bool AVPlayer::isLoaded() const
 {
     return d->loaded;
@@ -656,14 +700,9 @@ void AVPlayer::loadInternal()
 {
     QMutexLocker lock(&d->load_mutex);
     Q_UNUSED(lock);
-    // release codec ctx
-    //close decoders here to make sure open and close in the same thread if not async load
-    if (isLoaded()) {
-        if (d->adec)
-            d->adec->setCodecContext(0);
-        if (d->vdec)
-            d->vdec->setCodecContext(0);
-    }
+    // keep decoders in DecoderPool. they are reused if the new media has the same codec parameters
+    if (isLoaded())
+        d->recycleDecoders();
     qDebug() << "Loading " << d->current_source << " ...";
     if (d->current_source.type() == QVariant::String) {
         d->demuxer.setMedia(d->current_source.toString());
@@ -674,8 +713,56 @@ void AVPlayer::loadInternal()
             d->demuxer.setMedia(d->current_source.value<QtAV::MediaIO*>());
         }
     }
+    class ExternalAudioTask : public LoadPartTask {
+    public:
+        ExternalAudioTask(AVDemuxer *demuxer) : m_demuxer(demuxer) {}
+    protected:
+        bool exec() Q_DECL_OVERRIDE { return m_demuxer->load();}
+    private:
+        AVDemuxer *m_demuxer;
+    };
+    // external audio set before loading is opened in parallel with the main media
+    ExternalAudioTask atask(&d->audio_demuxer);
+    QString audio_file;
+    bool load_audio = false;
+    {
+        QMutexLocker lock(&d->external_audio_mutex);
+        Q_UNUSED(lock);
+        audio_file = d->external_audio;
+        load_audio = !audio_file.isEmpty() && (d->external_audio_pending || !d->audio_demuxer.isLoaded());
+        d->external_audio_pending = false;
+        d->external_audio_loading = load_audio;
+    }
+    if (load_audio) {
+        d->audio_demuxer.setMedia(audio_file);
+        atask.start();
+    }
     d->loaded = d->demuxer.load();
     d->status = d->demuxer.mediaStatus();
+    Q_EMIT partLoaded(MediaPart, d->loaded);
+    while (load_audio) {
+        const bool ok = !audio_file.isEmpty() && atask.waitForFinished();
+        if (!ok && !audio_file.isEmpty())
+            qWarning("Failed to load external audio %s", audio_file.toUtf8().constData());
+        if (audio_file.isEmpty())
+            d->audio_demuxer.unload();
+        d->external_audio_tracks = ok ? d->getTracksInfo(&d->audio_demuxer, AVDemuxer::AudioStream) : QVariantList();
+        Q_EMIT externalAudioTracksChanged(d->external_audio_tracks);
+        d->read_thread->setAudioDemuxer(ok ? &d->audio_demuxer : 0);
+        if (!audio_file.isEmpty())
+            Q_EMIT partLoaded(ExternalAudioPart, ok);
+        // setAudioStream(file) was called while loading
+        QMutexLocker lock(&d->external_audio_mutex);
+        Q_UNUSED(lock);
+        load_audio = d->external_audio_pending;
+        audio_file = d->external_audio;
+        d->external_audio_pending = false;
+        d->external_audio_loading = load_audio;
+        if (load_audio && !audio_file.isEmpty()) {
+            d->audio_demuxer.setMedia(audio_file);
+            atask.start();
+        }
+    }
     if (!d->loaded) {
         d->statistics.reset();
         qWarning("Load failed!");
@@ -720,16 +807,8 @@ void AVPlayer::unload()
     d->loaded = false;
     d->demuxer.setInterruptStatus(-1);
 
-    if (d->adec) { // FIXME: crash if audio external=>internal then replay
-        d->adec->setCodecContext(0);
-        delete d->adec;
-        d->adec = 0;
-    }
-    if (d->vdec) {
-        d->vdec->setCodecContext(0);
-        delete d->vdec;
-        d->vdec = 0;
-    }
+    // FIXME: crash if audio external=>internal then replay
+    d->recycleDecoders(); // decoders own the codec contexts, so they are valid after demuxer unload
     d->demuxer.unload();
     Q_EMIT chaptersChanged(0);
     Q_EMIT durationChanged(0LL); // for ui, slider is invalid. use stopped instead, and remove this signal here?
@@ -979,7 +1058,16 @@ bool AVPlayer::setAudioStream(const QString &file, int n)
         }
     }
     d->audio_track = n;
-    d->external_audio = path;
+    {
+        QMutexLocker lock(&d->external_audio_mutex);
+        Q_UNUSED(lock);
+        d->external_audio = path;
+        // load in parallel with the main media, or after the file being loaded. see loadInternal()
+        if (d->external_audio_loading || (!path.isEmpty() && !isLoaded() && !isPlaying())) {
+            d->external_audio_pending = true;
+            return true;
+        }
+    }
     d->audio_demuxer.setMedia(d->external_audio);
     struct scoped_pause {
         scoped_pause() : was_paused(false), player(0) {}
@@ -1163,13 +1251,8 @@ bool AVPlayer::load()
     }
     if (!d->checkSourceChange() && (mediaStatus() == QtAV::LoadingMedia || mediaStatus() == LoadedMedia))
         return true;
-    if (isLoaded()) {
-        // release codec ctx. if not loaded, they are released by avformat. TODO: always let avformat release them?
-        if (d->adec)
-            d->adec->setCodecContext(0);
-        if (d->vdec)
-            d->vdec->setCodecContext(0);
-    }
+    if (isLoaded()) // decoders are reused by the new media if possible
+        d->recycleDecoders();
     d->loaded = false;
     d->status = LoadingMedia;
     if (!isAsyncLoad()) {
@@ -1224,7 +1307,34 @@ void AVPlayer::playInternal()
     d->stop_position_norm = normalizedPosition(d->stop_position);
     // FIXME: if call play() frequently playInternal may not be called if disconnect here
     disconnect(this, SIGNAL(loaded()), this, SLOT(playInternal()));
-    if (!d->setupAudioThread(this)) {
+    class VideoDecoderTask : public LoadPartTask {
+    public:
+        VideoDecoderTask(AVPlayer::Private *d, QThread *thread, AVCodecContext *avctx) : m_d(d), m_thread(thread), m_avctx(avctx), m_dec(0) {}
+        VideoDecoder* decoder() const { return m_dec;}
+        QByteArray key() const { return m_key;}
+    protected:
+        bool exec() Q_DECL_OVERRIDE {
+            m_dec = m_d->openVideoDecoder(m_avctx, &m_key);
+            // created (or taken from DecoderPool) in a pool thread. it's used and deleted in player thread
+            if (m_dec && m_dec->thread() != m_thread)
+                m_dec->moveToThread(m_thread);
+            return !!m_dec;
+        }
+    private:
+        AVPlayer::Private *m_d;
+        QThread *m_thread;
+        AVCodecContext *m_avctx;
+        VideoDecoder *m_dec;
+        QByteArray m_key;
+    };
+    // open video decoder in parallel with audio decoder and audio output
+    AVCodecContext *vctx = d->resetVideoDecoder();
+    VideoDecoderTask vtask(d, thread(), vctx);
+    if (vctx)
+        vtask.start();
+    const bool has_audio = d->setupAudioThread(this);
+    Q_EMIT partLoaded(AudioDecoderPart, has_audio);
+    if (!has_audio) {
         d->read_thread->setAudioThread(0); //set 0 before delete. ptr is used in demux thread when set 0
         if (d->athread) {
             qDebug("release audio thread.");
@@ -1232,7 +1342,13 @@ void AVPlayer::playInternal()
             d->athread = 0;//shared ptr?
         }
     }
-    if (!d->setupVideoThread(this)) {
+    bool has_video = false;
+    if (vctx) {
+        vtask.waitForFinished();
+        has_video = d->setupVideoThread(this, vtask.decoder(), vtask.key());
+        Q_EMIT partLoaded(VideoDecoderPart, has_video);
+    }
+    if (!has_video) {
         d->read_thread->setVideoThread(0); //set 0 before delete. ptr is used in demux thread when set 0
         if (d->vthread) {
             qDebug("release video thread.");
@@ -1248,7 +1364,8 @@ void AVPlayer::playInternal()
     // setup clock before avthread.start() becuase avthreads use clock. after avthreads setup because of ao check
     masterClock()->reset();
     // TODO: add isVideo() or hasVideo()?
-    if (masterClock()->isClockAuto()) {
+    // clock type of a ClockGroup member is set by the group
+    if (masterClock()->isClockAuto() && !masterClock()->group()) {
         qDebug("auto select clock: audio > external");
         if (!d->demuxer.audioCodecContext() || !d->ao || !d->ao->isOpen() || !d->athread) {
             masterClock()->setClockType(AVClock::ExternalClock);
@@ -1260,22 +1377,27 @@ void AVPlayer::playInternal()
     }
     masterClock()->setInitialValue((double)absoluteMediaStartPosition()/1000.0);
     // from previous play()
-    if (d->demuxer.audioCodecContext() && d->athread) {
-        qDebug("Starting audio thread...");
-        d->athread->start();
-    }
-    if (d->demuxer.videoCodecContext() && d->vthread) {
-        qDebug("Starting video thread...");
-        d->vthread->start();
-    }
+    // standby: avthreads are started by demux thread when activated
+    if (!d->standby) {
+        if (d->demuxer.audioCodecContext() && d->athread) {
+            qDebug("Starting audio thread...");
+            d->athread->start();
+        }
+        if (d->demuxer.videoCodecContext() && d->vthread) {
+            qDebug("Starting video thread...");
+            d->vthread->start();
+        }
 
-    if (d->demuxer.audioCodecContext() && d->athread)
-        d->athread->waitForStarted();
-    if (d->demuxer.videoCodecContext() && d->vthread)
-        d->vthread->waitForStarted();
+        if (d->demuxer.audioCodecContext() && d->athread)
+            d->athread->waitForStarted();
+        if (d->demuxer.videoCodecContext() && d->vthread)
+            d->vthread->waitForStarted();
+    }
 
     d->read_thread->setMediaEndAction(mediaEndAction());
-    d->read_thread->start();
+    d->read_thread->setAdaptiveBuffer(d->adaptive_buffer, d->adaptive_buffer_shrink, &d->statistics);
+    d->read_thread->setStandby(d->standby);
+    d->read_thread->start(d->standby ? QThread::LowPriority : QThread::InheritPriority);
 
     /// demux thread not started, seek tasks will be cleared
     d->read_thread->waitForStarted();
@@ -1534,6 +1656,7 @@ void AVPlayer::timerEvent(QTimerEvent *te)
             d->clock->pause(true);
             //return; //ensure positionChanged emitted for stepForward()
         }
+        d->catchUpLatency();
         // active only when playing
         const qint64 t = position();
         if (d->stop_position_norm == kInvalidPosition) { // or check d->stop_position_norm < 0
@@ -1690,6 +1813,128 @@ int AVPlayer::bufferValue() const
     return d->buffer_value;
 }
 
+void AVPlayer::setAdaptiveBuffer(bool value, bool shrink)
+{
+    d->adaptive_buffer = value;
+    d->adaptive_buffer_shrink = shrink;
+}
+
+bool AVPlayer::isAdaptiveBuffer() const
+{
+    return d->adaptive_buffer;
+}
+
+// add a flag like "+nobuffer" to ffmpeg flags option value
+static QVariant mergeFlag(const QVariant& flags, const QString& flag)
+{
+    const QString s(flags.toString());
+    if (s.isEmpty())
+        return flag;
+    if (s.contains(flag.mid(1)))
+        return flags;
+    return QVariant(s + flag);
+}
+
+// set opt[key] = value, and save the old value the 1st time. keys not in opt are not saved
+static void replaceOption(QVariantHash *opt, QVariantHash *saved, bool save, const QString& key, const QVariant& value)
+{
+    if (save && opt->contains(key))
+        (*saved)[key] = opt->value(key);
+    (*opt)[key] = value;
+}
+
+// restore the values saved by replaceOption()
+static void restoreOptions(QVariantHash *opt, const QVariantHash& saved, const QStringList& keys)
+{
+    foreach (const QString& key, keys) {
+        if (saved.contains(key))
+            (*opt)[key] = saved.value(key);
+        else
+            opt->remove(key);
+    }
+}
+
+void AVPlayer::setLowLatency(bool value, int targetMs)
+{
+    const bool save = value && !d->low_latency; // do not save the values set by low latency mode
+    const bool restore = !value && d->low_latency;
+    d->low_latency = value;
+    d->target_latency = qMax(1, targetMs);
+    QVariantHash fmt_opt(d->demuxer.options());
+    QVariantHash vc_avcodec(d->vc_opt.value(QStringLiteral("avcodec")).toHash());
+    QVariantHash ac_avcodec(d->ac_opt.value(QStringLiteral("avcodec")).toHash());
+    const QStringList fmt_keys = QStringList() << QStringLiteral("fflags") << QStringLiteral("probesize") << QStringLiteral("analyzeduration") << QStringLiteral("max_delay");
+    const QStringList vc_keys = QStringList() << QStringLiteral("flags") << QStringLiteral("thread_type");
+    const QStringList ac_keys = QStringList() << QStringLiteral("flags");
+    if (value) {
+        if (save) {
+            d->ll_saved_fmt.clear();
+            d->ll_saved_vc.clear();
+            d->ll_saved_ac.clear();
+            d->ll_saved_buffer_mode = d->buffer_mode;
+            d->ll_saved_buffer_value = d->buffer_value;
+            d->ll_saved_ao_latency = d->ao ? d->ao->targetLatency() : 0;
+        }
+        const QVariant fflags(save ? fmt_opt.value(QStringLiteral("fflags")) : d->ll_saved_fmt.value(QStringLiteral("fflags")));
+        replaceOption(&fmt_opt, &d->ll_saved_fmt, save, QStringLiteral("fflags"), mergeFlag(fflags, QStringLiteral("+nobuffer")));
+        replaceOption(&fmt_opt, &d->ll_saved_fmt, save, QStringLiteral("probesize"), 32768);
+        replaceOption(&fmt_opt, &d->ll_saved_fmt, save, QStringLiteral("analyzeduration"), 100000); // us
+        replaceOption(&fmt_opt, &d->ll_saved_fmt, save, QStringLiteral("max_delay"), 0);
+        const QVariant vflags(save ? vc_avcodec.value(QStringLiteral("flags")) : d->ll_saved_vc.value(QStringLiteral("flags")));
+        replaceOption(&vc_avcodec, &d->ll_saved_vc, save, QStringLiteral("flags"), mergeFlag(vflags, QStringLiteral("+low_delay")));
+        replaceOption(&vc_avcodec, &d->ll_saved_vc, save, QStringLiteral("thread_type"), QStringLiteral("slice")); // frame threading adds 1 frame delay per thread
+        const QVariant aflags(save ? ac_avcodec.value(QStringLiteral("flags")) : d->ll_saved_ac.value(QStringLiteral("flags")));
+        replaceOption(&ac_avcodec, &d->ll_saved_ac, save, QStringLiteral("flags"), mergeFlag(aflags, QStringLiteral("+low_delay")));
+        d->buffer_mode = BufferTime;
+        d->buffer_value = qMax(40, d->target_latency/4);
+        // audio device buffering is a part of the end-to-end latency. applied when audio output is opened
+        if (d->ao)
+            d->ao->setTargetLatency(qMax(20, d->target_latency/3));
+    } else if (restore) {
+        restoreOptions(&fmt_opt, d->ll_saved_fmt, fmt_keys);
+        restoreOptions(&vc_avcodec, d->ll_saved_vc, vc_keys);
+        restoreOptions(&ac_avcodec, d->ll_saved_ac, ac_keys);
+        d->buffer_mode = d->ll_saved_buffer_mode;
+        d->buffer_value = d->ll_saved_buffer_value;
+        if (d->ao)
+            d->ao->setTargetLatency(d->ll_saved_ao_latency);
+    } else {
+        return;
+    }
+    d->demuxer.setOptions(fmt_opt);
+    if (vc_avcodec.isEmpty())
+        d->vc_opt.remove(QStringLiteral("avcodec"));
+    else
+        d->vc_opt[QStringLiteral("avcodec")] = vc_avcodec;
+    if (ac_avcodec.isEmpty())
+        d->ac_opt.remove(QStringLiteral("avcodec"));
+    else
+        d->ac_opt[QStringLiteral("avcodec")] = ac_avcodec;
+    d->updateBufferValue();
+}
+
+bool AVPlayer::isLowLatency() const
+{
+    return d->low_latency;
+}
+
+void AVPlayer::setStandby(bool value)
+{
+    if (d->standby == value)
+        return;
+    d->standby = value;
+    if (value || !isPlaying())
+        return;
+    qDebug("activate standby player");
+    d->read_thread->setPriority(QThread::NormalPriority);
+    d->read_thread->setStandby(false); // avthreads are started in demux thread
+}
+
+bool AVPlayer::isStandby() const
+{
+    return d->standby;
+}
+
 void AVPlayer::updateClock(qint64 msecs)
 {
     d->clock->updateExternalClock(msecs);
@@ -1729,12 +1974,18 @@ void AVPlayer::setContrast(int val)
 
 int AVPlayer::hue() const
 {
-    return 0;
+    return d->hue;
 }
 
 void AVPlayer::setHue(int val)
 {
-    Q_UNUSED(val);
+    if (d->hue == val)
+        return;
+    d->hue = val;
+    Q_EMIT hueChanged(d->hue);
+    if (d->vthread) {
+        d->vthread->setHue(val);
+    }
 }
 
 int AVPlayer::saturation() const
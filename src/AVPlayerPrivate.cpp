@@ -25,6 +25,7 @@
 #include "QtAV/AudioDecoder.h"
 #include "QtAV/AudioFormat.h"
 #include "QtAV/AudioResampler.h"
+#include "QtAV/DecoderPool.h"
 #include "QtAV/MediaIO.h"
 #include "QtAV/VideoCapture.h"
 #include "QtAV/private/AVCompat.h"
@@ -72,6 +73,7 @@ static bool correct_audio_channels(AVCodecContext *ctx) {
 AVPlayer::Private::Private()
     : auto_load(false)
     , async_load(true)
+    , async_vfilter(false)
     , loaded(false)
     , relative_time_mode(true)
     , media_start_pts(0)
@@ -87,8 +89,18 @@ AVPlayer::Private::Private()
     , audio_track(0)
     , video_track(0)
     , subtitle_track(0)
+    , external_audio_pending(false)
+    , external_audio_loading(false)
     , buffer_mode(BufferPackets)
     , buffer_value(-1)
+    , adaptive_buffer(false)
+    , adaptive_buffer_shrink(false)
+    , low_latency(false)
+    , target_latency(150)
+    , ll_saved_buffer_mode(BufferPackets)
+    , ll_saved_buffer_value(-1)
+    , ll_saved_ao_latency(0)
+    , standby(false)
     , read_thread(0)
     , clock(new AVClock(AVClock::AudioClock))
     , vo(0)
@@ -104,6 +116,7 @@ AVPlayer::Private::Private()
     , brightness(0)
     , contrast(0)
     , saturation(0)
+    , hue(0)
     , seeking(false)
     , seek_type(AccurateSeek)
     , interrupt_timeout(30000)
@@ -191,6 +204,14 @@ void AVPlayer::Private::updateNotifyInterval()
 
 void AVPlayer::Private::applyFrameRate()
 {
+    // ClockGroup sets the clock type and drives the clock. frames are presented on the group ticks
+    if (clock->group()) {
+        if (vthread)
+            vthread->setFrameRate(0.0);
+        ao->setSpeed(speed);
+        clock->setSpeed(speed);
+        return;
+    }
     qreal vfps = force_fps;
     bool force = vfps > 0;
     const bool ao_null = ao && ao->backend().toLower() == QLatin1String("null");
@@ -365,26 +386,31 @@ bool AVPlayer::Private::setupAudioThread(AVPlayer *player)
         return false;
     }
     qDebug("has audio");
-    // TODO: no delete, just reset avctx and reopen
     if (adec) {
-        adec->disconnect();
-        delete adec;
+        DecoderPool::instance().put(adec, adec_key);
         adec = 0;
     }
-    adec = AudioDecoder::create();
-    if (!adec)
-    {
-        qWarning("failed to create audio decoder");
-        return false;
-    }
-    QObject::connect(adec, SIGNAL(error(QtAV::AVError)), player, SIGNAL(error(QtAV::AVError)));
-    adec->setCodecContext(avctx);
-    adec->setOptions(ac_opt);
-    if (!adec->open()) {
-        AVError e(AVError::AudioCodecNotFound);
-        qWarning() << e.string();
-        emit player->error(e);
-        return false;
+    // reuse an open decoder of the previous source if codec parameters are not changed
+    adec_key = DecoderPool::key(QString::fromLatin1(AudioDecoder::name(AudioDecoderId_FFmpeg)), avctx, ac_opt);
+    adec = DecoderPool::instance().take<AudioDecoder>(adec_key);
+    if (adec) {
+        QObject::connect(adec, SIGNAL(error(QtAV::AVError)), player, SIGNAL(error(QtAV::AVError)));
+    } else {
+        adec = AudioDecoder::create();
+        if (!adec)
+        {
+            qWarning("failed to create audio decoder");
+            return false;
+        }
+        QObject::connect(adec, SIGNAL(error(QtAV::AVError)), player, SIGNAL(error(QtAV::AVError)));
+        adec->setCodecContext(avctx);
+        adec->setOptions(ac_opt);
+        if (!adec->open()) {
+            AVError e(AVError::AudioCodecNotFound);
+            qWarning() << e.string();
+            emit player->error(e);
+            return false;
+        }
     }
     correct_audio_channels(avctx);
     AudioFormat af;
@@ -531,22 +557,8 @@ bool AVPlayer::Private::tryApplyDecoderPriority(AVPlayer *player)
 {
     // TODO: add an option to apply the new decoder even if not available
     qint64 pos = player->position();
-    VideoDecoder *vd = NULL;
-    AVCodecContext *avctx = demuxer.videoCodecContext();
-    foreach(VideoDecoderId vid, vc_ids) {
-        qDebug("**********trying video decoder: %s...", VideoDecoder::name(vid));
-        vd = VideoDecoder::create(vid);
-        if (!vd)
-            continue;
-        vd->setCodecContext(avctx); // It's fine because AVDecoder copy the avctx properties
-        vd->setOptions(vc_opt);
-        if (vd->open()) {
-            qDebug("**************Video decoder found:%p", vd);
-            break;
-        }
-        delete vd;
-        vd = 0;
-    }
+    QByteArray key;
+    VideoDecoder *vd = openVideoDecoder(demuxer.videoCodecContext(), &key);
     qDebug("**************set new decoder:%p -> %p", vdec, vd);
     if (!vd) {
         Q_EMIT player->error(AVError(AVError::VideoCodecNotFound));
@@ -555,15 +567,15 @@ bool AVPlayer::Private::tryApplyDecoderPriority(AVPlayer *player)
     if (vd->id() == vdec->id()
             && vd->options() == vdec->options()) {
         qDebug("Video decoder does not change");
-        delete vd;
+        DecoderPool::instance().put(vd, key);
         return true;
     }
     vthread->packetQueue()->clear();
     vthread->setDecoder(vd);
-    // MUST delete decoder after video thread set the decoder to ensure the deleted vdec will not be used in vthread!
-    if (vdec)
-        delete vdec;
+    // MUST recycle decoder after video thread set the decoder to ensure the old vdec will not be used in vthread!
+    DecoderPool::instance().put(vdec, vdec_key);
     vdec = vd;
+    vdec_key = key;
     QObject::connect(vdec, SIGNAL(error(QtAV::AVError)), player, SIGNAL(error(QtAV::AVError)));
     initVideoStatistics(demuxer.videoStream());
     // If no seek, drop packets until a key frame packet is found. But we may drop too many packets, and also a/v sync is a problem.
@@ -572,6 +584,16 @@ bool AVPlayer::Private::tryApplyDecoderPriority(AVPlayer *player)
 }
 
 bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
+{
+    AVCodecContext *avctx = resetVideoDecoder();
+    if (!avctx)
+        return false;
+    QByteArray key;
+    VideoDecoder *dec = openVideoDecoder(avctx, &key);
+    return setupVideoThread(player, dec, key);
+}
+
+AVCodecContext* AVPlayer::Private::resetVideoDecoder()
 {
     demuxer.setStreamIndex(AVDemuxer::VideoStream, video_track);
     // pause demuxer, clear queues, set demuxer stream, set decoder, set ao, resume
@@ -582,16 +604,27 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
     }
     AVCodecContext *avctx = demuxer.videoCodecContext();
     if (!avctx) {
-        return false;
+        return 0;
     }
     if (vdec) {
-        vdec->disconnect();
-        delete vdec;
+        DecoderPool::instance().put(vdec, vdec_key);
         vdec = 0;
+        vdec_key.clear();
     }
+    return avctx;
+}
+
+VideoDecoder* AVPlayer::Private::openVideoDecoder(AVCodecContext *avctx, QByteArray *key)
+{
     foreach(VideoDecoderId vid, vc_ids) {
         qDebug("**********trying video decoder: %s...", VideoDecoder::name(vid));
-        VideoDecoder *vd = VideoDecoder::create(vid);
+        *key = DecoderPool::key(QString::fromLatin1(VideoDecoder::name(vid)), avctx, vc_opt);
+        VideoDecoder *vd = DecoderPool::instance().take<VideoDecoder>(*key);
+        if (vd) {
+            qDebug("**************Video decoder reused:%p", vd);
+            return vd;
+        }
+        vd = VideoDecoder::create(vid);
         if (!vd) {
             continue;
         }
@@ -599,12 +632,19 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
         vd->setCodecContext(avctx);
         vd->setOptions(vc_opt);
         if (vd->open()) {
-            vdec = vd;
-            qDebug("**************Video decoder found:%p", vdec);
-            break;
+            qDebug("**************Video decoder found:%p", vd);
+            return vd;
         }
         delete vd;
     }
+    key->clear();
+    return 0;
+}
+
+bool AVPlayer::Private::setupVideoThread(AVPlayer *player, VideoDecoder *dec, const QByteArray &key)
+{
+    vdec = dec;
+    vdec_key = key;
     if (!vdec) {
         // DO NOT emit error signals in VideoDecoder::open(). 1 signal is enough
         AVError e(AVError::VideoCodecNotFound);
@@ -638,6 +678,14 @@ bool AVPlayer::Private::setupVideoThread(AVPlayer *player)
     vthread->setBrightness(brightness);
     vthread->setContrast(contrast);
     vthread->setSaturation(saturation);
+    vthread->setHue(hue);
+    vthread->setAsyncFilter(async_vfilter);
+    vthread->setLowLatency(low_latency, target_latency);
+    AVFormatContext *fmt_ctx = demuxer.formatContext();
+    if (low_latency && fmt_ctx && fmt_ctx->start_time_realtime > 0) // AV_NOPTS_VALUE if unknown
+        vthread->setRealTimeStart(fmt_ctx->start_time_realtime, fmt_ctx->start_time == (qint64)AV_NOPTS_VALUE ? 0 : qreal(fmt_ctx->start_time)/qreal(AV_TIME_BASE));
+    else
+        vthread->setRealTimeStart(0, 0);
     updateBufferValue(vthread->packetQueue());
     initVideoStatistics(demuxer.videoStream());
 
@@ -676,4 +724,47 @@ void AVPlayer::Private::updateBufferValue()
         updateBufferValue(vthread->packetQueue());
 }
 
+void AVPlayer::Private::recycleDecoders()
+{
+    // decoders MUST be unset in avthreads before recycling. load() can be called when playing, so avthreads may be still decoding
+    AVThread* av[] = { athread, vthread };
+    for (size_t i = 0; i < sizeof(av)/sizeof(av[0]); ++i) {
+        AVThread* t = av[i];
+        if (!t)
+            continue;
+        while (t->isRunning()) {
+            qDebug() << "stopping thread before recycling decoder " << t;
+            t->stop();
+            t->wait(500);
+        }
+        t->setDecoder(0);
+    }
+    DecoderPool::instance().put(adec, adec_key);
+    adec = 0;
+    adec_key.clear();
+    DecoderPool::instance().put(vdec, vdec_key);
+    vdec = 0;
+    vdec_key.clear();
+}
+
+void AVPlayer::Private::catchUpLatency()
+{
+    if (!low_latency || !athread || !ao || !ao->isAvailable())
+        return;
+    if (clock->clockType() != AVClock::AudioClock)
+        return;
+    const qreal added = statistics.latency.added;
+    qreal s = ao->speed();
+    if (added > 1.5*qreal(target_latency))
+        s = speed*1.05;
+    else if (added < qreal(target_latency))
+        s = speed;
+    if (qFuzzyCompare(s, ao->speed()))
+        return;
+    qDebug("latency %.1fms, catch up speed: %.2f", added, s);
+    // do not use AVPlayer::setSpeed(), user speed and frame rate are kept
+    ao->setSpeed(s);
+    clock->setSpeed(s);
+}
+
 } //namespace QtAV
@@ -52,10 +52,21 @@ public:
     bool applySubtitleStream(int n, AVPlayer *player);
     bool setupAudioThread(AVPlayer *player);
     bool setupVideoThread(AVPlayer *player);
+    // the following 3 functions are setupVideoThread(player) split for opening decoders in parallel
+    // select the video stream and release the old decoder. return the codec context to open
+    AVCodecContext* resetVideoDecoder();
+    // try decoders in vc_ids. thread safe if vc_ids and vc_opt are not changed
+    VideoDecoder* openVideoDecoder(AVCodecContext *avctx, QByteArray *key);
+    // dec and key are the result of openVideoDecoder()
+    bool setupVideoThread(AVPlayer *player, VideoDecoder *dec, const QByteArray& key);
+    // put decoders to DecoderPool for the next source
+    void recycleDecoders();
     bool tryApplyDecoderPriority(AVPlayer *player);
     // TODO: what if buffer mode changed during playback?
     void updateBufferValue(PacketBuffer *buf);
     void updateBufferValue();
+    // low latency mode: play a little faster if the estimated latency is too large and audio is the master clock
+    void catchUpLatency();
     //TODO: addAVOutput()
     template<class Out>
     void setAVOutput(Out *&pOut, Out *pNew, AVThread *thread) {
@@ -102,6 +113,7 @@ public:
 
     bool auto_load;
     bool async_load;
+    bool async_vfilter;
     // can be QString, QIODevice*
     QVariant current_source, pendding_source;
     bool loaded; // for current source
@@ -119,12 +131,25 @@ public:
     int audio_track, video_track, subtitle_track;
     QVariantList subtitle_tracks;
     QVariantList video_tracks;
+    // guards external_audio, external_audio_pending and external_audio_loading. setAudioStream() and async load() run in different threads
+    QMutex external_audio_mutex;
     QString external_audio;
+    bool external_audio_pending; // set before media is loaded or while loading. load with the media
+    bool external_audio_loading; // audio_demuxer is being loaded by loadInternal()
     AVDemuxer audio_demuxer;
     QVariantList external_audio_tracks;
     QVariantList audio_tracks;
     BufferMode buffer_mode;
     qint64 buffer_value;
+    bool adaptive_buffer, adaptive_buffer_shrink;
+    bool low_latency;
+    int target_latency;
+    // values replaced by low latency mode. restored when it's disabled. keys not set before are not in the hash
+    QVariantHash ll_saved_fmt, ll_saved_vc, ll_saved_ac;
+    BufferMode ll_saved_buffer_mode;
+    qint64 ll_saved_buffer_value;
+    int ll_saved_ao_latency;
+    bool standby;
     //the following things are required and must be set not null
     AVDemuxer demuxer;
     AVDemuxThread *read_thread;
@@ -133,6 +158,7 @@ public:
     AudioOutput *ao; // TODO: remove
     AudioDecoder *adec;
     VideoDecoder *vdec;
+    QByteArray adec_key, vdec_key; // DecoderPool keys
     AudioThread *athread;
     VideoThread *vthread;
 
@@ -141,7 +167,7 @@ public:
     qreal speed;
     OutputSet *vos, *aos;
     QVector<VideoDecoderId> vc_ids;
-    int brightness, contrast, saturation;
+    int brightness, contrast, saturation, hue;
 
     QVariantHash ac_opt, vc_opt;
 
@@ -24,16 +24,15 @@
 #include "AVThread_p.h"
 #include "QtAV/AVClock.h"
 #include "QtAV/AVDecoder.h"
+#include "QtAV/VideoDecoder.h"
 #include "QtAV/AVOutput.h"
+#include "QtAV/BatchVideoFilter.h"
 #include "QtAV/Filter.h"
 #include "output/OutputSet.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
 
-QVariantHash AVThreadPrivate::dec_opt_framedrop;
-QVariantHash AVThreadPrivate::dec_opt_normal;
-
 AVThreadPrivate::~AVThreadPrivate() {
     stop = true;
     if (!paused) {
@@ -46,8 +45,11 @@ AVThreadPrivate::~AVThreadPrivate() {
     packets.clear();
     QList<Filter*>::iterator it = filters.begin();
     while (it != filters.end()) {
-        if ((*it)->isOwnedByTarget() && !(*it)->parent())
+        if ((*it)->isOwnedByTarget() && !(*it)->parent()) {
+            if (BatchVideoFilter *bf = qobject_cast<BatchVideoFilter*>(*it))
+                bf->stop(); // before the subclass is destroyed
             delete *it;
+        }
         ++it;
     }
     filters.clear();
@@ -147,12 +149,13 @@ void AVThread::scheduleFrameDrop(bool value)
     public:
         FrameDropTask(AVDecoder *dec, bool value) : decoder(dec), drop(value) {}
         void run() Q_DECL_OVERRIDE {
-            if (!decoder)
+            VideoDecoder *vd = dynamic_cast<VideoDecoder*>(decoder);
+            if (!vd)
                 return;
             if (drop)
-                decoder->setOptions(AVThreadPrivate::dec_opt_framedrop);
+                vd->setDiscardLevel(VideoDecoder::DiscardNonRef);
             else
-                decoder->setOptions(AVThreadPrivate::dec_opt_normal);
+                vd->setDiscardLevel(VideoDecoder::DiscardDefault);
         }
     };
     scheduleTask(new FrameDropTask(decoder(), value));
@@ -68,12 +68,6 @@ public:
       , wait_err(0)
     {
         tasks.blockFull(false);
-
-        QVariantHash opt;
-        opt[QString::fromLatin1("skip_frame")] = 8; // 8 for "avcodec", "NoRef" for "FFmpeg". see AVDiscard
-        dec_opt_framedrop[QString::fromLatin1("avcodec")] = opt;
-        opt[QString::fromLatin1("skip_frame")] = 0; // 0 for "avcodec", "Default" for "FFmpeg". see AVDiscard
-        dec_opt_normal[QString::fromLatin1("avcodec")] = opt; // avcodec need correct string or value in libavcodec
     }
     virtual ~AVThreadPrivate();
 
@@ -94,7 +88,6 @@ public:
     //only decode video without display or skip decode audio until pts reaches
     qreal render_pts0;
 
-    static QVariantHash dec_opt_framedrop, dec_opt_normal;
     bool drop_frame_seek;
     ring<qreal> pts_history;
 
@@ -145,8 +145,23 @@ AudioFormat::SampleFormat AudioFormat::make(int bytesPerSample, bool isFloat, bo
     return SampleFormat(f);
 }
 
+// default constructed formats share one private and detach on the first change. never freed
+class AudioFormatDefault
+{
+public:
+    AudioFormatDefault() : p(new AudioFormatPrivate()) { p->ref.ref();}
+    AudioFormatPrivate *p;
+};
+Q_GLOBAL_STATIC(AudioFormatDefault, defaultAudioFormat)
+
+static AudioFormatPrivate* defaultPrivate()
+{
+    AudioFormatDefault *def = defaultAudioFormat(); // null after destruction
+    return def ? def->p : new AudioFormatPrivate();
+}
+
 AudioFormat::AudioFormat():
-    d(new AudioFormatPrivate())
+    d(defaultPrivate())
 {
 }
 
@@ -230,6 +245,8 @@ int AudioFormat::planeCount() const
 */
 void AudioFormat::setSampleRate(int sampleRate)
 {
+    if (d.constData()->sample_rate == sampleRate) // avoid detaching a shared format
+        return;
     d->sample_rate = sampleRate;
 }
 
@@ -247,6 +264,9 @@ int AudioFormat::sampleRate() const
 */
 void AudioFormat::setChannelLayoutFFmpeg(qint64 layout)
 {
+    if (d.constData()->channel_layout_ff == layout && d.constData()->channel_layout == channelLayoutFromFFmpeg(layout)
+            && d.constData()->channels == av_get_channel_layout_nb_channels(layout))
+        return;
     //FFmpeg channel layout is more complete, so we just it
     d->channel_layout = channelLayoutFromFFmpeg(layout);
     d->setChannelLayoutFF(layout);
@@ -302,6 +322,8 @@ int AudioFormat::channels() const
 */
 void AudioFormat::setSampleFormat(AudioFormat::SampleFormat sampleFormat)
 {
+    if (d.constData()->sample_fmt == sampleFormat)
+        return;
     d->sample_fmt = sampleFormat;
     d->av_sample_fmt = (AVSampleFormat)AudioFormat::sampleFormatToFFmpeg(sampleFormat);
 }
@@ -316,6 +338,8 @@ AudioFormat::SampleFormat AudioFormat::sampleFormat() const
 
 void AudioFormat::setSampleFormatFFmpeg(int ffSampleFormat)
 {
+    if (d.constData()->av_sample_fmt == ffSampleFormat)
+        return;
     d->sample_fmt = AudioFormat::sampleFormatFromFFmpeg(ffSampleFormat);
     d->av_sample_fmt = (AVSampleFormat)ffSampleFormat;
 }
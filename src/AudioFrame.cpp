@@ -23,6 +23,7 @@
 #include "QtAV/private/Frame_p.h"
 #include "QtAV/AudioResampler.h"
 #include "QtAV/private/AVCompat.h"
+#include "AudioRemix.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -251,6 +252,20 @@ AudioFrame AudioFrame::to(const AudioFormat &fmt) const
     //if (fmt == format())
       //  return clone(); //FIXME: clone a frame from ffmpeg is not enough?
     Q_D(const AudioFrame);
+    // interleave/downmix without resampling. the resampler may change speed
+    if (!d->conv || qFuzzyCompare(d->conv->speed(), 1.0)) {
+        AudioRemix remix;
+        if (remix.prepare(format(), fmt)) {
+            QByteArray data;
+            data.resize(fmt.bytesPerFrame()*samplesPerChannel()); // no zero fill
+            remix.convert((const quint8**)d->planes.constData(), samplesPerChannel(), (quint8*)data.data());
+            AudioFrame f(fmt, data);
+            f.setSamplesPerChannel(samplesPerChannel());
+            f.setTimestamp(timestamp());
+            f.d_ptr->metadata = d->metadata;
+            return f;
+        }
+    }
     // TODO: use a pool
     AudioResampler *conv = d->conv;
     QScopedPointer<AudioResampler> c;
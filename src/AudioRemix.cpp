@@ -0,0 +1,263 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "AudioRemix.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h> //memcpy
+#include "QtAV/private/AVCompat.h"
+#include "utils/GPUMemCopy.h"
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+int AudioS16ToFloat_SSE2(const int16_t *src, float *dst, int count);
+int AudioFloatToS16_SSE2(const float *src, int16_t *dst, int count);
+int AudioMix_SSE2(float *dst, const float *src, float c, int count, bool add);
+int AudioInterleave2Float_SSE2(const float *l, const float *r, float *dst, int count);
+int AudioInterleave2S16_SSE2(const float *l, const float *r, int16_t *dst, int count);
+#endif
+
+namespace {
+static const int kBlock = 256; // samples per channel. all blocks of a frame stay in L1
+static const float kCenterMix = (float)M_SQRT1_2; // swresample default center_mix_level
+static const float kSurroundMix = (float)M_SQRT1_2; // swresample default surround_mix_level
+
+static inline qint16 toS16(float x) { return av_clip_int16(lrintf(x*32768.0f));}
+
+static void s16ToFloat(const qint16 *src, int stride, float *dst, int n, bool sse2)
+{
+    int i = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    if (sse2 && stride == 1)
+        i = AudioS16ToFloat_SSE2(src, dst, n);
+#else
+    Q_UNUSED(sse2);
+#endif
+    for (; i < n; ++i)
+        dst[i] = float(src[i*stride])*(1.0f/32768.0f);
+}
+
+static void mix(float *dst, const float *src, float c, int n, bool add, bool sse2)
+{
+    int i = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    if (sse2)
+        i = AudioMix_SSE2(dst, src, c, n, add);
+#else
+    Q_UNUSED(sse2);
+#endif
+    if (add) {
+        for (; i < n; ++i)
+            dst[i] += c*src[i];
+    } else {
+        for (; i < n; ++i)
+            dst[i] = c*src[i];
+    }
+}
+
+static void storeFloat(const float *const *planes, int channels, float *dst, int n, bool sse2)
+{
+    if (channels == 1) {
+        memcpy(dst, planes[0], n*sizeof(float));
+        return;
+    }
+    int i = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    if (sse2 && channels == 2)
+        i = AudioInterleave2Float_SSE2(planes[0], planes[1], dst, n);
+#else
+    Q_UNUSED(sse2);
+#endif
+    for (; i < n; ++i) {
+        for (int c = 0; c < channels; ++c)
+            dst[i*channels + c] = planes[c][i];
+    }
+}
+
+static void storeS16(const float *const *planes, int channels, qint16 *dst, int n, bool sse2)
+{
+    int i = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    if (sse2 && channels == 1)
+        i = AudioFloatToS16_SSE2(planes[0], dst, n);
+    else if (sse2 && channels == 2)
+        i = AudioInterleave2S16_SSE2(planes[0], planes[1], dst, n);
+#else
+    Q_UNUSED(sse2);
+#endif
+    for (; i < n; ++i) {
+        for (int c = 0; c < channels; ++c)
+            dst[i*channels + c] = toS16(planes[c][i]);
+    }
+}
+} //namespace
+
+AudioRemix::AudioRemix()
+    : m_nb_in(0)
+    , m_nb_out(0)
+    , m_identity(false)
+{
+    memset(m_matrix, 0, sizeof(m_matrix));
+}
+
+bool AudioRemix::prepare(const AudioFormat &in, const AudioFormat &out)
+{
+    m_in = in;
+    m_out = out;
+    m_nb_in = in.channels();
+    m_nb_out = out.channels();
+    m_identity = false;
+    if (!in.isValid() || !out.isValid() || in.sampleRate() != out.sampleRate())
+        return false;
+    const AudioFormat::SampleFormat isf = in.sampleFormat();
+    if (isf != AudioFormat::SampleFormat_Signed16 && isf != AudioFormat::SampleFormat_Signed16Planar
+            && isf != AudioFormat::SampleFormat_Float && isf != AudioFormat::SampleFormat_FloatPlanar)
+        return false;
+    if (out.sampleFormat() != AudioFormat::SampleFormat_Signed16 && out.sampleFormat() != AudioFormat::SampleFormat_Float)
+        return false;
+    if (m_nb_in < 1 || m_nb_in > MaxChannels || m_nb_out < 1 || m_nb_out > MaxChannels)
+        return false;
+    const qint64 icl = in.channelLayoutFFmpeg();
+    const qint64 ocl = out.channelLayoutFFmpeg();
+    if (icl == ocl && m_nb_in == m_nb_out) {
+        m_identity = true;
+        return true;
+    }
+    memset(m_matrix, 0, sizeof(m_matrix));
+    if (ocl == AV_CH_LAYOUT_STEREO && icl == AV_CH_LAYOUT_MONO) {
+        m_matrix[0][0] = m_matrix[1][0] = (float)M_SQRT1_2;
+    } else if (ocl == AV_CH_LAYOUT_MONO && icl == AV_CH_LAYOUT_STEREO) {
+        m_matrix[0][0] = m_matrix[0][1] = (float)M_SQRT1_2;
+    } else if (ocl == AV_CH_LAYOUT_STEREO && (icl & AV_CH_LAYOUT_STEREO) == AV_CH_LAYOUT_STEREO) {
+        // channels are stored in the order of the layout bits
+        int c = 0;
+        for (int b = 0; b < 64 && c < m_nb_in; ++b) {
+            const qint64 ch = qint64(1) << b;
+            if (!(icl & ch))
+                continue;
+            switch (ch) {
+            case AV_CH_FRONT_LEFT:
+                m_matrix[0][c] = 1.0f;
+                break;
+            case AV_CH_FRONT_RIGHT:
+                m_matrix[1][c] = 1.0f;
+                break;
+            case AV_CH_FRONT_CENTER:
+                m_matrix[0][c] = m_matrix[1][c] = kCenterMix;
+                break;
+            case AV_CH_LOW_FREQUENCY: // swresample default lfe_mix_level is 0
+                break;
+            case AV_CH_BACK_LEFT:
+            case AV_CH_SIDE_LEFT:
+                m_matrix[0][c] = kSurroundMix;
+                break;
+            case AV_CH_BACK_RIGHT:
+            case AV_CH_SIDE_RIGHT:
+                m_matrix[1][c] = kSurroundMix;
+                break;
+            case AV_CH_BACK_CENTER:
+                m_matrix[0][c] = m_matrix[1][c] = kSurroundMix*(float)M_SQRT1_2;
+                break;
+            default: // wide, top etc.
+                return false;
+            }
+            ++c;
+        }
+        if (c != m_nb_in)
+            return false;
+    } else {
+        return false;
+    }
+    // swresample normalizes the matrix to avoid clipping if an integer format is involved
+    if (!in.isFloat() || !out.isFloat()) {
+        float maxsum = 0;
+        for (int o = 0; o < m_nb_out; ++o) {
+            float sum = 0;
+            for (int i = 0; i < m_nb_in; ++i)
+                sum += qAbs(m_matrix[o][i]);
+            maxsum = qMax(maxsum, sum);
+        }
+        if (maxsum > 1.0f) {
+            for (int o = 0; o < m_nb_out; ++o) {
+                for (int i = 0; i < m_nb_in; ++i)
+                    m_matrix[o][i] /= maxsum;
+            }
+        }
+    }
+    return true;
+}
+
+void AudioRemix::convert(const quint8 *const *src, int samples, quint8 *dst) const
+{
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    const bool sse2 = detect_sse2();
+#else
+    const bool sse2 = false;
+#endif
+    float buf[MaxChannels][kBlock];
+    float mixed[2][kBlock];
+    const float *planes[MaxChannels];
+    const float *outs[MaxChannels];
+    const bool planar = m_in.isPlanar();
+    const bool in_float = m_in.isFloat();
+    for (int pos = 0; pos < samples; pos += kBlock) {
+        const int n = qMin(kBlock, samples - pos);
+        // load as float planes. planar float is used in place
+        for (int c = 0; c < m_nb_in; ++c) {
+            if (planar && in_float) {
+                planes[c] = (const float*)src[c] + pos;
+                continue;
+            }
+            if (planar) {
+                s16ToFloat((const qint16*)src[c] + pos, 1, buf[c], n, sse2);
+            } else if (in_float) {
+                const float *s = (const float*)src[0] + pos*m_nb_in + c;
+                for (int i = 0; i < n; ++i)
+                    buf[c][i] = s[i*m_nb_in];
+            } else {
+                s16ToFloat((const qint16*)src[0] + pos*m_nb_in + c, m_nb_in, buf[c], n, sse2);
+            }
+            planes[c] = buf[c];
+        }
+        if (m_identity) {
+            for (int c = 0; c < m_nb_out; ++c)
+                outs[c] = planes[c];
+        } else {
+            for (int o = 0; o < m_nb_out; ++o) {
+                bool add = false;
+                for (int i = 0; i < m_nb_in; ++i) {
+                    if (m_matrix[o][i] == 0.0f)
+                        continue;
+                    mix(mixed[o], planes[i], m_matrix[o][i], n, add, sse2);
+                    add = true;
+                }
+                if (!add)
+                    memset(mixed[o], 0, n*sizeof(float));
+                outs[o] = mixed[o];
+            }
+        }
+        if (m_out.isFloat())
+            storeFloat(outs, m_nb_out, (float*)dst + pos*m_nb_out, n, sse2);
+        else
+            storeS16(outs, m_nb_out, (qint16*)dst + pos*m_nb_out, n, sse2);
+    }
+}
+} //namespace QtAV
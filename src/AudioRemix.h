@@ -0,0 +1,55 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOREMIX_H
+#define QTAV_AUDIOREMIX_H
+
+#include <QtAV/AudioFormat.h>
+
+namespace QtAV {
+/*!
+ * \brief The AudioRemix class
+ * Fast path of AudioFrame::to() for conversions without resampling: s16/float planar or packed input to packed s16/float output,
+ * with the same channels, mono to stereo, stereo to mono, or a surround layout to stereo using the default matrix of swresample.
+ * Samples are processed in small blocks of float on the stack, no allocation. Other conversions must use AudioResampler.
+ */
+class AudioRemix
+{
+public:
+    enum { MaxChannels = 8 };
+    AudioRemix();
+    /// \return false if the conversion is not supported
+    bool prepare(const AudioFormat& in, const AudioFormat& out);
+    /*!
+     * \brief convert
+     * \param src input planes. 1 plane for packed input
+     * \param samples samples per channel
+     * \param dst packed output of out.bytesPerFrame()*samples bytes
+     */
+    void convert(const quint8* const *src, int samples, quint8* dst) const;
+private:
+    AudioFormat m_in, m_out;
+    int m_nb_in, m_nb_out;
+    bool m_identity;
+    float m_matrix[2][MaxChannels]; // [out][in]. not used if m_identity
+};
+} //namespace QtAV
+#endif // QTAV_AUDIOREMIX_H
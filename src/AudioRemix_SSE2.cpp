@@ -0,0 +1,99 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace QtAV {
+
+/*
+ * Kernels of AudioRemix. Functions process the first part of count samples and return the number processed, the caller processes the rest.
+ */
+int AudioS16ToFloat_SSE2(const int16_t *src, float *dst, int count)
+{
+    const __m128 k = _mm_set1_ps(1.0f/32768.0f);
+    const int n = count & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        // sign extend by shifting the 16 bits into the high half
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+    return n;
+}
+
+int AudioFloatToS16_SSE2(const float *src, int16_t *dst, int count)
+{
+    const __m128 k = _mm_set1_ps(32768.0f);
+    const int n = count & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), k));
+        const __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), k));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi)); // saturated
+    }
+    return n;
+}
+
+// dst = c*src, or dst += c*src if add
+int AudioMix_SSE2(float *dst, const float *src, float c, int count, bool add)
+{
+    const __m128 k = _mm_set1_ps(c);
+    const int n = count & ~3;
+    if (add) {
+        for (int i = 0; i < n; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), k)));
+    } else {
+        for (int i = 0; i < n; i += 4)
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), k));
+    }
+    return n;
+}
+
+int AudioInterleave2Float_SSE2(const float *l, const float *r, float *dst, int count)
+{
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4) {
+        const __m128 a = _mm_loadu_ps(l + i);
+        const __m128 b = _mm_loadu_ps(r + i);
+        _mm_storeu_ps(dst + 2*i, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(dst + 2*i + 4, _mm_unpackhi_ps(a, b));
+    }
+    return n;
+}
+
+int AudioInterleave2S16_SSE2(const float *l, const float *r, int16_t *dst, int count)
+{
+    const __m128 k = _mm_set1_ps(32768.0f);
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4) {
+        const __m128 a = _mm_mul_ps(_mm_loadu_ps(l + i), k);
+        const __m128 b = _mm_mul_ps(_mm_loadu_ps(r + i), k);
+        const __m128i lo = _mm_cvtps_epi32(_mm_unpacklo_ps(a, b));
+        const __m128i hi = _mm_cvtps_epi32(_mm_unpackhi_ps(a, b));
+        _mm_storeu_si128((__m128i*)(dst + 2*i), _mm_packs_epi32(lo, hi));
+    }
+    return n;
+}
+
+} //namespace QtAV
+#endif
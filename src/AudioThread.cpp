@@ -350,7 +350,16 @@ void AudioThread::run()
                    // if (da > 1.0) { // what if frame duration is long?
                    // }
                     // TODO: check seek_requested(atomic bool)
-                    d.clock->updateValue(ao->timestamp());
+                    const qreal latency = ao->deviceLatency();
+                    if (latency >= 0) {
+                        // audible = end of written data - measured device latency
+                        // latency is device (wall) time, the resampler plays speed() seconds of media per second
+                        d.clock->updateValue(pts + chunk_delay);
+                        d.clock->updateDelay(-latency*ao->speed());
+                    } else {
+                        d.clock->updateValue(ao->timestamp());
+                        d.clock->updateDelay(0); // no stale latency from a previous measurement
+                    }
                 }
             } else {
                 d.clock->updateDelay(delay += chunk_delay);
@@ -0,0 +1,121 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "BufferController.h"
+#include "PacketBuffer.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+static const qint64 kWindow = 1000; // ms
+static const int kSteadyWindows = 5;
+static const qreal kSlowRate = 0.95;
+static const qreal kSteadyRate = 0.98;
+static const qreal kGrowFactor = 1.5;
+static const qreal kShrinkFactor = 0.8;
+
+BufferController::BufferController()
+    : m_shrink(false)
+    , m_base(0)
+    , m_value(0)
+    , m_rate(0)
+    , m_steady(0)
+    , m_pts0(-1)
+    , m_pts1(-1)
+    , m_min_level(-1)
+    , m_was_buffering(true)
+    , m_underrun(false)
+{
+}
+
+void BufferController::reset(qint64 base)
+{
+    m_base = qMax<qint64>(1, base);
+    m_value = m_base;
+    m_rate = 0;
+    m_steady = 0;
+    m_was_buffering = true;
+    resetWindow();
+}
+
+void BufferController::resetWindow()
+{
+    m_timer.start();
+    m_pts0 = m_pts1 = -1;
+    m_min_level = -1; // buffering in the whole window
+    m_underrun = false;
+}
+
+void BufferController::received(const Packet &packet)
+{
+    if (packet.pts < 0 || packet.isEOF())
+        return;
+    // discontinuity or seek
+    if (m_pts1 >= 0 && (packet.pts < m_pts1 - 1.0 || packet.pts > m_pts1 + 10.0)) {
+        resetWindow();
+    }
+    if (m_pts0 < 0)
+        m_pts0 = packet.pts;
+    m_pts1 = qMax(m_pts1, packet.pts);
+}
+
+BufferController::Decision BufferController::update(PacketBuffer *buf)
+{
+    if (!buf || m_base <= 0)
+        return Hold;
+    const bool buffering = buf->isBuffering();
+    if (buffering && !m_was_buffering)
+        m_underrun = true;
+    m_was_buffering = buffering;
+    if (!buffering && buf->bufferValue() > 0) {
+        const qreal level = qreal(buf->buffered())/qreal(buf->bufferValue());
+        m_min_level = m_min_level < 0 ? level : qMin(m_min_level, level);
+    }
+    const qint64 elapsed = m_timer.elapsed();
+    if (elapsed < kWindow)
+        return Hold;
+    const bool measured = m_pts0 >= 0 && m_pts1 > m_pts0;
+    if (measured)
+        m_rate = (m_pts1 - m_pts0)*1000.0/qreal(elapsed);
+    Decision decision = Hold;
+    qint64 value = m_value;
+    if (m_underrun || (measured && m_rate < kSlowRate && m_min_level < 1.0/buf->bufferMax())) {
+        value = qMin<qint64>(m_base*8LL, qint64(qreal(m_value)*kGrowFactor) + 1LL);
+        decision = Grow;
+        m_steady = 0;
+    } else if (!buffering && measured && m_rate >= kSteadyRate && m_min_level >= 1.0) {
+        if (++m_steady >= kSteadyWindows && m_shrink) {
+            value = qMax<qint64>(qMax<qint64>(1LL, m_base/4LL), qint64(qreal(m_value)*kShrinkFactor));
+            decision = Shrink;
+            m_steady = 0;
+        }
+    } else {
+        m_steady = 0;
+    }
+    resetWindow();
+    if (value == m_value)
+        return Hold;
+    qDebug("adaptive buffer %s: %lld => %lld. input rate: %.3f, min level: %.3f", decision == Grow ? "grow" : "shrink", m_value, value, m_rate, m_min_level);
+    m_value = value;
+    buf->setBufferValue(m_value);
+    return decision;
+}
+
+} //namespace QtAV
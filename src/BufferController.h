@@ -0,0 +1,76 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_BUFFERCONTROLLER_H
+#define QTAV_BUFFERCONTROLLER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtAV/Packet.h>
+
+namespace QtAV {
+
+class PacketBuffer;
+/*!
+ * \brief The BufferController class
+ * Adaptive buffering policy for the primary PacketBuffer, used in demux thread.
+ * Input rate is media time received per second of real time, measured over 1s windows. Buffer value grows if
+ * playback rebuffers, or if input is slower than real time and the buffered level drops below bufferValue()/bufferMax().
+ * If shrink is enabled (low latency live), the value shrinks when input has been steady for a few windows and
+ * the level stays above bufferValue(). The band between the two levels is the hysteresis.
+ * The value is kept in [base/4, base*8], where base is the value when playback starts.
+ */
+class BufferController
+{
+public:
+    enum Decision {
+        Hold,
+        Grow,
+        Shrink
+    };
+    BufferController();
+    void setShrinkEnabled(bool value) { m_shrink = value;}
+    bool isShrinkEnabled() const { return m_shrink;}
+    void reset(qint64 base);
+    /// call for each packet put into the primary buffer
+    void received(const Packet& packet);
+    /// evaluate the current window and apply the new value to \a buf
+    Decision update(PacketBuffer *buf);
+    qint64 value() const { return m_value;}
+    /// 1.0: real time
+    qreal inputRate() const { return m_rate;}
+private:
+    void resetWindow();
+
+    bool m_shrink;
+    qint64 m_base;
+    qint64 m_value;
+    qreal m_rate;
+    int m_steady; // number of steady windows in a row
+    // current window
+    QElapsedTimer m_timer;
+    qreal m_pts0, m_pts1;
+    qreal m_min_level;
+    bool m_was_buffering;
+    bool m_underrun;
+};
+
+} //namespace QtAV
+#endif // QTAV_BUFFERCONTROLLER_H
@@ -0,0 +1,379 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/ClockGroup.h"
+#include <math.h>
+#include <QtCore/QMutex>
+#include "QtAV/AVPlayer.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+static const int kMaxDropsInRow = 2;
+static const qreal kLateTolerance = 0.04; // if refresh rate is not set
+
+class ClockGroup::Private
+{
+public:
+    struct Member {
+        Member() : player(0), clock(0), last_t(-1), last_tick(-1), late_in_row(0) {}
+        AVPlayer *player;
+        AVClock *clock;
+        qreal last_t; // timestamp relative to media start of the displayed frame
+        qint64 last_tick;
+        int late_in_row;
+    };
+    Private()
+        : master(0)
+        , interval(1.0/60.0)
+        , paused(false)
+        , nb_starting(0)
+        , nb_seeking(0)
+        , seek_pos(0)
+    {}
+    int indexOf(AVPlayer *player) const {
+        for (int i = 0; i < members.size(); ++i) {
+            if (members.at(i).player == player)
+                return i;
+        }
+        return -1;
+    }
+    Member* member(AVClock *clock) {
+        for (int i = 0; i < members.size(); ++i) {
+            if (members.at(i).clock == clock)
+                return &members[i];
+        }
+        return 0;
+    }
+    // called when all players are started
+    void startMaster() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        master->start();
+        if (paused)
+            master->pause(true);
+    }
+    void resetMembers() {
+        for (int i = 0; i < members.size(); ++i) {
+            members[i].last_t = -1;
+            members[i].last_tick = -1;
+            members[i].late_in_row = 0;
+        }
+    }
+
+    mutable QMutex mutex; // master clock is accessed by video threads of all players
+    AVClock *master;
+    QList<Member> members;
+    qreal interval;
+    bool paused;
+    int nb_starting;
+    int nb_seeking;
+    qint64 seek_pos;
+    SkewStatistics stat;
+};
+
+ClockGroup::ClockGroup(QObject *parent)
+    : QObject(parent)
+    , d(new Private())
+{
+    d->master = new AVClock(AVClock::ExternalClock, this);
+    d->master->setClockAuto(false);
+}
+
+ClockGroup::~ClockGroup()
+{
+    while (!d->members.isEmpty())
+        removePlayer(d->members.last().player);
+}
+
+AVClock* ClockGroup::clock() const
+{
+    return d->master;
+}
+
+void ClockGroup::addPlayer(AVPlayer *player)
+{
+    if (!player || d->indexOf(player) >= 0)
+        return;
+    AVClock *c = player->masterClock();
+    c->setClockAuto(false);
+    c->setClockType(AVClock::ExternalClock);
+    Private::Member m;
+    m.player = player;
+    m.clock = c;
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        d->members.append(m);
+    }
+    // not in d->mutex. AVClock locks its group mutex then d->mutex
+    c->setGroup(this);
+    connect(player, SIGNAL(started()), SLOT(onPlayerStarted()));
+    connect(player, SIGNAL(seekFinished(qint64)), SLOT(onPlayerSeekFinished()));
+    connect(player, SIGNAL(destroyed(QObject*)), SLOT(onPlayerDestroyed(QObject*)));
+}
+
+void ClockGroup::removePlayer(AVPlayer *player)
+{
+    const int idx = d->indexOf(player);
+    if (idx < 0)
+        return;
+    disconnect(player, 0, this, 0);
+    AVClock *c = d->members.at(idx).clock;
+    // the player may be playing. its threads do not use this group after setGroup() returns
+    c->setGroup(0);
+    qreal t = 0;
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        t = d->master->value();
+        d->members.removeAt(idx);
+    }
+    // continue from the group time
+    c->updateExternalClock(qint64(t*1000.0));
+    c->setClockAuto(true);
+}
+
+QList<AVPlayer*> ClockGroup::players() const
+{
+    QList<AVPlayer*> ps;
+    foreach (const Private::Member& m, d->members) {
+        ps.append(m.player);
+    }
+    return ps;
+}
+
+void ClockGroup::setRefreshRate(qreal hz)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->interval = hz > 0 ? 1.0/hz : 0;
+}
+
+qreal ClockGroup::refreshRate() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->interval > 0 ? 1.0/d->interval : 0;
+}
+
+ClockGroup::SkewStatistics ClockGroup::skewStatistics() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->stat;
+}
+
+void ClockGroup::resetStatistics()
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->stat = SkewStatistics();
+}
+
+qreal ClockGroup::value() const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    return d->master->value();
+}
+
+qreal ClockGroup::presentTime(qreal t) const
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    if (d->interval <= 0)
+        return t;
+    // the first tick not earlier than t. tolerate timestamp rounding error
+    return ceil(t/d->interval - 0.01)*d->interval;
+}
+
+bool ClockGroup::checkLate(AVClock *clock, qreal tick)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    Private::Member *m = d->member(clock);
+    if (!m)
+        return false;
+    const qreal late = d->master->value() - tick;
+    if (late <= (d->interval > 0 ? d->interval : kLateTolerance)) {
+        m->late_in_row = 0;
+        return false;
+    }
+    if (++m->late_in_row > kMaxDropsInRow) {
+        m->late_in_row = 0;
+        return false;
+    }
+    d->stat.drops++;
+    return true;
+}
+
+void ClockGroup::framePresented(AVClock *clock, qreal t)
+{
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    Private::Member *m = d->member(clock);
+    if (!m)
+        return;
+    if (d->interval > 0) {
+        const qint64 tick = qint64(floor(d->master->value()/d->interval + 0.5));
+        if (m->last_tick >= 0) {
+            // a late frame is presented on a later tick, the previous frame is displayed longer
+            const qint64 expected = qRound64((t - m->last_t)/d->interval);
+            const qint64 actual = tick - m->last_tick;
+            if (expected > 0 && actual > expected)
+                d->stat.repeats += actual - expected;
+        }
+        m->last_tick = tick;
+    }
+    m->last_t = t;
+    qreal t_min = t, t_max = t;
+    foreach (const Private::Member& mb, d->members) {
+        if (mb.last_t < 0) // not all players display a frame
+            return;
+        t_min = qMin(t_min, mb.last_t);
+        t_max = qMax(t_max, mb.last_t);
+    }
+    SkewStatistics &s = d->stat;
+    s.current = t_max - t_min;
+    s.samples++;
+    s.average += (s.current - s.average)/qreal(s.samples);
+    s.maximum = qMax(s.maximum, s.current);
+}
+
+void ClockGroup::play()
+{
+    QList<AVPlayer*> ps;
+    foreach (const Private::Member& m, d->members) {
+        if (!m.player->isPlaying())
+            ps.append(m.player);
+    }
+    if (ps.isEmpty()) { // already playing
+        pause(false);
+        return;
+    }
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        d->master->reset();
+        d->resetMembers();
+    }
+    d->paused = false;
+    d->nb_seeking = 0;
+    d->nb_starting = ps.size();
+    foreach (AVPlayer *p, ps) {
+        p->play();
+    }
+}
+
+void ClockGroup::pause(bool p)
+{
+    d->paused = p;
+    foreach (const Private::Member& m, d->members) {
+        m.player->pause(p);
+    }
+    if (d->nb_starting > 0 || d->nb_seeking > 0) // resumed when finished
+        return;
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->master->pause(p);
+}
+
+void ClockGroup::stop()
+{
+    d->nb_starting = 0;
+    d->nb_seeking = 0;
+    foreach (const Private::Member& m, d->members) {
+        m.player->stop();
+    }
+    QMutexLocker lock(&d->mutex);
+    Q_UNUSED(lock);
+    d->master->reset();
+    d->resetMembers();
+}
+
+void ClockGroup::seek(qint64 pos)
+{
+    QList<AVPlayer*> ps;
+    foreach (const Private::Member& m, d->members) {
+        // AVPlayer::setPosition() does nothing out of range, and seekFinished() will never be emitted
+        if (m.player->isPlaying() && pos <= m.player->normalizedPosition(m.player->stopPosition()))
+            ps.append(m.player);
+    }
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        d->master->pause(true);
+        d->master->updateExternalClock(pos);
+        d->resetMembers();
+    }
+    d->seek_pos = pos;
+    d->nb_seeking = ps.size() + 1; // +1: finished after all players are requested
+    qDebug("ClockGroup seek %lld. players: %d", pos, ps.size());
+    foreach (AVPlayer *p, ps) {
+        p->seek(pos);
+    }
+    onPlayerSeekFinished();
+}
+
+void ClockGroup::onPlayerStarted()
+{
+    if (d->nb_starting <= 0 || --d->nb_starting > 0)
+        return;
+    qDebug("ClockGroup: all players are started");
+    d->startMaster();
+    Q_EMIT started();
+}
+
+void ClockGroup::onPlayerSeekFinished()
+{
+    if (--d->nb_seeking > 0)
+        return;
+    if (d->nb_seeking < 0) { // not a group seek
+        d->nb_seeking = 0;
+        return;
+    }
+    qDebug("ClockGroup: all players seek finished");
+    if (!d->paused && d->nb_starting <= 0) {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        d->master->pause(false);
+    }
+    Q_EMIT seekFinished(d->seek_pos);
+}
+
+void ClockGroup::onPlayerDestroyed(QObject *obj)
+{
+    // the clock is already destroyed with the player
+    const int idx = d->indexOf(static_cast<AVPlayer*>(obj));
+    if (idx < 0)
+        return;
+    {
+        QMutexLocker lock(&d->mutex);
+        Q_UNUSED(lock);
+        d->members.removeAt(idx);
+    }
+    // do not wait for it
+    if (d->nb_starting > 0)
+        onPlayerStarted();
+    if (d->nb_seeking > 0)
+        onPlayerSeekFinished();
+}
+} //namespace QtAV
@@ -56,7 +56,41 @@ int Frame::bytesPerLine(int plane) const
 
 QByteArray Frame::frameData() const
 {
-    return d_func()->data;
+    Q_D(const Frame);
+    // pooled memory is not owned by d->data and goes back to the pool with the last frame ref, but the result can outlive the frame
+    if (d->buffer)
+        return QByteArray(d->data.constData(), d->data.size());
+    return d->data;
+}
+
+uchar* Frame::frameDataPtr(int *size) const
+{
+    Q_D(const Frame);
+    const int a = d->data_align;
+    uchar* p = (uchar*)d->data.constData();
+    const int offset = a > 0 ? (a - ((quintptr)p & (a-1))) & (a-1) : 0;
+    if (size)
+        *size = d->data.size() - offset;
+    return p+offset;
+}
+
+bool Frame::isWritable() const
+{
+    Q_D(const Frame);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    if (d->ref.loadRelaxed() != 1)
+#else
+    if (d->ref.load() != 1)
+#endif
+        return false;
+    if (d->data.isEmpty() || !d->data.isDetached() || d->planes.isEmpty())
+        return false;
+    const uchar *data = (const uchar*)d->data.constData();
+    foreach (const uchar* p, d->planes) {
+        if (p < data || p >= data + d->data.size())
+            return false;
+    }
+    return true;
 }
 
 int Frame::dataAlignment() const
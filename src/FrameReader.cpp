@@ -29,21 +29,10 @@
 namespace QtAV {
 typedef QtAV::BlockingQueue<VideoFrame> VideoFrameQueue;
 const int kQueueMin = 2;
-static QVariantHash dec_opt_framedrop;
-static QVariantHash dec_opt_normal;
 
 class FrameReader::Private {
 public:
-    Private() : nb_seek(0) {
-        QVariantHash opt;
-        opt[QString::fromLatin1("skip_frame")] = 8; // 8 for "avcodec", "NoRef" for "FFmpeg". see AVDiscard
-        opt[QString::fromLatin1("skip_loop_filter")] = 8; //skip all?
-        //skip_dict is slower
-        dec_opt_framedrop[QString::fromLatin1("avcodec")] = opt;
-        opt[QString::fromLatin1("skip_frame")] = 0; // 0 for "avcodec", "Default" for "FFmpeg". see AVDiscard
-        opt[QString::fromLatin1("skip_loop_filter")] = 0;
-        dec_opt_normal[QString::fromLatin1("avcodec")] = opt; // avcodec need correct string or value in libavcodec
-
+    Private() : nb_seek(0), load_failed(false) {
         //decs = QStringList() << "VideoToolbox" << "FFmpeg";
         vframes.setCapacity(4);
         vframes.setThreshold(kQueueMin); //
@@ -64,6 +53,7 @@ public:
     VideoFrameQueue vframes;
     QThread read_thread;
     int nb_seek;
+    volatile bool load_failed; // set in read thread. readMore() returns false until media changed
 };
 
 bool FrameReader::Private::tryLoad()
@@ -166,7 +156,7 @@ qint64 FrameReader::Private::seekInternal(qint64 value)
         return -1;
     }
     decoder->flush(); //must flush otherwise old frames will be decoded at the beginning
-    decoder->setOptions(dec_opt_normal);
+    decoder->setDiscardLevel(VideoDecoder::DiscardDefault);
     // must decode key frame
     int k = 0;
     while (k < 2 && !frame.isValid()) {
@@ -186,7 +176,7 @@ qint64 FrameReader::Private::seekInternal(qint64 value)
             return qint64(frame.timestamp()*1000.0);
         }
     }
-    QVariantHash* dec_opt = &dec_opt_normal; // 0: default, 1: framedrop
+    bool framedrop = false;
     // decode at the given position
     while (!demuxer.atEnd()) {
         if (!demuxer.readFrame())
@@ -206,13 +196,15 @@ qint64 FrameReader::Private::seekInternal(qint64 value)
             //return false; //??
         }
         qint64 diff = qint64(t*1000.0) - value;
-        QVariantHash *dec_opt_old = dec_opt;
-        if (nb_seek == 0 || diff >= 0)
-            dec_opt = &dec_opt_normal;
-        else
-            dec_opt = &dec_opt_framedrop;
-        if (dec_opt != dec_opt_old)
-            decoder->setOptions(*dec_opt);
+        // skip decoding non-ref frames before the desired position
+        const bool drop = nb_seek > 0 && diff < 0;
+        if (drop != framedrop) {
+            framedrop = drop;
+            if (framedrop)
+                decoder->setDiscardLevel(VideoDecoder::DiscardNonRef, VideoDecoder::DiscardNonRef);
+            else
+                decoder->setDiscardLevel(VideoDecoder::DiscardDefault);
+        }
         // invalid packet?
         if (!decoder->decode(pkt)) {
             qWarning("!!!!!!!!!decode failed!!!!");
@@ -265,6 +257,7 @@ void FrameReader::setMedia(const QString &url)
     if (url == d->url)
         return;
     d->url = url;
+    d->load_failed = false;
 }
 
 QString FrameReader::mediaUrl() const
@@ -301,6 +294,8 @@ bool FrameReader::hasEnoughVideoFrames() const
 
 bool FrameReader::readMore()
 {
+    if (d->load_failed)
+        return false;
     if (d->demuxer.isLoaded() && d->demuxer.atEnd()) {
         if (!d->read_thread.isRunning())
             return false;
@@ -327,11 +322,21 @@ void FrameReader::readMoreInternal()
 {
     if (!d->tryLoad()) {
         qDebug("load error");
+        d->load_failed = true;
+        // the caller may be blocked in getVideoFrame()
+        d->vframes.blockFull(false);
+        d->vframes.put(VideoFrame());
+        d->vframes.blockFull(true);
+        Q_EMIT readEnd();
         return;
     }
     //TODO: decode eof packets
-    if (d->demuxer.atEnd())
+    if (d->demuxer.atEnd()) {
+        d->vframes.blockFull(false);
+        d->vframes.put(VideoFrame()); //make sure take() will not be blocked
+        d->vframes.blockFull(true);
         return;
+    }
     const int vstream = d->demuxer.videoStream();
     Packet pkt;
     while (!d->demuxer.atEnd()) {
@@ -49,6 +49,11 @@ QByteArray ImageConverter::outData() const
     return d.data_out;
 }
 
+QSharedPointer<FrameBuffer> ImageConverter::outBuffer() const
+{
+    return d_func().out_buffer;
+}
+
 bool ImageConverter::check() const
 {
     DPTR_D(const ImageConverter);
@@ -224,8 +229,14 @@ bool ImageConverter::prepareData()
     int s = av_image_fill_pointers((uint8_t**)d.bits.constData(), d.fmt_out, d.h_out, NULL, d.pitchs.constData());
     if (s < 0)
         return false;
-    d.data_out.resize(s + kAlign-1);
-    d.out_offset = (kAlign - ((uintptr_t)d.data_out.constData() & (kAlign-1))) & (kAlign-1);
+    // release the old block first, so it can be reused if no frame references it
+    d.data_out.clear();
+    d.out_buffer.clear();
+    d.out_buffer = FrameBufferPool::get(s);
+    if (!d.out_buffer)
+        return false;
+    d.data_out = d.out_buffer->toByteArray(); // FrameBufferPool::Alignment is a multiple of kAlign
+    d.out_offset = 0;
     AV_ENSURE(av_image_fill_pointers((uint8_t**)d.bits.constData(), d.fmt_out, d.h_out, (uint8_t*)d.data_out.constData()+d.out_offset, d.pitchs.constData()), false);
     // TODO: special formats
     //if (desc->flags & AV_PIX_FMT_FLAG_PAL || desc->flags & AV_PIX_FMT_FLAG_PSEUDOPAL)
@@ -26,10 +26,12 @@
 #include <QtAV/QtAV_Global.h>
 #include <QtAV/VideoFormat.h>
 #include <QtCore/QVector>
+#include <QtCore/QSharedPointer>
 
 namespace QtAV {
 
 typedef int ImageConverterId;
+class FrameBuffer;
 class ImageConverterPrivate;
 class ImageConverter //export is not needed
 {
@@ -42,6 +44,8 @@ public:
 
     // the real data starts with DataAlignment (16bit) aligned address
     QByteArray outData() const;
+    // the pooled memory of outData() if any. frames made from outData() must keep a reference to it
+    QSharedPointer<FrameBuffer> outBuffer() const;
     // return false if i/o format not supported, or size is not valid.
     // TODO: use isSupported(i/o format);
     virtual bool check() const;
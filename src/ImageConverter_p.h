@@ -25,6 +25,7 @@
 
 #include <QtAV/private/AVCompat.h>
 #include <QtCore/QVector>
+#include "utils/FrameBufferPool.h"
 
 namespace QtAV {
 
@@ -60,6 +61,7 @@ public:
     bool update_data;
     int out_offset;
     QByteArray data_out;
+    FrameBufferRef out_buffer; // referenced by data_out if not null
     QVector<quint8*> bits;
     QVector<int> pitchs;
 };
@@ -32,6 +32,8 @@ PacketBuffer::PacketBuffer()
     , m_value0(0)
     , m_value1(0)
     , m_history(kAvgSize)
+    , m_keep_key(false)
+    , m_keep_pts(-1)
 {
 }
 
@@ -109,6 +111,16 @@ qreal PacketBuffer::bufferSpeedInBytes() const
     return calc_speed(true);
 }
 
+void PacketBuffer::setKeepFromKeyFrame(bool value)
+{
+    m_keep_key = value;
+}
+
+void PacketBuffer::setKeepFromPts(qreal pts)
+{
+    m_keep_pts = pts;
+}
+
 bool PacketBuffer::checkEnough() const
 {
     return buffered() >= bufferValue();
@@ -119,8 +131,32 @@ bool PacketBuffer::checkFull() const
     return buffered() >= qint64(qreal(bufferValue())*bufferMax());
 }
 
+void PacketBuffer::dropKept(const Packet &p)
+{
+    const int n = queue.size();
+    if (m_keep_key && p.hasKeyFrame) {
+        while (queue.size() > 1)
+            queue.dequeue();
+    } else if (m_keep_pts >= 0) {
+        while (queue.size() > 1 && queue.head().pts < m_keep_pts)
+            queue.dequeue();
+    }
+    if (n == queue.size())
+        return;
+    // p (the tail) is not counted yet. it's added in onPut()
+    if (m_mode == BufferBytes) {
+        m_value1 = 0;
+        for (int i = 0; i < queue.size() - 1; ++i)
+            m_value1 += queue.at(i).data.size();
+    } else if (m_mode == BufferPackets) {
+        m_value1 = queue.size() - 1;
+    } // BufferTime: m_value0 is updated in onPut()
+}
+
 void PacketBuffer::onPut(const Packet &p)
 {
+    if (m_keep_key || m_keep_pts >= 0)
+        dropKept(p);
     if (m_mode == BufferTime) {
         m_value1 = qint64(p.pts*1000.0); // FIXME: what if no pts
         m_value0 = qint64(queue[0].pts*1000.0); // must compute here because it is reset to 0 if take from empty
@@ -77,6 +77,17 @@ public:
      */
     qreal bufferSpeed() const;
     qreal bufferSpeedInBytes() const;
+    /*!
+     * \brief setKeepFromKeyFrame
+     * For a queue not being taken, e.g. standby mode. If true, packets before the last key frame packet are dropped on put,
+     * so decoding can start immediately from the queue head.
+     */
+    void setKeepFromKeyFrame(bool value);
+    /*!
+     * \brief setKeepFromPts
+     * Drop packets whose pts is less than \a pts on put. Used for streams without key frame sync (audio). < 0: disabled
+     */
+    void setKeepFromPts(qreal pts);
 protected:
     bool checkEnough() const Q_DECL_OVERRIDE;
     bool checkFull() const Q_DECL_OVERRIDE;
@@ -91,6 +102,8 @@ protected:
 
 private:
     qreal calc_speed(bool use_bytes) const;
+    // called in onPut()
+    void dropKept(const Packet& p);
 
     BufferMode m_mode;
     bool m_buffering;
@@ -104,6 +117,8 @@ private:
         qint64 t;
     } BufferInfo;
     ring<BufferInfo> m_history;
+    bool m_keep_key;
+    qreal m_keep_pts;
 };
 
 } //namespace QtAV
@@ -25,6 +25,7 @@
 #include <QtAV/QtAV_Global.h>
 #include <QtCore/QAtomicInt>
 #include <QtCore/QBasicTimer>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
 #include <QtCore/QElapsedTimer>
@@ -43,9 +44,11 @@ namespace QtAV {
 
 static const double kThousandth = 0.001;
 
+class ClockGroup;
 class Q_AV_EXPORT AVClock : public QObject
 {
     Q_OBJECT
+    friend class ClockGroup;
 public:
     typedef enum {
         AudioClock,
@@ -93,6 +96,17 @@ public:
     inline qreal speed() const;
 
     bool isPaused() const;
+    /*!
+     * \brief group
+     * If the clock is in a ClockGroup, value() is initialValue() + the group clock value, and updateExternalClock() is ignored.
+     * The group can be removed or destroyed in its thread at any time. Other threads (e.g. video thread) must use groupXXX() functions.
+     */
+    ClockGroup* group() const;
+    // ClockGroup functions for the player of this clock. thread safe. no-op and return false if not in a group
+    /// \a tick: when the frame with timestamp \a t (relative to media start) should be presented. see ClockGroup::presentTime()
+    bool groupPresentTime(qreal t, qreal *tick) const;
+    bool groupCheckLate(qreal tick);
+    bool groupFramePresented(qreal t);
 
     /*!
      * \brief syncStart
@@ -132,6 +146,12 @@ private Q_SLOTS:
     void restartCorrectionTimer();
     void stopCorrectionTimer();
 private:
+    void setGroup(ClockGroup *group);
+    bool groupValue(double *v) const;
+
+    mutable QMutex group_mutex; // m_group is detached in ClockGroup thread while it's used in avthreads
+    ClockGroup *m_group;
+    QAtomicInt has_group; // check without group_mutex. m_group is checked again with the lock
     bool auto_clock;
     int m_state;
     ClockType clock_type;
@@ -160,6 +180,9 @@ private:
 
 double AVClock::value() const
 {
+    double gv = 0;
+    if (groupValue(&gv))
+        return value0 + gv;
     if (clock_type == AudioClock) {
         // TODO: audio clock need a timer too
         // timestamp from media stream is >= value0
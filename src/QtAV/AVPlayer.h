@@ -84,6 +84,7 @@ class Q_AV_EXPORT AVPlayer : public QObject
     Q_PROPERTY(QtAV::MediaEndAction mediaEndAction READ mediaEndAction WRITE setMediaEndAction NOTIFY mediaEndActionChanged)
     Q_PROPERTY(unsigned int chapters READ chapters NOTIFY chaptersChanged)
     Q_ENUMS(State)
+    Q_ENUMS(LoadPart)
 public:
     /*!
      * \brief The State enum
@@ -94,6 +95,17 @@ public:
         PlayingState, /// Start to play if it was stopped, or resume if it was paused
         PausedState
     };
+    /*!
+     * \brief The LoadPart enum
+     * Parts of load() and play(). Independent parts are opened in parallel: the main media with the external audio,
+     * and the video decoder with the audio decoder and output. see partLoaded()
+     */
+    enum LoadPart {
+        MediaPart = 1, /// the main media demuxer
+        ExternalAudioPart = 1 << 1, /// external audio demuxer. see setExternalAudio()
+        AudioDecoderPart = 1 << 2, /// audio decoder and audio output
+        VideoDecoderPart = 1 << 3 /// video decoder
+    };
 
     /// Supported input protocols. A static string list
     static const QStringList& supportedProtocols();
@@ -136,6 +148,13 @@ public:
      */
     void setAsyncLoad(bool value = true);
     bool isAsyncLoad() const;
+    /*!
+     * \brief setAsyncVideoFilter
+     * Apply video filters and present frames in a separated thread, so decoding is not blocked by expensive filters.
+     * Frames are still processed in order. Disabled by default. Takes effect on next load.
+     */
+    void setAsyncVideoFilter(bool value = true);
+    bool isAsyncVideoFilter() const;
     /*!
      * \brief setAutoLoad
      * true: current media source changed immediatly and stop current playback if new media source is set.
@@ -374,7 +393,7 @@ public:
      */
     int brightness() const;
     int contrast() const;
-    int hue() const; //not implemented
+    int hue() const;
     int saturation() const;
     unsigned int chapters() const;
     /*!
@@ -524,6 +543,35 @@ public Q_SLOTS:
      */
     void setBufferValue(qint64 value);
     int bufferValue() const;
+    /*!
+     * \brief setAdaptiveBuffer
+     * Adjust the buffer value at runtime by measured input rate. The value grows if input is slower than real time or playback rebuffers.
+     * If \a shrink is true, e.g. for low latency live streams, the value also shrinks when input is steady.
+     * bufferValue() (or the default value) is the initial value. Decisions are in Statistics::buffering.
+     * Set before playback starts.
+     */
+    void setAdaptiveBuffer(bool value, bool shrink = false);
+    bool isAdaptiveBuffer() const;
+    /*!
+     * \brief setLowLatency
+     * Low latency profile for live streams: no demuxer buffering, minimal probing, low_delay and slice threading decoding,
+     * time based buffering of about \a targetMs/4, frames are presented as soon as decoded and dropped if behind \a targetMs.
+     * If audio is the master clock, playback speed is raised slightly to catch up. Estimated latency is in Statistics::latency.
+     * Set before playback starts. It modifies the demuxer and codec options, buffer mode and buffer value. Existing "fflags"
+     * and "flags" are kept and the low latency flags are added. Disabling it restores the values before it was enabled.
+     */
+    void setLowLatency(bool value, int targetMs = 150);
+    bool isLowLatency() const;
+    /*!
+     * \brief setStandby
+     * Standby mode for fast channel switching. If true when play() is called, the media is loaded, decoders are opened and
+     * demuxing runs at low priority, but nothing is decoded or rendered. Only packets since the last video key frame are kept.
+     * setStandby(false) activates the player: decoding starts immediately from the cached key frame.
+     * Keep a standby player for each candidate channel, and set renderers before activation.
+     * Enabling standby mode takes effect at the next play().
+     */
+    void setStandby(bool value);
+    bool isStandby() const;
 
     /*!
      * \brief setNotifyInterval
@@ -537,7 +585,7 @@ public Q_SLOTS:
     // for all renderers. val: [-100, 100]. other value changes nothing
     void setBrightness(int val);
     void setContrast(int val);
-    void setHue(int val);  //not implemented
+    void setHue(int val);
     void setSaturation(int val);
 
 Q_SIGNALS:
@@ -548,6 +596,12 @@ Q_SIGNALS:
     void muteChanged();
     void sourceChanged();
     void loaded(); // == mediaStatusChanged(QtAV::LoadedMedia)
+    /*!
+     * \brief partLoaded
+     * Emitted when a LoadPart \a part is opened (\a ok is true) or failed. It can be emitted in a loader thread.
+     * Playback starts once media, audio and video decoders are ready.
+     */
+    void partLoaded(int part, bool ok);
     void mediaStatusChanged(QtAV::MediaStatus status); //explictly use QtAV::MediaStatus
     void mediaEndActionChanged(QtAV::MediaEndAction action);
     /*!
@@ -631,6 +685,7 @@ private:
      */
     void unload(); //TODO: private. call in stop() if not load() by user? or always unload() in stop()?
     qint64 normalizedPosition(qint64 pos);
+    friend class ClockGroup; // checks the seek range
     class Private;
     QScopedPointer<Private> d;
 };
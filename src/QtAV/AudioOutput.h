@@ -186,6 +186,19 @@ public:
     int bufferCount() const;
     void setBufferCount(int value);
     int bufferSizeTotal() const { return bufferCount() * bufferSize();}
+    /*!
+     * \brief setTargetLatency
+     * Request the audio buffering latency in ms. 0 (default) uses bufferCount() and the backend defaults.
+     * Applied in open(): bufferCount() is adjusted to cover the target, and backends supporting it (Pulse, PortAudio) request the target from the device.
+     */
+    void setTargetLatency(int ms);
+    int targetLatency() const;
+    /*!
+     * \brief deviceLatency
+     * Seconds until the data of the last play() is audible, measured by the device. Negative if the backend can not measure it.
+     * Used by AudioThread to update the clock delay.
+     */
+    qreal deviceLatency() const;
     /*!
      * \brief setDeviceFeatures
      * Unsupported features will not be set.
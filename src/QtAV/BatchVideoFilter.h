@@ -0,0 +1,121 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_BATCHVIDEOFILTER_H
+#define QTAV_BATCHVIDEOFILTER_H
+
+#include <QtAV/Filter.h>
+#include <QtAV/VideoFrame.h>
+#include <QtCore/QVariant>
+
+namespace QtAV {
+
+class BatchVideoFilterPrivate;
+/*!
+ * \brief The BatchVideoFilter class
+ * Base class of analysis filters which process frames in groups, e.g. batched inference.
+ * Frames are not changed. process() only queues the input frame, and processBatch() is called in a worker thread
+ * with batchSize() frames, or less if batchInterval() is reached or finish() is called. finish() is called at the end of stream.
+ * Results are associated with frame timestamps by addResult().
+ * Queued frames hold decoded buffers, so keep queueSize() small for hardware decoders with limited surfaces.
+ * The worker is stopped by the player before it deletes or releases an installed filter, and in ~BatchVideoFilter().
+ * If you delete the filter yourself, call stop() first (or in the subclass destructor), otherwise processBatch() may run while the subclass is being destroyed.
+ */
+class Q_AV_EXPORT BatchVideoFilter : public VideoFilter
+{
+    Q_OBJECT
+    DPTR_DECLARE_PRIVATE(BatchVideoFilter)
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize)
+    Q_PROPERTY(int batchInterval READ batchInterval WRITE setBatchInterval)
+    Q_PROPERTY(int queueSize READ queueSize WRITE setQueueSize)
+    Q_PROPERTY(OverflowPolicy overflowPolicy READ overflowPolicy WRITE setOverflowPolicy)
+    Q_ENUMS(OverflowPolicy)
+public:
+    /*!
+     * \brief The OverflowPolicy enum
+     * What to do with a new frame if queueSize() frames are waiting for the worker.
+     */
+    enum OverflowPolicy {
+        DropOldest, ///< default. keep the latest frames
+        DropNewest,
+        Block ///< wait for the worker. use for offline processing only, it blocks playback
+    };
+    BatchVideoFilter(QObject *parent = 0);
+    ~BatchVideoFilter();
+    bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
+    /// max frames in a batch. default is 8
+    void setBatchSize(int value);
+    int batchSize() const;
+    /*!
+     * \brief setBatchInterval
+     * Max time in ms a batch waits for more frames since its first frame arrives. 0 (default): wait for batchSize() frames
+     */
+    void setBatchInterval(int value);
+    int batchInterval() const;
+    /// max frames waiting for the worker. default is 32
+    void setQueueSize(int value);
+    int queueSize() const;
+    void setOverflowPolicy(OverflowPolicy value);
+    OverflowPolicy overflowPolicy() const;
+    /// number of frames dropped by overflowPolicy()
+    qint64 droppedFrames() const;
+    /*!
+     * \brief flush
+     * Drop the queued frames and the incomplete batch, e.g. when seeking
+     */
+    void flush() Q_DECL_OVERRIDE;
+    /// calls finish()
+    void endOfStream() Q_DECL_OVERRIDE;
+public Q_SLOTS:
+    /*!
+     * \brief finish
+     * Process the queued frames even if a batch is not full, then finished() is emitted. Call it at the end of stream.
+     */
+    void finish();
+    /*!
+     * \brief stop
+     * Stop the worker and drop the queued frames. Blocks until processBatch() returns. The worker restarts on the next frame.
+     */
+    void stop();
+Q_SIGNALS:
+    /*!
+     * \brief resultReady
+     * Emitted in the worker thread by addResult()
+     */
+    void resultReady(qreal timestamp, const QVariant& result);
+    void finished();
+protected:
+    /*!
+     * \brief processBatch
+     * Called in the worker thread. \a frames are in decoding order.
+     * Not pure virtual, a batch taken while the subclass is being destroyed is dropped by the default implementation.
+     */
+    virtual void processBatch(const QList<VideoFrame>& frames);
+    /*!
+     * \brief addResult
+     * Called in processBatch() to report the result of the frame with \a timestamp
+     */
+    void addResult(qreal timestamp, const QVariant& result);
+    void process(Statistics* statistics, VideoFrame* frame = 0) Q_DECL_OVERRIDE;
+};
+
+} //namespace QtAV
+#endif // QTAV_BATCHVIDEOFILTER_H
@@ -0,0 +1,133 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_CLOCKGROUP_H
+#define QTAV_CLOCKGROUP_H
+
+#include <QtAV/AVClock.h>
+#include <QtCore/QList>
+#include <QtCore/QScopedPointer>
+
+namespace QtAV {
+
+class AVPlayer;
+/*!
+ * \brief The ClockGroup class
+ * Keep several players frame locked, e.g. multi-camera review, or a video wall playing a mosaic split into files.
+ * Clocks of the players in a group follow a shared master clock, clock(). Each player clock value is its initialValue()
+ * (the media start time) + the master clock value, so the streams are aligned from their start.
+ * Control playback with play(), pause(), stop() and seek() of the group instead of the players.
+ * Video frames are presented on a common schedule of display refresh ticks. A frame missing its tick is dropped,
+ * and the previous frame is repeated if a frame is not ready, so all players display the frames of the same tick.
+ * Audio of the players is synchronized to the master clock like an external clock.
+ */
+class Q_AV_EXPORT ClockGroup : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief The SkewStatistics struct
+     * Inter-player skew is the difference between the largest and smallest timestamp (relative to media start)
+     * of the frames displayed by the players. It is sampled every time a player presents a frame.
+     * For the players of the same frame rate it is 0 if they are locked.
+     */
+    struct SkewStatistics {
+        SkewStatistics() : samples(0), current(0), average(0), maximum(0), drops(0), repeats(0) {}
+        qint64 samples;
+        qreal current; // in seconds
+        qreal average;
+        qreal maximum;
+        qint64 drops; // frames dropped because their ticks are missed
+        qint64 repeats; // ticks a frame is displayed longer than its duration
+    };
+
+    explicit ClockGroup(QObject *parent = 0);
+    ~ClockGroup();
+    /// the master clock. an ExternalClock
+    AVClock* clock() const;
+    /*!
+     * \brief addPlayer
+     * The player clock type is set to ExternalClock and auto clock is disabled until the player is removed.
+     */
+    void addPlayer(AVPlayer *player);
+    /*!
+     * \brief removePlayer
+     * Can be called when playing. The player clock continues from the group time as an auto clock.
+     */
+    void removePlayer(AVPlayer *player);
+    QList<AVPlayer*> players() const;
+    /*!
+     * \brief setRefreshRate
+     * Frame presentation is quantised to ticks of 1/hz seconds of the master clock. 0: present at frame timestamp.
+     * Default is 60.
+     */
+    void setRefreshRate(qreal hz);
+    qreal refreshRate() const;
+    SkewStatistics skewStatistics() const;
+
+    // used by video threads. thread safe
+    /// master clock value
+    qreal value() const;
+    /*!
+     * \brief presentTime
+     * Return the tick in master clock time when a frame with timestamp \a t (relative to media start) should be presented.
+     */
+    qreal presentTime(qreal t) const;
+    /*!
+     * \brief checkLate
+     * Return true if the frame of \a clock presented on \a tick should be dropped.
+     * Frames are not dropped if several frames in a row are late, so that a slow player still updates.
+     */
+    bool checkLate(AVClock *clock, qreal tick);
+    /// record a frame with timestamp \a t (relative to media start) is presented by player of \a clock
+    void framePresented(AVClock *clock, qreal t);
+
+public Q_SLOTS:
+    /*!
+     * \brief play
+     * Start all players. The master clock starts when all players are started.
+     */
+    void play();
+    void pause(bool p = true);
+    void stop();
+    /*!
+     * \brief seek
+     * Seek all players to \a pos (ms, relative to media start). The master clock is paused until seekFinished()
+     * of all players, then resumed if the group is not paused.
+     */
+    void seek(qint64 pos);
+    void resetStatistics();
+
+Q_SIGNALS:
+    void started();
+    void seekFinished(qint64 position);
+
+private Q_SLOTS:
+    void onPlayerStarted();
+    void onPlayerSeekFinished();
+    void onPlayerDestroyed(QObject *obj);
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+} //namespace QtAV
+#endif // QTAV_CLOCKGROUP_H
@@ -0,0 +1,81 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_DECODERPOOL_H
+#define QTAV_DECODERPOOL_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVariant>
+#include <QtAV/QtAV_Global.h>
+
+namespace QtAV {
+
+class AVDecoder;
+class DecoderPoolPrivate;
+/*!
+ * \brief The DecoderPool class
+ * Keeps flushed, open decoders (with their codec context and worker threads) for reuse by the next source with the
+ * same decoder, codec parameters and options, e.g. channel switching and playlist advancing.
+ * AVPlayer and VideoFrameExtractor put decoders here instead of deleting them. All functions are thread safe.
+ */
+class Q_AV_EXPORT DecoderPool
+{
+    DPTR_DECLARE_PRIVATE(DecoderPool)
+    Q_DISABLE_COPY(DecoderPool)
+public:
+    static DecoderPool& instance();
+    /*!
+     * \brief key
+     * The key of a decoder named \a decoderName (e.g. "FFmpeg", "CUDA") opened for codec parameters of \a avctx
+     * (AVCodecContext*) with \a options. Empty if \a avctx is null
+     */
+    static QByteArray key(const QString& decoderName, void* avctx, const QVariantHash& options = QVariantHash());
+    /*!
+     * \brief setCapacity
+     * Max number of idle decoders. The least recently put one is deleted if full. 0: disable pooling. Default is 4
+     */
+    void setCapacity(int value);
+    int capacity() const;
+    int size() const;
+    /// delete all idle decoders
+    void clear();
+    /*!
+     * \brief take
+     * Take an open decoder put with \a key. The caller owns the decoder, and it's moved to the current thread. Return null if not found
+     */
+    AVDecoder* take(const QByteArray& key);
+    template<class T> T* take(const QByteArray& key) { return static_cast<T*>(take(key));}
+    /*!
+     * \brief put
+     * Flush \a decoder and keep it for reuse. The pool owns the decoder, it's deleted immediately if not open, \a key is empty or capacity is 0.
+     * Signal connections of \a decoder are removed. Call it in the thread \a decoder lives in, then it has no thread affinity until taken.
+     */
+    void put(AVDecoder* decoder, const QByteArray& key);
+    /// take() results since process start
+    int hits() const;
+    int misses() const;
+private:
+    DecoderPool();
+    ~DecoderPool();
+    DPTR_DECLARE(DecoderPool)
+};
+} //namespace QtAV
+#endif // QTAV_DECODERPOOL_H
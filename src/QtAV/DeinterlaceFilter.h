@@ -0,0 +1,106 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_DEINTERLACEFILTER_H
+#define QTAV_DEINTERLACEFILTER_H
+
+#include <QtAV/Filter.h>
+
+namespace QtAV {
+
+class DeinterlaceFilterPrivate;
+/*!
+ * \brief The DeinterlaceFilter class
+ * CPU deinterlacer for 8~16 bit planar, semi-planar and 8 bit packed formats.
+ * Field order is read from frame metadata "top_field_first" set by FFmpeg decoder if fieldOrder() is FieldOrderAuto.
+ * Frames are processed in slices by threads().
+ * If inverseTelecine() is enabled, 3:2 pulldown content is restored to progressive frames instead of deinterlaced.
+ */
+class Q_AV_EXPORT DeinterlaceFilter : public VideoFilter
+{
+    Q_OBJECT
+    DPTR_DECLARE_PRIVATE(DeinterlaceFilter)
+    Q_PROPERTY(Mode mode READ mode WRITE setMode NOTIFY modeChanged)
+    Q_PROPERTY(FieldOrder fieldOrder READ fieldOrder WRITE setFieldOrder NOTIFY fieldOrderChanged)
+    Q_PROPERTY(bool fieldRate READ isFieldRate WRITE setFieldRate NOTIFY fieldRateChanged)
+    Q_PROPERTY(bool interlacedOnly READ isInterlacedOnly WRITE setInterlacedOnly NOTIFY interlacedOnlyChanged)
+    Q_PROPERTY(bool inverseTelecine READ isInverseTelecine WRITE setInverseTelecine NOTIFY inverseTelecineChanged)
+    Q_PROPERTY(int threads READ threads WRITE setThreads)
+    Q_ENUMS(Mode)
+    Q_ENUMS(FieldOrder)
+public:
+    enum Mode {
+        Bob, ///< interpolate the missing lines of a field vertically
+        LinearBlend, ///< vertical [1 2 1] low pass on the whole frame. always output 1 frame per input frame
+        EdgeAdaptive ///< interpolate the missing luma lines along edges(ELA). default
+    };
+    enum FieldOrder {
+        FieldOrderAuto,
+        TopFieldFirst,
+        BottomFieldFirst
+    };
+    DeinterlaceFilter(QObject *parent = 0);
+    bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
+    Mode mode() const;
+    void setMode(Mode value);
+    FieldOrder fieldOrder() const;
+    void setFieldOrder(FieldOrder value);
+    /*!
+     * \brief setFieldRate
+     * Output 1 frame for each field, i.e. 50fps for 1080i50. Ignored by LinearBlend. Default is false
+     */
+    void setFieldRate(bool value);
+    bool isFieldRate() const;
+    /*!
+     * \brief setInterlacedOnly
+     * If true(default), frames marked as progressive by decoder are not changed.
+     * Frames without the information are always deinterlaced.
+     */
+    void setInterlacedOnly(bool value);
+    bool isInterlacedOnly() const;
+    /*!
+     * \brief setInverseTelecine
+     * Field matching and decimation for telecined film, e.g. 24fps in 60i. Default is false.
+     * The first field of a frame is combined with the other field of the current or previous frame, whichever has less combing.
+     * When a 3:2 pulldown cadence is detected, the duplicated frame of every 5 frames is dropped and the others are retimed to 4/5 of the input rate.
+     * Frames still combed after matching are deinterlaced by mode(). fieldRate() and interlacedOnly() are ignored.
+     */
+    void setInverseTelecine(bool value);
+    bool isInverseTelecine() const;
+    /*!
+     * \brief setThreads
+     * Number of threads used to process a frame. 0(default): QThread::idealThreadCount(), 1: no threading
+     */
+    void setThreads(int value);
+    int threads() const;
+    void flush() Q_DECL_OVERRIDE;
+Q_SIGNALS:
+    void modeChanged();
+    void fieldOrderChanged();
+    void fieldRateChanged();
+    void interlacedOnlyChanged();
+    void inverseTelecineChanged();
+protected:
+    void process(Statistics* statistics, VideoFrame* frame = 0) Q_DECL_OVERRIDE;
+};
+
+} //namespace QtAV
+#endif // QTAV_DEINTERLACEFILTER_H
@@ -22,6 +22,7 @@
 #ifndef QTAV_FILTER_H
 #define QTAV_FILTER_H
 
+#include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtAV/QtAV_Global.h>
 #include <QtAV/FilterContext.h>
@@ -33,6 +34,7 @@ class AVPlayer;
 class FilterPrivate;
 class Statistics;
 class Frame;
+class VideoFrame;
 class Q_AV_EXPORT Filter : public QObject
 {
     Q_OBJECT
@@ -92,12 +94,47 @@ public:
      * \return false if already installed
      */
     bool installTo(AVOutput *output); //only for video. move to video filter installToRenderer
-    void apply(Statistics* statistics, VideoFrame *frame = 0);
+    /*!
+     * \brief apply
+     * Process \a frame in place. Only the 1st output frame is kept if the filter outputs more than 1 frame.
+     * \return false if the filter discards the frame. \a frame is reset to an invalid frame in this case
+     */
+    bool apply(Statistics* statistics, VideoFrame *frame = 0);
+    /*!
+     * \brief apply
+     * Process \a frame and append the output frames to \a outFrames.
+     * A filter can output 0, 1 or more frames for 1 input frame, e.g. field rate deinterlacing(yadif=1, bwdif),
+     * frame rate conversion(fps, minterpolate) and frame selection(select, framestep). Each output frame has it's own timestamp.
+     * \return number of frames appended to \a outFrames
+     */
+    int apply(Statistics* statistics, const VideoFrame& frame, QList<VideoFrame>& outFrames);
+    /*!
+     * \brief flush
+     * Drop the frames buffered in filter, e.g. when seeking. Called in the same thread as process()
+     */
+    virtual void flush() {}
+    /*!
+     * \brief endOfStream
+     * Called in the same thread as process() when all frames of the stream are decoded and processed.
+     * Filters which process frames asynchronously can finish the pending work here
+     */
+    virtual void endOfStream() {}
 
     bool prepareContext(VideoFilterContext*& ctx, Statistics* statistics = 0, VideoFrame* frame = 0); //internal use
 protected:
     VideoFilter(VideoFilterPrivate& d, QObject *parent = 0);
     virtual void process(Statistics* statistics, VideoFrame* frame = 0) = 0;
+    /*!
+     * \brief addOutputFrame
+     * Used in process() by filters whose output frame count can be different from input.
+     * If addOutputFrame() or discardFrame() is called in process(), the input frame is replaced by the added frames.
+     */
+    void addOutputFrame(const VideoFrame& frame);
+    /*!
+     * \brief discardFrame
+     * Used in process(). The input frame is consumed and nothing will be output unless addOutputFrame() is called.
+     */
+    void discardFrame();
 };
 
 class AudioFrame;
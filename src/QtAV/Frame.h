@@ -62,16 +62,17 @@ public:
     int bytesPerLine(int plane = 0) const;
     // the whole frame data. may be empty unless clone() or allocate is called
     // real data starts with dataAlignment() aligned address
+    // data in pooled memory (e.g. converted frames) is copied, so the result is always valid
     QByteArray frameData() const;
     int dataAlignment() const;
-    uchar* frameDataPtr(int* size = NULL) const {
-        const int a = dataAlignment();
-        uchar* p = (uchar*)frameData().constData();
-        const int offset = (a - ((quintptr)p & (a-1))) & (a-1);
-        if (size)
-            *size = frameData().size() - offset;
-        return p+offset;
-    }
+    /*!
+     * \brief isWritable
+     * True if plane data is in frameData() and not shared with other frames, e.g. copies of this frame or frames from
+     * the same data. Then the planes can be modified without changing other frames. Decoded frames are not writable.
+     */
+    bool isWritable() const;
+    // the aligned frameData() without copy. valid as long as this frame is alive
+    uchar* frameDataPtr(int* size = NULL) const;
     // deep copy 1 plane data
     QByteArray data(int plane = 0) const;
     uchar* bits(int plane = 0);
@@ -57,7 +57,7 @@ public:
     VideoFrame getVideoFrame();
     bool hasVideoFrame() const;
     bool hasEnoughVideoFrames() const;
-    // return false if eof
+    // return false if eof or the media can not be loaded. an invalid frame is queued in both cases
     bool readMore();
     // TODO: tryLoad on seek even at eof
     // TODO: compress seek requests
@@ -56,6 +56,27 @@ public:
     QString options() const;
 
     Status status() const;
+    /*!
+     * \brief The ThreadType enum
+     * SliceThreading: filters supporting slice threading process a frame with multiple threads.
+     */
+    enum ThreadType {
+        NoThreading,
+        SliceThreading
+    };
+    /*!
+     * \brief setThreads
+     * Max number of threads used by the filter graph (AVFilterGraph.nb_threads). 0 (default): auto detect, i.e. use all cores.
+     * Takes effect when the next frame arrives (graph is reconfigured)
+     */
+    void setThreads(int value);
+    int threads() const;
+    /*!
+     * \brief setThreadType
+     * Default is SliceThreading. Takes effect when the next frame arrives (graph is reconfigured)
+     */
+    void setThreadType(ThreadType value);
+    ThreadType threadType() const;
 protected:
     virtual QString sourceArguments() const = 0;
     bool pushVideoFrame(Frame* frame, bool changed);
@@ -72,13 +93,19 @@ class Q_AV_EXPORT LibAVFilterVideo : public VideoFilter, public LibAVFilter
     Q_OBJECT
     Q_PROPERTY(QString options READ options WRITE setOptions NOTIFY optionsChanged)
     Q_PROPERTY(QStringList filters READ filters)
+    Q_PROPERTY(int threads READ threads WRITE setThreads)
 public:
     LibAVFilterVideo(QObject *parent = 0);
     bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
     QStringList filters() const; //the same as LibAVFilter::videoFilters
+    void flush() Q_DECL_OVERRIDE;
 Q_SIGNALS:
     void optionsChanged() Q_DECL_OVERRIDE;
 protected:
+    /*!
+     * Frames are pulled from the graph until no more frame. 0, 1 or more frames can be output for 1 input frame.
+     * Use VideoFilter::apply(Statistics*, const VideoFrame&, QList<VideoFrame>&) to get all of them
+     */
     void process(Statistics *statistics, VideoFrame *frame) Q_DECL_OVERRIDE;
     QString sourceArguments() const Q_DECL_OVERRIDE;
 };
@@ -88,6 +115,7 @@ class Q_AV_EXPORT LibAVFilterAudio : public AudioFilter, public LibAVFilter
     Q_OBJECT
     Q_PROPERTY(QString options READ options WRITE setOptions NOTIFY optionsChanged)
     Q_PROPERTY(QStringList filters READ filters)
+    Q_PROPERTY(int threads READ threads WRITE setThreads)
 public:
     LibAVFilterAudio(QObject *parent = 0);
     QStringList filters() const; //the same as LibAVFilter::audioFilters
@@ -37,6 +37,13 @@ namespace QtAV {
  *   properties:
  *     device - read only. example: io->device()
  *   protocols: "", "qrc"
+ * "LiveEmu"
+ *   replays a file or QIODevice as a live stream with deterministic bit rate, bursts, latency spikes and stalls. for buffering tests
+ *   properties:
+ *     device, bitRate, burstSize, latency, stallInterval, stallDuration, spikeInterval, spikeDuration - read/write
+ *     stalledTime, bytesRead - read only
+ *   signals: dataArrived(qint64 position, qint64 arrivalTime, qint64 readTime)
+ *   protocols: "liveemu"
  */
 typedef int MediaIOId;
 class MediaIOPrivate;
@@ -52,7 +59,7 @@ public:
         Write
     };
 
-    /// Registered MediaIO::name(): "QIODevice", "QFile"
+    /// Registered MediaIO::name(): "QIODevice", "QFile", "LiveEmu"
     static QStringList builtInNames();
     /*!
      * \brief createForProtocol
@@ -130,6 +137,13 @@ public:
      * Demuxer seeking should work for this case.
      */
     virtual bool isVariableSize() const { return false;}
+    /*!
+     * \brief abort
+     * Make a blocking read() in another thread return as soon as possible, e.g. when stopping or seeking.
+     * read() returns 0 until abort(false) is called. AVDemuxer calls abort(false) before seeking and loading.
+     * Default implementation does nothing.
+     */
+    virtual void abort(bool value = true) { Q_UNUSED(value);}
     /*!
      * \brief setBufferSize
      * \param value <0: use default value
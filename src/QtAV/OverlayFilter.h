@@ -0,0 +1,71 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_OVERLAYFILTER_H
+#define QTAV_OVERLAYFILTER_H
+
+#include <QtAV/Filter.h>
+#include <QtCore/QPoint>
+#include <QtGui/QImage>
+
+namespace QtAV {
+
+class VideoFormat;
+class OverlayFilterPrivate;
+/*!
+ * \brief The OverlayFilter class
+ * Alpha blend an image(OSD, watermark, burn-in etc.) into YUV frames directly, without QPainter and format conversion.
+ * Supports 8~16 bit planar and semi-planar YUV formats, e.g. yuv420p, nv12, p010. Other formats are not changed.
+ * The image is converted to the frame's color space only when the image, position or frame parameters change,
+ * and only the non-transparent area of the image is blended.
+ */
+class Q_AV_EXPORT OverlayFilter : public VideoFilter
+{
+    Q_OBJECT
+    DPTR_DECLARE_PRIVATE(OverlayFilter)
+    Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged)
+    Q_PROPERTY(QPoint position READ position WRITE setPosition NOTIFY positionChanged)
+public:
+    OverlayFilter(QObject *parent = 0);
+    bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
+    static bool isFormatSupported(const VideoFormat& format);
+    /*!
+     * \brief setImage
+     * The image is converted to QImage::Format_ARGB32_Premultiplied. Null image disables the overlay.
+     * Thread safe.
+     */
+    void setImage(const QImage& value);
+    QImage image() const;
+    /*!
+     * \brief setPosition
+     * Top left position of the image in frame, in pixels. The image is clipped by frame. Thread safe.
+     */
+    void setPosition(const QPoint& value);
+    QPoint position() const;
+Q_SIGNALS:
+    void imageChanged();
+    void positionChanged();
+protected:
+    void process(Statistics* statistics, VideoFrame* frame = 0) Q_DECL_OVERRIDE;
+};
+
+} //namespace QtAV
+#endif // QTAV_OVERLAYFILTER_H
@@ -27,12 +27,15 @@
 
 #include <QtAV/AVError.h>
 #include <QtAV/AVClock.h>
+#include <QtAV/ClockGroup.h>
 #include <QtAV/AVDecoder.h>
+#include <QtAV/DecoderPool.h>
 #include <QtAV/AVDemuxer.h>
 #include <QtAV/AVMuxer.h>
 #include <QtAV/AVOutput.h>
 #include <QtAV/AVPlayer.h>
 #include <QtAV/Packet.h>
+#include <QtAV/QualityGovernor.h>
 #include <QtAV/Statistics.h>
 
 #include <QtAV/AudioEncoder.h>
@@ -43,8 +46,13 @@
 
 #include <QtAV/Filter.h>
 #include <QtAV/FilterContext.h>
+#include <QtAV/DeinterlaceFilter.h>
 #include <QtAV/GLSLFilter.h>
 #include <QtAV/LibAVFilter.h>
+#include <QtAV/SceneChangeFilter.h>
+#include <QtAV/BatchVideoFilter.h>
+#include <QtAV/OverlayFilter.h>
+#include <QtAV/VideoEQFilter.h>
 
 #if (QT_VERSION == QT_VERSION_CHECK(5,0,0) && !defined(QT_NO_OPENGL)) || (QT_VERSION >= QT_VERSION_CHECK(6,0,0) && defined(QT_OPENGL_LIB))
 #include <QtAV/Geometry.h>
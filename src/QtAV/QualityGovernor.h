@@ -0,0 +1,106 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_QUALITYGOVERNOR_H
+#define QTAV_QUALITYGOVERNOR_H
+
+#include <QtAV/QtAV_Global.h>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+namespace QtAV {
+
+class QualityGovernorPrivate;
+/*!
+ * \brief The QualityGovernor class
+ * Process wide degradation of video quality when many players overload the machine. Video threads report how late
+ * decoded frames are. Every interval() the governor compares the process cpu usage with cpuBudget() and checks the
+ * lateness of all players. If overloaded, the least important player is degraded by 1 level. If there is headroom for
+ * a while, the most important degraded player is restored by 1 level. Focused players are never degraded.
+ * The per-thread slow frame heuristics of video threads are replaced by the governor levels if enabled.
+ * Takes effect for all playbacks immediately, and disabling restores full quality. All functions are thread safe.
+ */
+class Q_AV_EXPORT QualityGovernor
+{
+    DPTR_DECLARE_PRIVATE(QualityGovernor)
+    Q_DISABLE_COPY(QualityGovernor)
+public:
+    /// degradation levels. a level includes the levers of lower levels
+    enum Level {
+        FullQuality,
+        SkipNonRef, // decoder skips non-reference frames
+        LowResolution, // software decoder outputs 1/2 size frames if supported by codec (lowres)
+        LowFrameRate, // present every other frame. frames are still decoded and filtered
+        KeyFrameOnly // decoder skips all frames except key frames (AVDISCARD_NONKEY). all key frames are presented
+    };
+    enum Priority {
+        Background, // can be degraded to KeyFrameOnly
+        Normal, // can be degraded to LowFrameRate. default
+        Focused // always FullQuality
+    };
+    static QualityGovernor& instance();
+    void setEnabled(bool value);
+    bool isEnabled() const;
+    /*!
+     * \brief setCpuBudget
+     * Max process cpu usage in [0, 1] of all cores. Default is 0.85
+     */
+    void setCpuBudget(qreal value);
+    qreal cpuBudget() const;
+    /// ms. default is 500
+    void setInterval(int value);
+    int interval() const;
+    /// \a player is an AVPlayer, or the owner object of a client. removed when \a player is destroyed
+    void setPriority(QObject* player, Priority value);
+    Priority priority(QObject* player) const;
+    /// current level of \a player. FullQuality if not playing
+    Level level(QObject* player) const;
+    /// process cpu usage of all cores in the last interval. -1 if unknown
+    qreal cpuUsage() const;
+    /*!
+     * \brief setCpuUsage
+     * Use \a value as cpu usage instead of measuring the process. For load generators to test policies. <0: measure (default)
+     */
+    void setCpuUsage(qreal value);
+
+    /*!
+     * \brief addClient
+     * A video thread (or a synthetic load generator) of \a player registers itself. Return client id
+     */
+    int addClient(QObject* player);
+    void removeClient(int id);
+    Level clientLevel(int id) const;
+    /*!
+     * \brief reportLateness
+     * \a seconds: how late a frame is decoded compared with the clock. 0 if in time.
+     * evaluate() is called if interval() elapsed since the last evaluation.
+     */
+    void reportLateness(int id, qreal seconds);
+    /// run the policy once
+    void evaluate();
+private:
+    QualityGovernor();
+    ~QualityGovernor();
+    DPTR_DECLARE(QualityGovernor)
+};
+} //namespace QtAV
+#endif // QTAV_QUALITYGOVERNOR_H
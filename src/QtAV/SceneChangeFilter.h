@@ -0,0 +1,83 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_SCENECHANGEFILTER_H
+#define QTAV_SCENECHANGEFILTER_H
+
+#include <QtAV/Filter.h>
+
+namespace QtAV {
+
+class SceneChangeFilterPrivate;
+/*!
+ * \brief The SceneChangeFilter class
+ * Detect scene cuts by comparing downsampled luma planes of adjacent frames. Frames are not changed.
+ * Luma is averaged in 8x8 blocks, then sum of absolute differences and histogram distance of the thumbnails are combined as score().
+ * Works on 8~16 bit YUV and gray formats without conversion. Other formats are ignored.
+ * Offline use without a player:
+ * \code
+ *  FrameReader r;
+ *  SceneChangeFilter f;
+ *  connect(&f, SIGNAL(sceneChanged(qreal,qreal)), ...);
+ *  ...
+ *  VideoFrame frame(r.getVideoFrame());
+ *  f.apply(0, &frame);
+ * \endcode
+ */
+class Q_AV_EXPORT SceneChangeFilter : public VideoFilter
+{
+    Q_OBJECT
+    DPTR_DECLARE_PRIVATE(SceneChangeFilter)
+    Q_PROPERTY(qreal threshold READ threshold WRITE setThreshold NOTIFY thresholdChanged)
+    Q_PROPERTY(qreal minInterval READ minInterval WRITE setMinInterval NOTIFY minIntervalChanged)
+public:
+    SceneChangeFilter(QObject *parent = 0);
+    bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
+    /*!
+     * \brief setThreshold
+     * A cut is detected if score() is greater than threshold and the recent average score. Range is (0, 1), default is 0.3.
+     */
+    void setThreshold(qreal value);
+    qreal threshold() const;
+    /*!
+     * \brief setMinInterval
+     * Minimal time in seconds between 2 cuts. Default is 0.5
+     */
+    void setMinInterval(qreal value);
+    qreal minInterval() const;
+    /// score of the last processed frame. [0, 1]
+    qreal score() const;
+    void flush() Q_DECL_OVERRIDE;
+Q_SIGNALS:
+    void thresholdChanged();
+    void minIntervalChanged();
+    /*!
+     * \brief sceneChanged
+     * Emitted in the thread calling process() when a cut is detected at \a timestamp(seconds).
+     * \param confidence (0, 1]
+     */
+    void sceneChanged(qreal timestamp, qreal confidence);
+protected:
+    void process(Statistics* statistics, VideoFrame* frame = 0) Q_DECL_OVERRIDE;
+};
+
+} //namespace QtAV
+#endif // QTAV_SCENECHANGEFILTER_H
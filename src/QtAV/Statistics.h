@@ -109,10 +109,42 @@ public:
         int rotate;
         /// return current absolute time (seconds since epcho
         qint64 frameDisplayed(qreal pts); // used to compute currentDisplayFPS()
+        /*!
+         * \brief filterTime
+         * Average time(ms) used by each video filter for one input frame. Key is filter objectName() or class name.
+         */
+        QHash<QString, qreal> filterTime() const;
+        void filterProcessed(const QString& name, qreal ms); // used to compute filterTime()
     private:
         class Private;
         QExplicitlySharedDataPointer<Private> d;
     } video_only;
+    /*!
+     * \brief The Buffering class
+     * Decisions of adaptive buffering. see AVPlayer::setAdaptiveBuffer()
+     */
+    class Q_AV_EXPORT Buffering {
+    public:
+        Buffering();
+        qint64 value; ///< current buffer value in AVPlayer::bufferMode() unit
+        qreal input_rate; ///< media time received per second. 1.0: real time
+        int grows, shrinks; ///< number of decisions
+    } buffering;
+    /*!
+     * \brief The Latency class
+     * Latency estimation of the displayed video frames. see AVPlayer::setLowLatency()
+     */
+    class Q_AV_EXPORT Latency {
+    public:
+        Latency();
+        qreal added; ///< ms added by QtAV: queued packets, decoder delay, decoding, filtering and waiting. averaged
+        /*!
+         * ms from capture to display of the last frame. <0 if unknown.
+         * Requires the capture time from source, e.g. RTCP sender reports of RTSP (AVFormatContext.start_time_realtime)
+         */
+        qreal glass_to_glass;
+        int drops; ///< frames dropped to catch up
+    } latency;
 };
 
 } //namespace QtAV
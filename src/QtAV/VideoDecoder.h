@@ -48,7 +48,7 @@ typedef int VideoDecoderId;
     CedarV
       neon: bool
     FFmpeg
-      skip_loop_filter, skip_idct, skip_frame: -16 "None", 0: "Default", 8 "NoRef", 16 "Bidir", 32 "NoKey", 64 "All"
+      skip_loop_filter, skip_idct, skip_frame: -16 "None", 0: "Default", 8 "NoRef", 16 "Bidir", 24 "NoIntra", 32 "NoKey", 48 "All"
       threads: int, 0 is auto
       vismv(motion vector visualization): flag, 0 "NO", 1 "PF", 2 "BF", 4 "BB"
  */
@@ -71,6 +71,35 @@ public:
     virtual VideoDecoderId id() const = 0;
     QString name() const; //name from factory
     virtual VideoFrame frame() = 0;
+    /*!
+     * \brief The DiscardLevel enum
+     * Same values as AVDiscard. Frames of a type greater than or equal to the level are discarded.
+     */
+    enum DiscardLevel {
+        DiscardNone = -16,
+        DiscardDefault = 0,
+        DiscardNonRef = 8,
+        DiscardBidir = 16,
+        DiscardNonIntra = 24,
+        DiscardNonKey = 32,
+        DiscardAll = 48
+    };
+    /*!
+     * \brief setDiscardLevel
+     * Set AVCodecContext.skip_frame, skip_loop_filter and skip_idct directly. It's much cheaper
+     * than setOptions() and can be called for every packet. options() are not changed, and the
+     * values in options() take effect again if the decoder is reopened or setOptions() is called.
+     * DiscardDefault restores the value in options(), and other levels never discard less than options().
+     * Only decoders using libavcodec are affected.
+     */
+    void setDiscardLevel(DiscardLevel frames, DiscardLevel loopFilter = DiscardDefault, DiscardLevel idct = DiscardDefault);
+    /*!
+     * \brief slowDiscardLevel
+     * Graded discard levels for a decoder which is \a nbSlow frames late. Nothing is discarded below \a nbFrameDrop.
+     * Then non-ref frames, the loop filter(deblocking) and more frame types are discarded step by step,
+     * and only key frames are decoded when \a nbSlow approaches \a nbSkip.
+     */
+    static void slowDiscardLevel(int nbSlow, int nbFrameDrop, int nbSkip, DiscardLevel *frames, DiscardLevel *loopFilter);
 public:
     typedef int Id;
     static QVector<VideoDecoderId> registered();
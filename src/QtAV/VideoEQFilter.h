@@ -0,0 +1,78 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_VIDEOEQFILTER_H
+#define QTAV_VIDEOEQFILTER_H
+
+#include <QtAV/Filter.h>
+
+namespace QtAV {
+
+class VideoFormat;
+class VideoEQFilterPrivate;
+/*!
+ * \brief The VideoEQFilter class
+ * Adjust brightness, contrast, saturation and hue directly on YUV planes, so no format conversion is required on CPU renderers.
+ * Luma is mapped by a lookup table, chroma is rotated(hue) and scaled(contrast and saturation) around the center value.
+ * Supports 8~16 bit planar and semi-planar(NV12, P010 etc.) YUV formats. Other formats are passed through unchanged.
+ * Frame data is modified in place if the frame is writable(Frame::isWritable()), otherwise a copy is modified, e.g. decoded frames may be referenced by decoder.
+ * Value ranges are the same as VideoRenderer: [-1, 1], 0 means no change.
+ */
+class Q_AV_EXPORT VideoEQFilter : public VideoFilter
+{
+    Q_OBJECT
+    DPTR_DECLARE_PRIVATE(VideoEQFilter)
+    Q_PROPERTY(qreal brightness READ brightness WRITE setBrightness NOTIFY brightnessChanged)
+    Q_PROPERTY(qreal contrast READ contrast WRITE setContrast NOTIFY contrastChanged)
+    Q_PROPERTY(qreal saturation READ saturation WRITE setSaturation NOTIFY saturationChanged)
+    Q_PROPERTY(qreal hue READ hue WRITE setHue NOTIFY hueChanged)
+public:
+    VideoEQFilter(QObject *parent = 0);
+    bool isSupported(VideoFilterContext::Type t) const Q_DECL_OVERRIDE { return t == VideoFilterContext::None;}
+    /*!
+     * \brief isFormatSupported
+     * \return true if frames of \a format can be processed without conversion
+     */
+    static bool isFormatSupported(const VideoFormat& format);
+    qreal brightness() const;
+    void setBrightness(qreal value);
+    qreal contrast() const;
+    void setContrast(qreal value);
+    qreal saturation() const;
+    void setSaturation(qreal value);
+    qreal hue() const;
+    void setHue(qreal value);
+    /*!
+     * \brief isIdentity
+     * \return true if all values are 0, i.e. frames are not changed
+     */
+    bool isIdentity() const;
+Q_SIGNALS:
+    void brightnessChanged(qreal);
+    void contrastChanged(qreal);
+    void saturationChanged(qreal);
+    void hueChanged(qreal);
+protected:
+    void process(Statistics* statistics, VideoFrame* frame = 0) Q_DECL_OVERRIDE;
+};
+
+} //namespace QtAV
+#endif // QTAV_VIDEOEQFILTER_H
@@ -33,6 +33,7 @@ class VideoFramePrivate;
 class Q_AV_EXPORT VideoFrame : public Frame
 {
     Q_DECLARE_PRIVATE(VideoFrame)
+    friend class VideoFrameConverter;
 public:
     /*!
      * \brief fromGPU
@@ -48,6 +49,21 @@ public:
      */
     static VideoFrame fromGPU(const VideoFormat& fmt, int width, int height, int surface_h, quint8 *src[], int pitch[], bool optimized = true, bool swapUV = false);
     static void copyPlane(quint8 *dst, size_t dst_stride, const quint8 *src, size_t src_stride, unsigned byteWidth, unsigned height);
+    /*!
+     * \brief bufferPoolStats
+     * Host memory of clone(), fromGPU() and to() results is taken from a pool of 64 bytes aligned blocks
+     * and recycled when the last frame referencing it is released.
+     * hit rate is hits/(hits+misses).
+     * \param cachedBytes size of the free blocks held by the pool
+     */
+    static void bufferPoolStats(qint64* hits, qint64* misses, qint64* cachedBytes = 0);
+    /*!
+     * \brief allocate
+     * Make a frame on host memory from the buffer pool. The data is NOT initialized, every plane must be written by the caller.
+     * \param bytesPerLine line sizes of each plane, e.g. the same as the source frame of a filter. If null, rows are packed without padding
+     * \return an invalid frame if format is not valid, is hardware accelerated or out of memory
+     */
+    static VideoFrame allocate(const VideoFormat& fmt, int width, int height, const int *bytesPerLine = 0);
 
     VideoFrame();
     //must set planes and linesize manually if data is empty
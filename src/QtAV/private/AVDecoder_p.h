@@ -64,6 +64,43 @@ public:
         }
 #endif //QTAV_HAVE(AVBUFREF)
     }
+    /*!
+     * \brief ref
+     * Add refs of the buffers to \a frame, so frame data can be used by libavfilter, encoders etc. without copy.
+     * \param planes the plane addresses to be referenced. MUST be inside the buffers
+     * \return false if the buffers are not ref counted or planes are not in the buffers. frame is not changed
+     */
+    bool ref(AVFrame* frame, const uchar* const planes[], int nb_planes) const {
+        Q_UNUSED(frame);
+        Q_UNUSED(planes);
+        Q_UNUSED(nb_planes);
+#if QTAV_HAVE(AVBUFREF)
+        if (buf.isEmpty() || buf.size() > (int)FF_ARRAY_ELEMS(frame->buf)) // no extended_buf for video
+            return false;
+        for (int p = 0; p < nb_planes; ++p) {
+            bool found = false;
+            foreach (AVBufferRef* b, buf) {
+                if (b && planes[p] >= b->data && planes[p] < b->data + b->size) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) // e.g. frame is converted, but metadata is copied
+                return false;
+        }
+        for (int i = 0; i < buf.size(); ++i) {
+            if (!buf[i])
+                continue;
+            frame->buf[i] = av_buffer_ref(buf[i]);
+            if (!frame->buf[i]) {
+                av_frame_unref(frame);
+                return false;
+            }
+        }
+        return true;
+#endif //QTAV_HAVE(AVBUFREF)
+        return false;
+    }
     ~AVFrameBuffers() {
 #if QTAV_HAVE(AVBUFREF)
         foreach (AVBufferRef* b, buf) {
@@ -95,6 +132,9 @@ public:
       , is_open(false)
       , undecoded_size(0)
       , dict(0)
+      , skip_frame(AVDISCARD_DEFAULT)
+      , skip_loop_filter(AVDISCARD_DEFAULT)
+      , skip_idct(AVDISCARD_DEFAULT)
     {
         codec_ctx = avcodec_alloc_context3(NULL);
     }
@@ -111,6 +151,8 @@ public:
     virtual bool enableFrameRef() const { return true;}
     void applyOptionsForDict();
     void applyOptionsForContext();
+    void saveDiscardOptions();
+    void restoreDiscardOptions();
 
     AVCodecContext *codec_ctx; //set once and not change
     bool available; //TODO: true only when context(and hw ctx) is ready
@@ -119,6 +161,10 @@ public:
     QString codec_name;
     QVariantHash options;
     AVDictionary *dict;
+    // skip_frame, skip_loop_filter and skip_idct set by options. VideoDecoder::setDiscardLevel() changes the context only
+    int skip_frame;
+    int skip_loop_filter;
+    int skip_idct;
 };
 
 class AudioResampler;
@@ -22,12 +22,14 @@
 #ifndef QAV_AUDIOOUTPUTBACKEND_H
 #define QAV_AUDIOOUTPUTBACKEND_H
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QObject>
 #include <QtAV/AudioFormat.h>
 #include <QtAV/AudioOutput.h>
 
 namespace QtAV {
 
+class ByteRing;
 typedef int AudioOutputBackendId;
 class Q_AV_PRIVATE_EXPORT AudioOutputBackend : public QObject
 {
@@ -37,6 +39,7 @@ public:
     bool available; // default is true. set to false when failed to create backend
     int buffer_size;
     int buffer_count;
+    int target_latency; // ms. 0: backend default
     AudioFormat format;
     static QStringList defaultPriority();
     /*!
@@ -44,7 +47,7 @@ public:
      * Specify supported features by the backend. Use this for new backends.
      */
     AudioOutputBackend(AudioOutput::DeviceFeatures f, QObject *parent);
-    virtual ~AudioOutputBackend() {}
+    virtual ~AudioOutputBackend();
     virtual QString name() const = 0;
     virtual bool open() = 0;
     virtual bool close() = 0;
@@ -71,6 +74,11 @@ public:
         OffsetIndex = 1 << 5, //current playing offset
         OffsetBytes = 1 << 6, //current playing offset by bytes
         WritableBytes = 1 << 7,
+        /*!
+         * The device requests data in its real-time callback and the backend calls pull() there.
+         * write() only queues data in a lock-free ring of buffer_size*buffer_count bytes by writeRing().
+         */
+        Pull = 1 << 8,
     };
     virtual BufferControl bufferControl() const = 0;
     // called by callback with Callback control
@@ -87,6 +95,33 @@ public:
     virtual int getOffset() {return -1;}        // OffsetIndex
     virtual int getOffsetByBytes()  {return -1;}// OffsetBytes
     virtual int getWritableBytes() {return -1;} //WritableBytes
+    /*!
+     * \brief pull
+     * Pull mode. Call it in the device callback to copy \a bytes pcm data to \a dst. Silence is filled if not enough data is queued (underrun).
+     * It never locks or allocates memory, and does not wake up the audio thread.
+     * \return bytes of queued data copied
+     */
+    int pull(void* dst, int bytes);
+    /*!
+     * \brief getLatency
+     * Seconds until the data of the last write() is audible, measured from the device clock. Negative if unknown (default).
+     * Pull mode: seconds from the last pull() until the pulled data is audible. Data queued in the ring is added by AudioOutput.
+     */
+    virtual qreal getLatency() { return -1.0;}
+    /// Pull mode. Ring capacity in bytes, at least buffer_size*buffer_count
+    int ringSize() const;
+    /// Pull mode. Bytes can be queued without blocking
+    int ringWritable() const;
+    /// Pull mode. Bytes queued and not pulled yet
+    int ringReadable() const;
+    /// Pull mode. Total bytes of queued data pulled by the device. It wraps around, use the difference of 2 values.
+    int pulledBytes() const;
+    /*!
+     * \brief underruns
+     * Pull mode. Number of times the device ran out of queued data and then got data again since resetRing().
+     * Running dry after the last data (e.g. end of stream) is not counted.
+     */
+    int underruns() const;
     // not virtual. called in ctor
     AudioOutput::DeviceFeatures supportedFeatures() { return m_features;}
     /*!
@@ -100,6 +135,15 @@ public:
     virtual bool setMute(bool value = true) { Q_UNUSED(value); return false;}
     virtual bool getMute() const { return false;}
 
+protected:
+    /*!
+     * \brief resetRing
+     * Pull mode. Allocate the ring for the current format, buffer_size and buffer_count. Call it in open() before the device callback starts.
+     */
+    void resetRing();
+    /// Pull mode. Implement write() with it.
+    bool writeRing(const QByteArray& data);
+
 Q_SIGNALS:
     /*
      * \brief reportVolume
@@ -128,6 +172,11 @@ private:
     static bool Register(AudioOutputBackendId id, AudioOutputBackendCreator, const char *name);
 private:
     AudioOutput::DeviceFeatures m_features;
+    ByteRing *m_ring;
+    char m_silence;
+    bool m_starving; // only used in pull()
+    mutable QAtomicInt m_pulled;
+    mutable QAtomicInt m_underruns;
     Q_DISABLE_COPY(AudioOutputBackend)
 };
 } //namespace QtAV
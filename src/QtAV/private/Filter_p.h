@@ -23,6 +23,7 @@
 #define QTAV_FILTER_P_H
 
 #include <QtAV/QtAV_Global.h>
+#include <QtAV/VideoFrame.h>
 
 namespace QtAV {
 
@@ -47,8 +48,11 @@ class Q_AV_PRIVATE_EXPORT VideoFilterPrivate : public FilterPrivate
 public:
     VideoFilterPrivate() :
         context(0)
+      , replace_input(false)
     {}
     VideoFilterContext *context; //used only when is necessary
+    bool replace_input; // addOutputFrame() or discardFrame() is called in process()
+    QList<VideoFrame> out_frames;
 };
 
 class Q_AV_PRIVATE_EXPORT AudioFilterPrivate : public FilterPrivate
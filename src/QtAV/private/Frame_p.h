@@ -26,10 +26,12 @@
 #include <QtCore/QVector>
 #include <QtCore/QVariant>
 #include <QtCore/QSharedData>
+#include <QtCore/QSharedPointer>
 
 namespace QtAV {
 
 class Frame;
+class FrameBuffer;
 class FramePrivate : public QSharedData
 {
     Q_DISABLE_COPY(FramePrivate)
@@ -44,6 +46,7 @@ public:
     QVector<int> line_sizes; //stride
     QVariantMap metadata;
     QByteArray data;
+    QSharedPointer<FrameBuffer> buffer; // pooled memory referenced by data. returned to the pool with the last ref
     qreal timestamp;
     int data_align;
 };
@@ -0,0 +1,418 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/QualityGovernor.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+#include "utils/Logger.h"
+
+namespace QtAV {
+namespace {
+static const qreal kLateThreshold = 0.08; // s, averaged lateness of a player
+static const qreal kBudgetMargin = 0.15; // restore quality only if cpu usage < budget - margin
+static const int kStableIntervals = 4; // intervals with headroom before restoring 1 level
+
+// cpu time of all threads in ms. -1 if unknown
+qint64 processCpuTime()
+{
+#if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
+    FILETIME c, e, k, u;
+    if (!GetProcessTimes(GetCurrentProcess(), &c, &e, &k, &u))
+        return -1;
+    ULARGE_INTEGER ki, ui;
+    ki.LowPart = k.dwLowDateTime;
+    ki.HighPart = k.dwHighDateTime;
+    ui.LowPart = u.dwLowDateTime;
+    ui.HighPart = u.dwHighDateTime;
+    return qint64((ki.QuadPart + ui.QuadPart)/10000ULL); // 100ns
+#elif defined(Q_OS_UNIX)
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return -1;
+    return qint64(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)*1000LL + qint64(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec)/1000LL;
+#else
+    return -1;
+#endif
+}
+
+int maxLevel(QualityGovernor::Priority p)
+{
+    switch (p) {
+    case QualityGovernor::Focused:
+        return QualityGovernor::FullQuality;
+    case QualityGovernor::Background:
+        return QualityGovernor::KeyFrameOnly;
+    default:
+        return QualityGovernor::LowFrameRate;
+    }
+}
+} //namespace
+
+class QualityGovernorPrivate;
+// removes the priority of a destroyed player. QualityGovernor is not a QObject
+class PlayerWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    PlayerWatcher(QualityGovernorPrivate *d) : QObject(0), m_d(d) {}
+public Q_SLOTS:
+    void onPlayerDestroyed(QObject *player);
+private:
+    QualityGovernorPrivate *m_d;
+};
+
+class QualityGovernorPrivate : public DPtrPrivate<QualityGovernor>
+{
+public:
+    struct Client {
+        int id;
+        QObject *player;
+        int level;
+        qreal lateness; // average
+        int nb_reports; // since last level change
+    };
+    QualityGovernorPrivate()
+        : enabled(false)
+        , budget(0.85)
+        , interval(500)
+        , cpu(-1)
+        , cpu_override(-1)
+        , last_cpu_time(-1)
+        , next_id(0)
+        , nb_stable(0)
+        , watcher(this)
+    {}
+    QualityGovernor::Priority priority(QObject *player) const {
+        return (QualityGovernor::Priority)priorities.value(player, QualityGovernor::Normal);
+    }
+    Client* client(int id) {
+        for (int i = 0; i < clients.size(); ++i) {
+            if (clients.at(i).id == id)
+                return &clients[i];
+        }
+        return 0;
+    }
+    void levelChanged() {
+        nb_stable = 0;
+        // measure lateness with new levels
+        for (int i = 0; i < clients.size(); ++i) {
+            clients[i].lateness = 0;
+            clients[i].nb_reports = 0;
+        }
+    }
+    void evaluate();
+
+    mutable QMutex mutex;
+    bool enabled;
+    qreal budget;
+    int interval;
+    qreal cpu;
+    qreal cpu_override;
+    qint64 last_cpu_time;
+    QElapsedTimer timer;
+    int next_id;
+    int nb_stable;
+    QList<Client> clients;
+    QHash<QObject*, int> priorities;
+    PlayerWatcher watcher;
+};
+
+void PlayerWatcher::onPlayerDestroyed(QObject *player)
+{
+    QMutexLocker lock(&m_d->mutex);
+    Q_UNUSED(lock);
+    m_d->priorities.remove(player);
+}
+
+void QualityGovernorPrivate::evaluate()
+{
+    const qint64 wall = timer.isValid() ? timer.restart() : 0;
+    if (!timer.isValid())
+        timer.start();
+    const qint64 cpu_time = processCpuTime();
+    if (cpu_override >= 0)
+        cpu = cpu_override;
+    else if (wall > 0 && cpu_time >= 0 && last_cpu_time >= 0)
+        cpu = qreal(cpu_time - last_cpu_time)/qreal(wall*qMax(1, QThread::idealThreadCount()));
+    last_cpu_time = cpu_time;
+    if (clients.isEmpty())
+        return;
+    bool late = false;
+    bool in_time = true;
+    foreach (const Client& c, clients) {
+        if (c.nb_reports == 0)
+            continue;
+        if (c.lateness > kLateThreshold)
+            late = true;
+        if (c.lateness > kLateThreshold/4.0)
+            in_time = false;
+    }
+    if (late || (cpu >= 0 && cpu > budget)) {
+        // degrade the least important player. players of the same priority are degraded evenly
+        Client *c = 0;
+        for (int i = 0; i < clients.size(); ++i) {
+            Client &ci = clients[i];
+            const QualityGovernor::Priority p = priority(ci.player);
+            if (ci.level >= maxLevel(p))
+                continue;
+            if (c) {
+                const QualityGovernor::Priority pc = priority(c->player);
+                if (p > pc)
+                    continue;
+                if (p == pc && (ci.level > c->level || (ci.level == c->level && ci.lateness <= c->lateness)))
+                    continue;
+            }
+            c = &ci;
+        }
+        if (!c) {
+            nb_stable = 0;
+            return;
+        }
+        c->level++;
+        qDebug("QualityGovernor: cpu: %.2f, late: %d. degrade client %d to level %d", cpu, late, c->id, c->level);
+        levelChanged();
+        return;
+    }
+    if (!in_time || (cpu >= 0 && cpu > budget - kBudgetMargin)) {
+        nb_stable = 0;
+        return;
+    }
+    if (++nb_stable < kStableIntervals)
+        return;
+    // restore the most important player
+    Client *c = 0;
+    for (int i = 0; i < clients.size(); ++i) {
+        Client &ci = clients[i];
+        if (ci.level <= 0)
+            continue;
+        if (c) {
+            const QualityGovernor::Priority p = priority(ci.player), pc = priority(c->player);
+            if (p < pc || (p == pc && ci.level <= c->level))
+                continue;
+        }
+        c = &ci;
+    }
+    if (!c) {
+        nb_stable = 0;
+        return;
+    }
+    c->level--;
+    qDebug("QualityGovernor: cpu: %.2f. restore client %d to level %d", cpu, c->id, c->level);
+    levelChanged();
+}
+
+QualityGovernor& QualityGovernor::instance()
+{
+    static QualityGovernor sGovernor;
+    return sGovernor;
+}
+
+QualityGovernor::QualityGovernor()
+{
+}
+
+QualityGovernor::~QualityGovernor()
+{
+}
+
+void QualityGovernor::setEnabled(bool value)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.enabled == value)
+        return;
+    d.enabled = value;
+    // clients are registered even if disabled. start from full quality next time
+    for (int i = 0; i < d.clients.size(); ++i) {
+        d.clients[i].level = FullQuality;
+        d.clients[i].nb_reports = 0;
+    }
+    d.timer.invalidate();
+}
+
+bool QualityGovernor::isEnabled() const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.enabled;
+}
+
+void QualityGovernor::setCpuBudget(qreal value)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.budget = qBound<qreal>(0.1, value, 1.0);
+}
+
+qreal QualityGovernor::cpuBudget() const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.budget;
+}
+
+void QualityGovernor::setInterval(int value)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.interval = qMax(10, value);
+}
+
+int QualityGovernor::interval() const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.interval;
+}
+
+void QualityGovernor::setPriority(QObject *player, Priority value)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (!d.priorities.contains(player)) // direct: the player can be destroyed in any thread
+        QObject::connect(player, SIGNAL(destroyed(QObject*)), &d.watcher, SLOT(onPlayerDestroyed(QObject*)), Qt::DirectConnection);
+    d.priorities[player] = value;
+    // a focused player is restored immediately
+    for (int i = 0; i < d.clients.size(); ++i) {
+        if (d.clients.at(i).player == player)
+            d.clients[i].level = qMin(d.clients.at(i).level, maxLevel(value));
+    }
+}
+
+QualityGovernor::Priority QualityGovernor::priority(QObject *player) const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.priority(player);
+}
+
+QualityGovernor::Level QualityGovernor::level(QObject *player) const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    foreach (const QualityGovernorPrivate::Client& c, d.clients) {
+        if (c.player == player)
+            return (Level)c.level;
+    }
+    return FullQuality;
+}
+
+qreal QualityGovernor::cpuUsage() const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.cpu;
+}
+
+void QualityGovernor::setCpuUsage(qreal value)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.cpu_override = value;
+}
+
+int QualityGovernor::addClient(QObject *player)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    QualityGovernorPrivate::Client c;
+    c.id = ++d.next_id;
+    c.player = player;
+    c.level = FullQuality;
+    c.lateness = 0;
+    c.nb_reports = 0;
+    d.clients.append(c);
+    return c.id;
+}
+
+void QualityGovernor::removeClient(int id)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    for (int i = 0; i < d.clients.size(); ++i) {
+        if (d.clients.at(i).id == id) {
+            d.clients.removeAt(i);
+            return;
+        }
+    }
+}
+
+QualityGovernor::Level QualityGovernor::clientLevel(int id) const
+{
+    DPTR_D(const QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    foreach (const QualityGovernorPrivate::Client& c, d.clients) {
+        if (c.id == id)
+            return (Level)c.level;
+    }
+    return FullQuality;
+}
+
+void QualityGovernor::reportLateness(int id, qreal seconds)
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    QualityGovernorPrivate::Client *c = d.client(id);
+    if (!c)
+        return;
+    seconds = qMax<qreal>(0, seconds);
+    c->lateness = c->nb_reports > 0 ? c->lateness*0.9 + seconds*0.1 : seconds;
+    c->nb_reports++;
+    if (!d.enabled)
+        return;
+    if (!d.timer.isValid() || d.timer.elapsed() >= d.interval)
+        d.evaluate();
+}
+
+void QualityGovernor::evaluate()
+{
+    DPTR_D(QualityGovernor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.evaluate();
+}
+} //namespace QtAV
+#include "QualityGovernor.moc"
@@ -21,6 +21,7 @@
 
 #include "QtAV/Statistics.h"
 #include "utils/ring.h"
+#include <QtCore/QMutex>
 
 namespace QtAV {
 
@@ -40,6 +41,21 @@ Statistics::AudioOnly::AudioOnly():
 {
 }
 
+Statistics::Buffering::Buffering():
+    value(0)
+  , input_rate(0)
+  , grows(0)
+  , shrinks(0)
+{
+}
+
+Statistics::Latency::Latency():
+    added(0)
+  , glass_to_glass(-1)
+  , drops(0)
+{
+}
+
 class Statistics::VideoOnly::Private : public QSharedData {
 public:
     Private()
@@ -48,6 +64,9 @@ public:
     {}
     qreal pts;
     ring<qreal> history;
+    // updated in video (filter) thread, read in gui thread
+    QMutex filter_mutex;
+    QHash<QString, qreal> filter_time;
 };
 
 Statistics::VideoOnly::VideoOnly():
@@ -101,6 +120,26 @@ qint64 Statistics::VideoOnly::frameDisplayed(qreal pts)
     d->history.push_back(t);
     return msecs;
 }
+QHash<QString, qreal> Statistics::VideoOnly::filterTime() const
+{
+    QMutexLocker lock(&d->filter_mutex);
+    Q_UNUSED(lock);
+    return d->filter_time;
+}
+
+void Statistics::VideoOnly::filterProcessed(const QString &name, qreal ms)
+{
+    QMutexLocker lock(&d->filter_mutex);
+    Q_UNUSED(lock);
+    QHash<QString, qreal>::iterator it = d->filter_time.find(name);
+    if (it == d->filter_time.end()) {
+        d->filter_time.insert(name, ms);
+        return;
+    }
+    // exponential moving average, about the last 16 frames
+    it.value() += (ms - it.value())/16.0;
+}
+
 // d->history is not thread safe!
 qreal Statistics::VideoOnly::currentDisplayFPS() const
 {
@@ -129,6 +168,8 @@ void Statistics::reset()
     video = Common();
     audio_only = AudioOnly();
     video_only = VideoOnly();
+    buffering = Buffering();
+    latency = Latency();
     metadata.clear();
 }
 
@@ -459,23 +459,85 @@ QImage::Format VideoFormat::imageFormatFromPixelFormat(PixelFormat format)
 }
 
 
+/*!
+ * Immutable VideoFormatPrivate instances shared by all VideoFormat objects, so constructing a VideoFormat is a pointer copy.
+ * Built on first use. Entries hold an extra ref and are never freed because VideoFormat objects may outlive the table.
+ * Formats unknown to FFmpeg are not interned and are created as before.
+ */
+class VideoFormatTable
+{
+public:
+    VideoFormatTable() {
+        int nb = 0;
+        const AVPixFmtDescriptor *desc = NULL;
+        while ((desc = av_pix_fmt_desc_next(desc))) {
+            nb = qMax(nb, (int)av_pix_fmt_desc_get_id(desc) + 1);
+        }
+        ff.resize(nb);
+        for (int i = 0; i < nb; ++i) {
+            ff[i] = av_pix_fmt_desc_get((AVPixelFormat)i) ? intern(new VideoFormatPrivate((AVPixelFormat)i)) : 0;
+        }
+        pix.resize(VideoFormat::Format_User + 1); // index 0 is Format_Invalid
+        pix[0] = intern(new VideoFormatPrivate(VideoFormat::Format_Invalid));
+        for (int i = 1; i < pix.size(); ++i) {
+            const VideoFormat::PixelFormat fmt = VideoFormat::PixelFormat(i - 1);
+            pix[i] = VideoFormat::pixelFormatToFFmpeg(fmt) != QTAV_PIX_FMT_C(NONE) ? intern(new VideoFormatPrivate(fmt)) : 0;
+        }
+        qimg.resize(2*QImage::NImageFormats); // QImage format can be negative, see imageFormatFromPixelFormat()
+        for (int i = 0; i < qimg.size(); ++i) {
+            const QImage::Format fmt = QImage::Format(i - QImage::NImageFormats);
+            qimg[i] = VideoFormat::pixelFormatFromImageFormat(fmt) != VideoFormat::Format_Invalid ? intern(new VideoFormatPrivate(fmt)) : 0;
+        }
+    }
+    VideoFormatPrivate* get(VideoFormat::PixelFormat fmt) const {
+        const int i = int(fmt) + 1;
+        return i >= 0 && i < pix.size() ? pix[i] : 0;
+    }
+    VideoFormatPrivate* get(AVPixelFormat fmt) const {
+        if (fmt == QTAV_PIX_FMT_C(NONE))
+            return pix[0];
+        return fmt >= 0 && fmt < ff.size() ? ff[fmt] : 0;
+    }
+    VideoFormatPrivate* get(QImage::Format fmt) const {
+        const int i = int(fmt) + QImage::NImageFormats;
+        return i >= 0 && i < qimg.size() ? qimg[i] : 0;
+    }
+private:
+    static VideoFormatPrivate* intern(VideoFormatPrivate* p) {
+        p->ref.ref();
+        return p;
+    }
+    QVector<VideoFormatPrivate*> ff; // index: AVPixelFormat
+    QVector<VideoFormatPrivate*> pix; // index: PixelFormat + 1
+    QVector<VideoFormatPrivate*> qimg; // index: QImage::Format + NImageFormats
+};
+Q_GLOBAL_STATIC(VideoFormatTable, videoFormatTable)
+
+template<typename T>
+static VideoFormatPrivate* sharedPrivate(T fmt)
+{
+    const VideoFormatTable *t = videoFormatTable(); // null after destruction
+    VideoFormatPrivate *p = t ? t->get(fmt) : 0;
+    return p ? p : new VideoFormatPrivate(fmt);
+}
+
 VideoFormat::VideoFormat(PixelFormat format)
-    :d(new VideoFormatPrivate(format))
+    :d(sharedPrivate(format))
 {
 }
 
 VideoFormat::VideoFormat(int formatFF)
-    :d(new VideoFormatPrivate((AVPixelFormat)formatFF))
+    :d(sharedPrivate((AVPixelFormat)formatFF))
 {
 }
 
 VideoFormat::VideoFormat(QImage::Format fmt)
-    :d(new VideoFormatPrivate(fmt))
+    :d(sharedPrivate(fmt))
 {
 }
 
 VideoFormat::VideoFormat(const QString &name)
-    :d(new VideoFormatPrivate(av_get_pix_fmt(name.toUtf8().constData())))
+    :d(sharedPrivate(av_get_pix_fmt(name.toUtf8().constData())))
 {
 }
 
@@ -501,19 +563,19 @@ VideoFormat& VideoFormat::operator=(const VideoFormat &other)
 
 VideoFormat& VideoFormat::operator =(VideoFormat::PixelFormat fmt)
 {
-    d = new VideoFormatPrivate(fmt);
+    d = sharedPrivate(fmt);
     return *this;
 }
 
 VideoFormat& VideoFormat::operator =(QImage::Format qpixfmt)
 {
-    d = new VideoFormatPrivate(qpixfmt);
+    d = sharedPrivate(qpixfmt);
     return *this;
 }
 
 VideoFormat& VideoFormat::operator =(int fffmt)
 {
-    d = new VideoFormatPrivate((AVPixelFormat)fffmt);
+    d = sharedPrivate((AVPixelFormat)fffmt);
     return *this;
 }
 
@@ -584,14 +646,12 @@ QString VideoFormat::name() const
 
 void VideoFormat::setPixelFormat(PixelFormat format)
 {
-    d->pixfmt = format;
-    d->init(format);
+    d = sharedPrivate(format);
 }
 
 void VideoFormat::setPixelFormatFFmpeg(int format)
 {
-    d->pixfmt_ff = (AVPixelFormat)format;
-    d->init((AVPixelFormat)format);
+    d = sharedPrivate((AVPixelFormat)format);
 }
 
 int VideoFormat::channels() const
@@ -26,6 +26,8 @@
 #include <QtCore/QSharedPointer>
 #include <QtGui/QImage>
 #include "QtAV/private/AVCompat.h"
+#include "utils/FrameBufferPool.h"
+#include "utils/FrameCopy.h"
 #include "utils/GPUMemCopy.h"
 #include "utils/Logger.h"
 
@@ -41,6 +43,11 @@ static const struct RegisterMetaTypes
 } _registerMetaTypes;
 }
 
+void VideoFrame::bufferPoolStats(qint64 *hits, qint64 *misses, qint64 *cachedBytes)
+{
+    FrameBufferPool::stats(hits, misses, cachedBytes);
+}
+
 VideoFrame VideoFrame::fromGPU(const VideoFormat& fmt, int width, int height, int surface_h, quint8 *src[], int pitch[], bool optimized, bool swapUV)
 {
     Q_ASSERT(src[0] && pitch[0] > 0 && "VideoFrame::fromGPU: src[0] and pitch[0] must be set");
@@ -66,21 +73,25 @@ VideoFrame VideoFrame::fromGPU(const VideoFormat& fmt, int width, int height, in
         for (int i = 0; i < nb_planes; ++i) {
             yuv_size += pitch[i]*h[i];
         }
-        // additional 15 bytes to ensure 16 bytes aligned
-        QByteArray buf(15 + yuv_size, 0);
-        const int offset_16 = (16 - ((uintptr_t)buf.constData() & 0x0f)) & 0x0f;
+        const FrameBufferRef buf(FrameBufferPool::get(yuv_size));
+        if (!buf)
+            return frame;
         // plane 1, 2... is aligned?
-        uchar* plane_ptr = (uchar*)buf.constData() + offset_16;
+        uchar* plane_ptr = buf->data();
         QVector<uchar*> dst(nb_planes, 0);
+        PlaneCopy copies[4];
         for (int i = 0; i < nb_planes; ++i) {
             dst[i] = plane_ptr;
             // TODO: add VideoFormat::planeWidth/Height() ?
             // pitch instead of surface_width
             plane_ptr += pitch[i] * h[i];
-            gpu_memcpy(dst[i], src[i], pitch[i]*h[i]);
-
+            copies[i].dst = dst[i];
+            copies[i].src = src[i];
+            copies[i].size = pitch[i]*h[i];
         }
-        frame = VideoFrame(width, height, fmt, buf);
+        frame_memcpy(copies, nb_planes, true);
+        frame = VideoFrame(width, height, fmt, buf->toByteArray(), FrameBufferPool::Alignment);
+        frame.d_ptr->buffer = buf;
         frame.setBits(dst);
         frame.setBytesPerLine(pitch);
     } else {
@@ -203,6 +214,33 @@ int VideoFrame::channelCount() const
     return d->format.channels();
 }
 
+VideoFrame VideoFrame::allocate(const VideoFormat &fmt, int width, int height, const int *bytesPerLine)
+{
+    if (!fmt.isValid() || fmt.isHWAccelerated() || width <= 0 || height <= 0)
+        return VideoFrame();
+    const int nb_planes = fmt.planeCount();
+    int pitch[4] = {0};
+    int h[4] = {0};
+    int bytes = 0;
+    for (int i = 0; i < nb_planes; ++i) {
+        pitch[i] = bytesPerLine ? bytesPerLine[i] : fmt.bytesPerLine(width, i);
+        h[i] = i == 0 ? height : fmt.chromaHeight(height);
+        bytes += pitch[i]*h[i];
+    }
+    const FrameBufferRef buf(FrameBufferPool::get(bytes));
+    if (!buf)
+        return VideoFrame();
+    uchar *dst = buf->data();
+    VideoFrame f(width, height, fmt, buf->toByteArray(), FrameBufferPool::Alignment);
+    f.d_ptr->buffer = buf;
+    for (int i = 0; i < nb_planes; ++i) {
+        f.setBits(dst, i);
+        f.setBytesPerLine(pitch[i], i);
+        dst += pitch[i]*h[i];
+    }
+    return f;
+}
+
 VideoFrame VideoFrame::clone() const
 {
     Q_D(const VideoFrame);
@@ -224,17 +262,24 @@ VideoFrame VideoFrame::clone() const
         bytes += bytesPerLine(i)*planeHeight(i);
     }
 
-    QByteArray buf(bytes, 0);
-    char *dst = buf.data(); //must before buf is shared, otherwise data will be detached.
-    VideoFrame f(width(), height(), d->format, buf);
+    const FrameBufferRef buf(FrameBufferPool::get(bytes));
+    if (!buf)
+        return VideoFrame();
+    uchar *dst = buf->data();
+    VideoFrame f(width(), height(), d->format, buf->toByteArray(), FrameBufferPool::Alignment);
+    f.d_ptr->buffer = buf;
     const int nb_planes = d->format.planeCount();
+    PlaneCopy copies[4];
     for (int i = 0; i < nb_planes; ++i) {
-        f.setBits((quint8*)dst, i);
+        f.setBits(dst, i);
         f.setBytesPerLine(bytesPerLine(i), i);
         const int plane_size = bytesPerLine(i)*planeHeight(i);
-        memcpy(dst, constBits(i), plane_size);
+        copies[i].dst = dst;
+        copies[i].src = constBits(i);
+        copies[i].size = plane_size;
         dst += plane_size;
     }
+    frame_memcpy(copies, nb_planes);
     f.d_ptr->metadata = d->metadata; // need metadata?
     f.setTimestamp(d->timestamp);
     f.setDisplayAspectRatio(d->displayAspectRatio);
@@ -397,6 +442,7 @@ VideoFrame VideoFrame::to(const VideoFormat &fmt, const QSize& dstSize, const QR
         return VideoFrame();
     }
     VideoFrame f(w, h, fmt, conv.outData(), ImageConverter::DataAlignment);
+    f.d_ptr->buffer = conv.outBuffer(); // keep the pooled output alive after conv is destroyed
     f.setBits(conv.outPlanes());
     f.setBytesPerLine(conv.outLineSizes());
     if (fmt.isRGB()) {
@@ -533,6 +579,7 @@ VideoFrame VideoFrameConverter::convert(const VideoFrame &frame, int fffmt) cons
     }
     const VideoFormat fmt(fffmt);
     VideoFrame f(frame.width(), frame.height(), fmt, m_cvt->outData());
+    f.d_ptr->buffer = m_cvt->outBuffer();
     f.setBits(m_cvt->outPlanes());
     f.setBytesPerLine(m_cvt->outLineSizes());
     f.setTimestamp(frame.timestamp());
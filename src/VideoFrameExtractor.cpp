@@ -28,6 +28,7 @@
 #include <QtCore/QThread>
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
+#include "QtAV/DecoderPool.h"
 #include "QtAV/VideoCapture.h"
 #include "QtAV/VideoDecoder.h"
 #include "QtAV/AVDemuxer.h"
@@ -130,10 +131,6 @@ public:
         , decoder(0)
     {
         QVariantHash opt;
-        opt[QString::fromLatin1("skip_frame")] = 8; // 8 for "avcodec", "NoRef" for "FFmpeg". see AVDiscard
-        opt[QString::fromLatin1("skip_loop_filter")] = 8; //skip all?
-        //skip_dict is slower
-        dec_opt_framedrop[QString::fromLatin1("avcodec")] = opt;
         opt[QString::fromLatin1("skip_frame")] = 0; // 0 for "avcodec", "Default" for "FFmpeg". see AVDiscard
         opt[QString::fromLatin1("skip_loop_filter")] = 0;
         dec_opt_normal[QString::fromLatin1("avcodec")] = opt; // avcodec need correct string or value in libavcodec
@@ -165,7 +162,7 @@ public:
         if (loaded && decoder)// && !demuxer.atEnd()) //we may seek back later when eof got. TODO: remove demuxer.atEnd()
             return true;
         seek_count = 0;
-        decoder.reset(0);
+        releaseDecoder();
         if (!loaded || demuxer.atEnd()) {
             demuxer.unload();
             demuxer.setMedia(source);
@@ -187,22 +184,28 @@ public:
                 precision = kDefaultPrecision;
         }
         demuxer.setStreamIndex(AVDemuxer::VideoStream, 0);
+        const QVariantHash opt(decoderOptions());
         foreach (const QString& c, codecs) {
-            VideoDecoder *vd = VideoDecoder::create(c.toUtf8().constData());
+            AVCodecContext *cctx = demuxer.videoCodecContext();
+            // reuse a decoder of the previous source if codec parameters are not changed
+            const QByteArray key(DecoderPool::key(c, cctx, opt));
+            VideoDecoder *vd = DecoderPool::instance().take<VideoDecoder>(key);
+            if (vd) {
+                decoder.reset(vd);
+                decoder_key = key;
+                break;
+            }
+            vd = VideoDecoder::create(c.toUtf8().constData());
             if (!vd)
                 continue;
             decoder.reset(vd);
-            AVCodecContext *cctx = demuxer.videoCodecContext();
             if (cctx) decoder->setCodecContext(demuxer.videoCodecContext());
             if (!cctx || !decoder->open()) {
                 decoder.reset(0);
                 continue;
             }
-            QVariantHash opt, va;
-            // FIXME: why QStringLiteral can't be used as key for vs<2015 but somewhere else it can?  error C2958: the left bracket '[' found at qstringliteral
-            va[QString::fromLatin1("display")] = QString::fromLatin1("X11"); // to support swscale
-            opt[QString::fromLatin1("vaapi")] = va;
             decoder->setOptions(opt);
+            decoder_key = key;
             break;
         }
         return !!decoder;
@@ -264,7 +267,7 @@ public:
             return false;
         }
         decoder->flush(); //must flush otherwise old frames will be decoded at the beginning
-        decoder->setOptions(dec_opt_normal);
+        decoder->setDiscardLevel(VideoDecoder::DiscardDefault);
         // must decode key frame
         int k = 0;
         while (k < 2 && !frame.isValid()) {
@@ -290,7 +293,7 @@ public:
                 return true;
             }
         }
-        QVariantHash* dec_opt = &dec_opt_normal; // 0: default, 1: framedrop
+        bool framedrop = false;
         // decode at the given position
         while (!demuxer.atEnd()) {
             if (abort_seek) {
@@ -316,13 +319,15 @@ public:
                 //return false; //??
             }
             qint64 diff = qint64(t*1000.0) - value;
-            QVariantHash *dec_opt_old = dec_opt;
-            if (seek_count == 0 || diff >= 0)
-                dec_opt = &dec_opt_normal;
-            else
-                dec_opt = &dec_opt_framedrop;
-            if (dec_opt != dec_opt_old)
-                decoder->setOptions(*dec_opt);
+            // skip decoding non-ref frames before the desired position
+            const bool drop = seek_count > 0 && diff < 0;
+            if (drop != framedrop) {
+                framedrop = drop;
+                if (framedrop)
+                    decoder->setDiscardLevel(VideoDecoder::DiscardNonRef, VideoDecoder::DiscardNonRef);
+                else
+                    decoder->setDiscardLevel(VideoDecoder::DiscardDefault);
+            }
             // invalid packet?
             if (!decoder->decode(pkt)) {
                 qWarning("!!!!!!!!!decode failed!!!!");
@@ -364,9 +369,23 @@ public:
         if (releaseFrame) frame = VideoFrame();
         seek_count = 0;
         // close codec context first.
-        decoder.reset(0);
+        releaseDecoder();
         demuxer.unload();
     }
+    QVariantHash decoderOptions() const {
+        QVariantHash opt(dec_opt_normal), va;
+        // FIXME: why QStringLiteral can't be used as key for vs<2015 but somewhere else it can?  error C2958: the left bracket '[' found at qstringliteral
+        va[QString::fromLatin1("display")] = QString::fromLatin1("X11"); // to support swscale
+        opt[QString::fromLatin1("vaapi")] = va;
+        return opt;
+    }
+    // keep the decoder in DecoderPool for the next source
+    void releaseDecoder() {
+        if (decoder)
+            decoder->setOptions(decoderOptions()); // restore skip_frame etc. changed by extractInPrecision()
+        DecoderPool::instance().put(decoder.take(), decoder_key);
+        decoder_key.clear();
+    }
 
     void safeReleaseResource() {
         class Cleaner : public QRunnable {
@@ -392,13 +411,13 @@ public:
     QString source; ///< is written-to by this->thread() but may be read by extractor thread; important: apparently two threads accessing QString is supported by Qt according to wang-bin, so we aren't guarding this with a lock
     AVDemuxer demuxer;
     QScopedPointer<VideoDecoder> decoder;
+    QByteArray decoder_key; // DecoderPool key
     VideoFrame frame; ///< important: we only allow the extract thread to modify this value
     QStringList codecs;
     ExtractThread thread;
-    static QVariantHash dec_opt_framedrop, dec_opt_normal;
+    static QVariantHash dec_opt_normal;
 };
 
-QVariantHash VideoFrameExtractorPrivate::dec_opt_framedrop;
 QVariantHash VideoFrameExtractorPrivate::dec_opt_normal;
 
 VideoFrameExtractor::VideoFrameExtractor(QObject *parent) :
@@ -22,6 +22,7 @@
 #include "VideoThread.h"
 #include "AVThread_p.h"
 #include "QtAV/Packet.h"
+#include "QtAV/QualityGovernor.h"
 #include "QtAV/AVClock.h"
 #include "QtAV/VideoCapture.h"
 #include "QtAV/VideoDecoder.h"
@@ -29,13 +30,30 @@
 #include "QtAV/Statistics.h"
 #include "QtAV/Filter.h"
 #include "QtAV/FilterContext.h"
+#include "QtAV/VideoEQFilter.h"
 #include "output/OutputSet.h"
 #include "QtAV/private/AVCompat.h"
 #include <QtCore/QFileInfo>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QThread>
 #include "utils/Logger.h"
 
 namespace QtAV {
 
+// reopen a software FFmpeg decoder with AVCodecContext.lowres. return false if not supported by the codec
+static bool setDecoderLowres(VideoDecoder *dec, int lowres)
+{
+    if (!dec || dec->id() != VideoDecoderId_FFmpeg || !dec->property("hwaccel").toString().isEmpty())
+        return false;
+    AVCodecContext *ctx = (AVCodecContext*)dec->codecContext();
+    if (!ctx || !ctx->codec || ctx->codec->max_lowres < lowres)
+        return false;
+    qDebug("reopen decoder with lowres %d", lowres);
+    dec->close();
+    av_opt_set_int(ctx, "lowres", lowres, 0);
+    return dec->open();
+}
+
 class VideoThreadPrivate : public AVThreadPrivate
 {
 public:
@@ -45,7 +63,33 @@ public:
       , force_dt(0)
       , capture(0)
       , filter_context(0)
+      , async_filter(false)
+      , low_latency(false)
+      , target_latency(150)
+      , realtime_start(0)
+      , realtime_pts0(0)
+      , last_pkt_pts(0)
+      , present_v_a(0)
+      , present_v_a_valid(false)
+      , gov_half_rate(false)
+      , nb_gov_frames(0)
     {
+        eq[0] = eq[1] = eq[2] = eq[3] = 0;
+    }
+    // called when a packet is taken from queue
+    void packetTaken(const Packet& pkt);
+    // update displayed frame and latency after a frame is presented
+    void framePresented(const VideoFrame& frame);
+    // A-V difference of the frames presented by filter stage. used by video thread to correct v_a
+    void setPresentedV_A(qreal v_a);
+    bool takePresentedV_A(qreal *v_a);
+    // governed lower presentation rate: every other frame is not presented. called by the thread presenting frames
+    bool skipPresent() {
+        if (!gov_half_rate) {
+            nb_gov_frames = 0;
+            return false;
+        }
+        return nb_gov_frames++ & 1;
     }
     ~VideoThreadPrivate() {
         //not neccesary context is managed by filters.
@@ -64,6 +108,243 @@ public:
     VideoCapture *capture;
     VideoFilterContext *filter_context;//TODO: use own smart ptr. QSharedPointer "=" is ugly
     VideoFrame displayed_frame;
+    bool async_filter;
+    int eq[4]; // brightness, contrast, saturation, hue. [-100, 100]
+    // applied on yuv frames in native format. VideoFrameConverter eq is used only if format is not supported
+    VideoEQFilter eq_filter;
+    bool low_latency;
+    int target_latency; // ms
+    qint64 realtime_start; // us, wall clock time of realtime_pts0. 0: unknown
+    qreal realtime_pts0;
+    qreal last_pkt_pts; // pts of the last packet taken from queue
+    QElapsedTimer pkt_timer; // started when the last packet is taken from queue
+    qreal present_v_a;
+    bool present_v_a_valid;
+    /*
+     * frames can be presented in filter stage thread. protects eq, eq_filter, conv, displayed_frame,
+     * last_pkt_pts, pkt_timer and present_v_a which are accessed by video thread, filter stage and capture
+     */
+    mutable QMutex present_mutex;
+    volatile bool gov_half_rate; // QualityGovernor::LowFrameRate. set by video thread
+    int nb_gov_frames;
+};
+
+void VideoThreadPrivate::packetTaken(const Packet &pkt)
+{
+    QMutexLocker lock(&present_mutex);
+    Q_UNUSED(lock);
+    pkt_timer.start();
+    if (pkt.pts >= 0)
+        last_pkt_pts = pkt.pts;
+}
+
+void VideoThreadPrivate::setPresentedV_A(qreal v_a)
+{
+    QMutexLocker lock(&present_mutex);
+    Q_UNUSED(lock);
+    present_v_a = v_a;
+    present_v_a_valid = true;
+}
+
+bool VideoThreadPrivate::takePresentedV_A(qreal *v_a)
+{
+    QMutexLocker lock(&present_mutex);
+    Q_UNUSED(lock);
+    if (!present_v_a_valid)
+        return false;
+    present_v_a_valid = false;
+    *v_a = present_v_a;
+    return true;
+}
+
+void VideoThreadPrivate::framePresented(const VideoFrame &frame)
+{
+    QMutexLocker lock(&present_mutex);
+    Q_UNUSED(lock);
+    // TODO: store original frame. now the frame is filtered and maybe converted to renderer perferred format
+    displayed_frame = frame;
+    if (!statistics)
+        return;
+    // queued packets + decoder delay (frames reordered or buffered in decoder) + decoding/filtering/waiting time
+    const qreal queued = packets.bufferMode() == BufferTime ? qreal(packets.buffered()) : 0;
+    const qreal decoding = qMax<qreal>(0, (last_pkt_pts - frame.timestamp())*1000.0);
+    const qreal added = queued + decoding + (pkt_timer.isValid() ? qreal(pkt_timer.elapsed()) : 0);
+    Statistics::Latency &l = statistics->latency;
+    l.added = l.added <= 0 ? added : (l.added*7.0 + added)/8.0;
+    if (realtime_start > 0)
+        l.glass_to_glass = qreal(QDateTime::currentMSecsSinceEpoch()) - (qreal(realtime_start)/1000.0 + (frame.timestamp() - realtime_pts0)*1000.0);
+}
+
+// correction of the video clock compare diff by the A-V difference of the presented frame
+static qreal correctV_A(qreal v_a, qreal v_a_)
+{
+    if (qFuzzyIsNull(v_a_))
+        return v_a;
+    if (v_a_ < -0.1) {
+        if (v_a <= v_a_)
+            v_a += -0.01;
+        else
+            v_a = (v_a_ +v_a)*0.5;
+    } else if (v_a_ < -0.002) {
+        v_a += -0.001;
+    } else if (v_a_ < 0.002) {
+    } else if (v_a_ < 0.1) {
+        v_a += 0.001;
+    } else {
+        if (v_a >= v_a_)
+            v_a += 0.01;
+        else
+            v_a = (v_a_ +v_a)*0.5;
+    }
+    if (v_a < -2 || v_a > 2)
+       v_a /= 2.0;
+    return v_a;
+}
+
+/*!
+ * Apply filters and deliver frames in a separated thread. Decoded frames are passed from video thread
+ * through a bounded queue, so decoding, filtering and presenting are overlapped. Frames are processed in decoding order.
+ * Capacity is small because hw decoders have a limited surface pool.
+ */
+class VideoFilterStage : public QThread
+{
+public:
+    enum { kQueueSize = 3 };
+    VideoFilterStage(VideoThread *thread)
+        : QThread(0)
+        , vthread(thread)
+        , serial(0)
+    {
+        frames.setCapacity(kQueueSize);
+        frames.setThreshold(1);
+    }
+    // called in video thread. blocks if queue is full
+    void put(const VideoFrame& frame, bool seeking) {
+        Item item;
+        item.frame = frame;
+        item.serial = (int)serial;
+        item.seeking = seeking;
+        frames.put(item);
+    }
+    // called in video thread when seeking. queued frames are dropped and filters are flushed in filter thread
+    void flush() {
+        serial.ref();
+        frames.clear();
+        Item item;
+        item.serial = (int)serial;
+        item.type = Item::Flush;
+        frames.put(item, 0);
+    }
+    // called in video thread when all frames are decoded. filters are notified after the queued frames
+    void endOfStream() {
+        Item item;
+        item.serial = (int)serial;
+        item.type = Item::EndOfStream;
+        frames.put(item);
+    }
+    // called in video thread. process queued frames and quit. returns immediately if video thread is stopped
+    void finish() {
+        Item item;
+        item.type = Item::End;
+        frames.put(item, 0); // no block
+        wait();
+    }
+protected:
+    void run() Q_DECL_OVERRIDE {
+        VideoThreadPrivate &d = vthread->d_func();
+        frames.setBlocking(true);
+        while (!d.stop) {
+            bool valid = false;
+            const Item item(frames.take(100UL, &valid)); // timeout to check stop
+            if (!valid)
+                continue;
+            if (item.type == Item::End)
+                break;
+            if (item.type == Item::Flush) {
+                vthread->flushFilters();
+                continue;
+            }
+            if (item.type == Item::EndOfStream) {
+                if (item.serial == (int)serial)
+                    vthread->endOfStreamFilters();
+                continue;
+            }
+            if (item.serial != (int)serial) // seek requested
+                continue;
+            QList<VideoFrame> out;
+            vthread->applyFilters(item.frame, out);
+            const qreal t0 = d.clock->initialValue();
+            foreach (VideoFrame frame, out) {
+                // queued frames must not be presented while paused. a step wakes up and presents the next one.
+                // no pause when seeking, like video thread
+                if (!item.seeking && !waitPaused(item.serial))
+                    break;
+                if (!item.seeking && d.skipPresent())
+                    continue;
+                // present on a tick of the group schedule
+                qreal tick = frame.timestamp();
+                const bool grouped = !item.seeking && d.clock->groupPresentTime(frame.timestamp() - t0, &tick);
+                if (grouped)
+                    tick += t0;
+                if (!item.seeking && !waitToPresent(tick, item.serial))
+                    break;
+                if (d.stop || item.serial != (int)serial)
+                    break;
+                if (grouped && d.clock->groupCheckLate(tick - t0))
+                    continue;
+                if (!vthread->deliverVideoFrame(frame))
+                    continue;
+                d.clock->groupFramePresented(frame.timestamp() - t0);
+                d.framePresented(frame);
+                // v_a is corrected by video thread
+                if (!item.seeking && d.clock->clockType() == AVClock::AudioClock)
+                    d.setPresentedV_A(frame.timestamp() - d.clock->value());
+            }
+        }
+        // wake up video thread if it's waiting for a free slot
+        frames.setBlocking(false);
+        frames.clear();
+    }
+private:
+    bool waitPaused(int id) {
+        VideoThreadPrivate &d = vthread->d_func();
+        while (d.outputSet->canPauseThread() && !d.stop && id == (int)serial)
+            d.outputSet->pauseThread(100);
+        while (vthread->isPaused() && !d.stop && id == (int)serial) {
+            if (vthread->tryPause(100)) // resumed or nextAndPause()
+                break;
+        }
+        return !d.stop && id == (int)serial;
+    }
+    // wait until the clock reaches pts. never longer than the time difference when it starts, because the clock may be paused
+    bool waitToPresent(qreal pts, int id) {
+        VideoThreadPrivate &d = vthread->d_func();
+        const qreal dt = pts - d.clock->value();
+        if (dt <= 0 || dt >= 1.0)
+            return true;
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 ms = qint64(dt*1000.0);
+        while (!d.stop && id == (int)serial) {
+            const qint64 left = qMin<qint64>(ms - timer.elapsed(), qint64((pts - d.clock->value())*1000.0));
+            if (left <= 0)
+                return true;
+            msleep(qMin<qint64>(left, 20LL));
+        }
+        return false;
+    }
+
+    struct Item {
+        enum Type { Frame, Flush, EndOfStream, End };
+        Item() : type(Frame), serial(0), seeking(false) {}
+        Type type;
+        int serial;
+        bool seeking;
+        VideoFrame frame;
+    };
+    VideoThread *vthread;
+    QAtomicInt serial;
+    BlockingQueue<Item> frames;
 };
 
 VideoThread::VideoThread(QObject *parent) :
@@ -124,7 +405,10 @@ void VideoThread::clearRenderers()
 
 VideoFrame VideoThread::displayedFrame() const
 {
-    return d_func().displayed_frame;
+    DPTR_D(const VideoThread);
+    QMutexLocker lock(&d.present_mutex);
+    Q_UNUSED(lock);
+    return d.displayed_frame;
 }
 
 void VideoThread::setFrameRate(qreal value)
@@ -143,6 +427,11 @@ void VideoThread::setBrightness(int val)
     setEQ(val, 101, 101);
 }
 
+void VideoThread::setHue(int val)
+{
+    setEQ(101, 101, 101, val);
+}
+
 void VideoThread::setContrast(int val)
 {
     setEQ(101, val, 101);
@@ -154,29 +443,47 @@ void VideoThread::setSaturation(int val)
 }
 
 void VideoThread::setEQ(int b, int c, int s)
+{
+    setEQ(b, c, s, 101);
+}
+
+// value out of [-100, 100] changes nothing
+void VideoThread::setEQ(int b, int c, int s, int h)
 {
     class EQTask : public QRunnable {
     public:
-        EQTask(VideoFrameConverter *c)
+        EQTask(VideoThreadPrivate *p)
             : brightness(0)
             , contrast(0)
             , saturation(0)
-            , conv(c)
+            , hue(0)
+            , d(p)
         {
             //qDebug("EQTask tid=%p", QThread::currentThread());
         }
         void run() {
-            conv->setEq(brightness, contrast, saturation);
+            QMutexLocker lock(&d->present_mutex);
+            Q_UNUSED(lock);
+            const int v[] = { brightness, contrast, saturation, hue };
+            for (int i = 0; i < 4; ++i) {
+                if (v[i] >= -100 && v[i] <= 100)
+                    d->eq[i] = v[i];
+            }
+            d->eq_filter.setBrightness(qreal(d->eq[0])/100.0);
+            d->eq_filter.setContrast(qreal(d->eq[1])/100.0);
+            d->eq_filter.setSaturation(qreal(d->eq[2])/100.0);
+            d->eq_filter.setHue(qreal(d->eq[3])/100.0);
         }
-        int brightness, contrast, saturation;
+        int brightness, contrast, saturation, hue;
     private:
-        VideoFrameConverter *conv;
+        VideoThreadPrivate *d;
     };
     DPTR_D(VideoThread);
-    EQTask *task = new EQTask(&d.conv);
+    EQTask *task = new EQTask(&d);
     task->brightness = b;
     task->contrast = c;
     task->saturation = s;
+    task->hue = h;
     if (isRunning()) {
         scheduleTask(task);
     } else {
@@ -185,20 +492,80 @@ void VideoThread::setEQ(int b, int c, int s)
     }
 }
 
-void VideoThread::applyFilters(VideoFrame &frame)
+void VideoThread::setAsyncFilter(bool value)
+{
+    d_func().async_filter = value;
+}
+
+bool VideoThread::isAsyncFilter() const
+{
+    return d_func().async_filter;
+}
+
+void VideoThread::setLowLatency(bool value, int targetMs)
+{
+    DPTR_D(VideoThread);
+    d.low_latency = value;
+    d.target_latency = qMax(1, targetMs);
+}
+
+void VideoThread::setRealTimeStart(qint64 us, qreal pts)
+{
+    DPTR_D(VideoThread);
+    d.realtime_start = us;
+    d.realtime_pts0 = pts;
+}
+
+void VideoThread::applyFilters(const VideoFrame &frame, QList<VideoFrame> &outFrames)
 {
     DPTR_D(VideoThread);
     QMutexLocker locker(&d.mutex);
     Q_UNUSED(locker);
-    if (!d.filters.isEmpty()) {
-        //sort filters by format. vo->defaultFormat() is the last
-        foreach (Filter *filter, d.filters) {
-            VideoFilter *vf = static_cast<VideoFilter*>(filter);
-            if (!vf->isEnabled())
-                continue;
-            if (vf->prepareContext(d.filter_context, d.statistics, &frame))
-                vf->apply(d.statistics, &frame);
+    outFrames.append(frame);
+    if (d.filters.isEmpty())
+        return;
+    //sort filters by format. vo->defaultFormat() is the last
+    foreach (Filter *filter, d.filters) {
+        VideoFilter *vf = static_cast<VideoFilter*>(filter);
+        if (!vf->isEnabled())
+            continue;
+        // a filter can output 0..N frames for each input frame. every output is the input of the next filter
+        QList<VideoFrame> frames;
+        QElapsedTimer timer;
+        timer.start();
+        foreach (VideoFrame f, outFrames) {
+            if (vf->prepareContext(d.filter_context, d.statistics, &f))
+                vf->apply(d.statistics, f, frames);
+            else
+                frames.append(f);
+        }
+        if (d.statistics) {
+            const QString name(vf->objectName().isEmpty() ? QString::fromLatin1(vf->metaObject()->className()) : vf->objectName());
+            d.statistics->video_only.filterProcessed(name, qreal(timer.nsecsElapsed())/1000000.0);
         }
+        outFrames = frames;
+        if (outFrames.isEmpty())
+            return;
+    }
+}
+
+void VideoThread::flushFilters()
+{
+    DPTR_D(VideoThread);
+    QMutexLocker locker(&d.mutex);
+    Q_UNUSED(locker);
+    foreach (Filter *filter, d.filters) {
+        static_cast<VideoFilter*>(filter)->flush();
+    }
+}
+
+void VideoThread::endOfStreamFilters()
+{
+    DPTR_D(VideoThread);
+    QMutexLocker locker(&d.mutex);
+    Q_UNUSED(locker);
+    foreach (Filter *filter, d.filters) {
+        static_cast<VideoFilter*>(filter)->endOfStream();
     }
 }
 
@@ -210,6 +577,11 @@ bool VideoThread::deliverVideoFrame(VideoFrame &frame)
      * TODO: video renderers sorted by preferredPixelFormat() and convert in AVOutputSet.
      * Convert only once for the renderers has the same preferredPixelFormat().
      */
+    // eq in native format if possible, so no conversion is required if renderer supports the format
+    const bool native_eq = VideoEQFilter::isFormatSupported(frame.format());
+    QMutexLocker eq_lock(&d.present_mutex); // eq can be changed in video thread while presenting in filter stage
+    if (native_eq && !d.eq_filter.isIdentity())
+        d.eq_filter.apply(d.statistics, &frame);
     d.outputSet->lock();
     QList<AVOutput *> outputs = d.outputSet->outputs();
     VideoRenderer *vo = 0;
@@ -223,6 +595,10 @@ bool VideoThread::deliverVideoFrame(VideoFrame &frame)
             fmt = VideoFormat::Format_RGB32;
         else
             fmt = vo->preferredPixelFormat();
+        if (native_eq)
+            d.conv.setEq(0, 0, 0);
+        else
+            d.conv.setEq(d.eq[0], d.eq[1], d.eq[2]); // no hue
         VideoFrame outFrame(d.conv.convert(frame, fmt));
         if (!outFrame.isValid()) {
             d.outputSet->unlock();
@@ -230,6 +606,7 @@ bool VideoThread::deliverVideoFrame(VideoFrame &frame)
         }
         frame = outFrame;
     }
+    eq_lock.unlock();
     d.outputSet->sendVideoFrame(frame); //TODO: group by format, convert group by group
     d.outputSet->unlock();
 
@@ -249,9 +626,26 @@ void VideoThread::run()
     }
     //not neccesary context is managed by filters.
     d.filter_context = VideoFilterContext::create(VideoFilterContext::QtPainter);
+    QScopedPointer<VideoFilterStage> filter_stage;
+    if (d.async_filter) {
+        filter_stage.reset(new VideoFilterStage(this));
+        filter_stage->start();
+    }
     VideoDecoder *dec = static_cast<VideoDecoder*>(d.dec);
     Packet pkt;
-    QVariantHash *dec_opt = &d.dec_opt_normal; //TODO: restore old framedrop option after seek
+    // discard levels set to the decoder. options() of the decoder are used until frame drop starts
+    VideoDecoder::DiscardLevel discard = VideoDecoder::DiscardDefault;
+    VideoDecoder::DiscardLevel discard_loop = VideoDecoder::DiscardDefault;
+    bool discard_applied = true;
+    // levels of the process wide quality governor replace the slow frame heuristics below
+    QualityGovernor &governor = QualityGovernor::instance();
+    // always registered, so the governor can be enabled or disabled while playing
+    const int gov_id = governor.addClient(parent());
+    bool gov_enabled = false;
+    int gov_level = QualityGovernor::FullQuality;
+    d.gov_half_rate = false;
+    int lowres = 0;
+    bool lowres_supported = true;
     /*!
      * if we skip some frames(e.g. seek, drop frames to speed up), then then first frame to decode must
      * be a key frame for hardware decoding. otherwise may crash
@@ -309,6 +703,7 @@ void VideoThread::run()
         }
         if(!pkt.isValid() && !pkt.isEOF()) { // can't seek back if eof packet is read
             pkt = d.packets.take(); //wait to dequeue
+            d.packetTaken(pkt);
            // TODO: push pts history here and reorder
         }
         if (pkt.isEOF()) {
@@ -322,6 +717,10 @@ void VideoThread::run()
                 wait_key_frame = true;
                 qDebug("Invalid packet! flush video codec context!!!!!!!!!! video packet queue size: %d", d.packets.size());
                 d.dec->flush(); //d.dec instead of dec because d.dec maybe changed in processNextTask() but dec is not
+                if (filter_stage)
+                    filter_stage->flush();
+                else
+                    flushFilters();
                 d.render_pts0 = pkt.pts;
                 sync_id = pkt.position;
                 if (pkt.pts >= 0)
@@ -374,6 +773,18 @@ void VideoThread::run()
             nb_dec_slow = 0;
             nb_dec_fast = 0;
         }
+        if (!seeking && !pkt.isEOF()) {
+            gov_enabled = governor.isEnabled();
+            if (gov_enabled) {
+                governor.reportLateness(gov_id, -diff);
+                gov_level = governor.clientLevel(gov_id);
+                nb_dec_slow = 0;
+            } else {
+                gov_level = QualityGovernor::FullQuality;
+            }
+            // frames are dropped when presenting, after filters, so temporal filters and the filter stage see all frames
+            d.gov_half_rate = gov_level == QualityGovernor::LowFrameRate;
+        }
         //qDebug("nb_fast/slow: %d/%d. diff: %f, delay: %f, dts: %f, clock: %f", nb_dec_fast, nb_dec_slow, diff, d.delay, dts, clock()->value());
         if (d.delay < -0.5 && d.delay > diff) {
             if (!seeking) {
@@ -387,7 +798,7 @@ void VideoThread::run()
                     v_a = 0;
                     // TODO: use discard flag
                     continue;
-                } else {
+                } else if (!gov_enabled) {
                     nb_dec_slow++;
                     qDebug("frame slow count: %d. v-a: %.3f", nb_dec_slow, diff);
                 }
@@ -406,6 +817,23 @@ void VideoThread::run()
         */
         if (seeking)
             diff = 0; // TODO: here?
+        bool drop_render = false;
+        if (d.low_latency && !seeking && !pkt.isEOF()) {
+            // present as soon as decoded if not synced to audio
+            if (!sync_audio)
+                diff = qMin<qreal>(diff, 0);
+            // catch up: drop rendering if queued too much, skip to the next key frame if far behind
+            const qint64 queued = d.packets.bufferMode() == BufferTime ? d.packets.buffered() : 0;
+            if (queued > 4*d.target_latency && !pkt.hasKeyFrame) {
+                qDebug("low latency: %lldms queued. skip decoding until next key frame", queued);
+                d.statistics->latency.drops++;
+                wait_key_frame = true;
+                pkt = Packet();
+                v_a = 0;
+                continue;
+            }
+            drop_render = queued > d.target_latency;
+        }
         if (!sync_audio && diff > 0) {
             // wait to dts reaches
             // d.force_fps>0: wait after decoded before deliver
@@ -448,26 +876,26 @@ void VideoThread::run()
             }
             wait_key_frame = false;
         }
-        QVariantHash *dec_opt_old = dec_opt;
+        VideoDecoder::DiscardLevel frames = discard, loop_filter = discard_loop;
         if (!seeking || pkt.pts - d.render_pts0 >= -0.05) { // MAYBE not seeking. We should not drop the frames near the seek target. FIXME: use packet pts distance instead of -0.05 (20fps)
             if (seeking)
                 qDebug("seeking... pkt.pts - d.render_pts0: %.3f", pkt.pts - d.render_pts0);
-            if (nb_dec_slow < kNbSlowFrameDrop) {
-                if (dec_opt == &d.dec_opt_framedrop) {
-                    qDebug("frame drop=>normal. nb_dec_slow: %d", nb_dec_slow);
-                    dec_opt = &d.dec_opt_normal;
-                }
+            if (gov_enabled) {
+                // KeyFrameOnly is AVDISCARD_NONKEY(32). AVDISCARD_ALL(48) would discard key frames too
+                frames = gov_level >= QualityGovernor::KeyFrameOnly ? VideoDecoder::DiscardNonKey
+                        : gov_level >= QualityGovernor::SkipNonRef ? VideoDecoder::DiscardNonRef : VideoDecoder::DiscardDefault;
+                loop_filter = gov_level >= QualityGovernor::LowResolution ? VideoDecoder::DiscardBidir : VideoDecoder::DiscardDefault;
             } else {
-                if (dec_opt == &d.dec_opt_normal) {
-                    qDebug("frame drop=>noref. nb_dec_slow: %d too slow", nb_dec_slow);
-                    dec_opt = &d.dec_opt_framedrop;
-                }
+                VideoDecoder::slowDiscardLevel(nb_dec_slow, kNbSlowFrameDrop, kNbSlowSkip, &frames, &loop_filter);
             }
+            // references of the next frames may be not decoded if B frames are discarded
+            if (frames < discard && discard > VideoDecoder::DiscardNonRef && !pkt.hasKeyFrame)
+                frames = discard;
         } else { // seeking
             if (seek_count > 0 && d.drop_frame_seek) {
-                if (dec_opt == &d.dec_opt_normal) {
+                if (frames < VideoDecoder::DiscardNonRef) {
                     qDebug("seeking... pkt.pts - d.render_pts0: %.3f, frame drop=>noref. nb_dec_slow: %d", pkt.pts - d.render_pts0, nb_dec_slow);
-                    dec_opt = &d.dec_opt_framedrop;
+                    frames = VideoDecoder::DiscardNonRef;
                 }
             } else {
                 seek_count = -1;
@@ -477,6 +905,7 @@ void VideoThread::run()
         // decoder maybe changed in processNextTask(). code above MUST use d.dec but not dec
         if (dec != static_cast<VideoDecoder*>(d.dec)) {
             dec = static_cast<VideoDecoder*>(d.dec);
+            discard_applied = discard == VideoDecoder::DiscardDefault && discard_loop == VideoDecoder::DiscardDefault;
             if (!pkt.hasKeyFrame) {
                 wait_key_frame = true;
                 v_a = 0;
@@ -484,12 +913,33 @@ void VideoThread::run()
             }
             qDebug("decoder changed. decoding key frame");
         }
-        if (dec_opt != dec_opt_old)
-            dec->setOptions(*dec_opt);
+        // gov_level is FullQuality if disabled, so lowres is restored
+        if (lowres_supported && !seeking && pkt.hasKeyFrame) {
+            const int gov_lowres = gov_level >= QualityGovernor::LowResolution ? 1 : 0;
+            if (gov_lowres != lowres) {
+                if (setDecoderLowres(dec, gov_lowres))
+                    lowres = gov_lowres;
+                else
+                    lowres_supported = false;
+                // reopen applies options() again
+                discard_applied = discard == VideoDecoder::DiscardDefault && discard_loop == VideoDecoder::DiscardDefault;
+            }
+        }
+        if (!discard_applied || frames != discard || loop_filter != discard_loop) {
+            qDebug("decoder discard level frames: %d, loop filter: %d. nb_dec_slow: %d, governor level: %d", frames, loop_filter, nb_dec_slow, gov_level);
+            dec->setDiscardLevel(frames, loop_filter);
+            discard = frames;
+            discard_loop = loop_filter;
+            discard_applied = true;
+        }
         if (!dec->decode(pkt)) {
             d.pts_history.push_back(d.pts_history.back());
             //qWarning("Decode video failed. undecoded: %d/%d", dec->undecodedSize(), pkt.data.size());
             if (pkt.isEOF()) {
+                if (filter_stage)
+                    filter_stage->endOfStream();
+                else
+                    endOfStreamFilters();
                 Q_EMIT eofDecoded();
                 qDebug("video decode eof done. d.render_pts0: %.3f", d.render_pts0);
                 if (d.render_pts0 >= 0) {
@@ -550,69 +1000,87 @@ void VideoThread::run()
             continue;
         }
         Q_ASSERT(d.statistics);
+        if (drop_render) {
+            d.statistics->latency.drops++;
+            continue;
+        }
         d.statistics->video.current_time = QTime(0, 0, 0).addMSecs(int(pts * 1000.0)); //TODO: is it expensive?
-        applyFilters(frame);
-
-        //while can pause, processNextTask, not call outset.puase which is deperecated
-        while (d.outputSet->canPauseThread()) {
-            d.outputSet->pauseThread(100);
-            //tryPause(100);
-            processNextTask();
-        }
-        //qDebug("force fps: %f dt: %d", d.force_fps, d.force_dt);
-        if (d.force_dt > 0) {// && qFuzzyCompare(d.clock->speed(), 1.0)) {
-            const qint64 now = QDateTime::currentMSecsSinceEpoch();
-            const qint64 delta = qint64(d.force_dt) - (now - last_deliver_time);
-            if (frame.timestamp() <= 0) {
-                // TODO: what if seek happens during playback?
-                const int msecs_started(now + qMax(0LL, delta) - start_time);
-                frame.setTimestamp(qreal(msecs_started)/1000.0);
-                clock()->updateValue(frame.timestamp()); //external clock?
-            }
-            if (delta > 0LL) { // limit up bound?
-                waitAndCheck((ulong)delta, -1); // wait and not compare pts-clock
+        // forced frame rate needs the frame count to compute timestamps, use the serial path
+        if (filter_stage && d.force_dt <= 0) {
+            filter_stage->put(frame, seeking);
+            qreal v_a_ = 0;
+            if (d.takePresentedV_A(&v_a_) && !seeking && d.clock->clockType() == AVClock::AudioClock)
+                v_a = correctV_A(v_a, v_a_);
+            continue;
+        }
+        QList<VideoFrame> frames;
+        applyFilters(frame, frames);
+        for (int i = 0; i < frames.size(); ++i) {
+            frame = frames.at(i);
+            if (!seeking && d.skipPresent())
+                continue;
+            // filters can output 0..N frames (field rate deinterlacing, fps etc.) with their own timestamps, the 1st one
+            // is not always at packet time. forced frame rate sets the 1st timestamp and waits below
+            if (i > 0 || d.force_dt <= 0) {
+                if (!seeking) {
+                    const qreal frame_wait = frame.timestamp() - d.clock->value();
+                    if (frame_wait > 0 && frame_wait < 1.0)
+                        waitAndCheck(frame_wait*1000UL, frame.timestamp());
+                }
+                d.clock->updateVideoTime(frame.timestamp());
             }
-        } else if (false) { //FIXME: may block a while when seeking
-            const qreal display_wait = pts - clock()->value();
-            if (!seeking && display_wait > 0.0) {
-                // wait to pts reaches. TODO: count rendering time
-                //qDebug("wait %f to display for pts %f-%f", display_wait, pts, clock()->value());
-                if (display_wait < 1.0)
-                    waitAndCheck(display_wait*1000UL, pts); // TODO: count decoding and filter time
+            //while can pause, processNextTask, not call outset.puase which is deperecated
+            while (d.outputSet->canPauseThread()) {
+                d.outputSet->pauseThread(100);
+                //tryPause(100);
+                processNextTask();
             }
-        }
-        // no return even if d.stop is true. ensure frame is displayed. otherwise playing an image may be failed to display
-        if (!deliverVideoFrame(frame))
-            continue;
-        //qDebug("clock.diff: %.3f", d.clock->diff());
-        if (d.force_dt > 0)
-            last_deliver_time = QDateTime::currentMSecsSinceEpoch();
-        // TODO: store original frame. now the frame is filtered and maybe converted to renderer perferred format
-        d.displayed_frame = frame;
-        if (d.clock->clockType() == AVClock::AudioClock) {
-            const qreal v_a_ = frame.timestamp() - d.clock->value();
-            if (!qFuzzyIsNull(v_a_)) {
-                if (v_a_ < -0.1) {
-                    if (v_a <= v_a_)
-                        v_a += -0.01;
-                    else
-                        v_a = (v_a_ +v_a)*0.5;
-                } else if (v_a_ < -0.002) {
-                    v_a += -0.001;
-                } else if (v_a_ < 0.002) {
-                } else if (v_a_ < 0.1) {
-                    v_a += 0.001;
-                } else {
-                    if (v_a >= v_a_)
-                        v_a += 0.01;
-                    else
-                        v_a = (v_a_ +v_a)*0.5;
+            //qDebug("force fps: %f dt: %d", d.force_fps, d.force_dt);
+            if (d.force_dt > 0) {// && qFuzzyCompare(d.clock->speed(), 1.0)) {
+                const qint64 now = QDateTime::currentMSecsSinceEpoch();
+                const qint64 delta = qint64(d.force_dt) - (now - last_deliver_time);
+                if (frame.timestamp() <= 0) {
+                    // TODO: what if seek happens during playback?
+                    const int msecs_started(now + qMax(0LL, delta) - start_time);
+                    frame.setTimestamp(qreal(msecs_started)/1000.0);
+                    clock()->updateValue(frame.timestamp()); //external clock?
                 }
-
-                if (v_a < -2 || v_a > 2)
-                   v_a /= 2.0;
+                if (delta > 0LL) { // limit up bound?
+                    waitAndCheck((ulong)delta, -1); // wait and not compare pts-clock
+                }
+            } else if (false) { //FIXME: may block a while when seeking
+                const qreal display_wait = pts - clock()->value();
+                if (!seeking && display_wait > 0.0) {
+                    // wait to pts reaches. TODO: count rendering time
+                    //qDebug("wait %f to display for pts %f-%f", display_wait, pts, clock()->value());
+                    if (display_wait < 1.0)
+                        waitAndCheck(display_wait*1000UL, pts); // TODO: count decoding and filter time
+                }
+            }
+            // present on a tick of the group schedule. drop the frame if its tick is missed
+            const qreal t0 = d.clock->initialValue();
+            qreal tick = 0;
+            if (!seeking && d.clock->groupPresentTime(frame.timestamp() - t0, &tick)) {
+                tick += t0;
+                const qreal tick_wait = tick - d.clock->value();
+                if (tick_wait > 0 && tick_wait < 1.0)
+                    waitAndCheck(tick_wait*1000UL, tick);
+                if (d.clock->groupCheckLate(tick - t0))
+                    continue;
+            }
+            // no return even if d.stop is true. ensure frame is displayed. otherwise playing an image may be failed to display
+            if (!deliverVideoFrame(frame))
+                continue;
+            d.clock->groupFramePresented(frame.timestamp() - t0);
+            //qDebug("clock.diff: %.3f", d.clock->diff());
+            if (d.force_dt > 0)
+                last_deliver_time = QDateTime::currentMSecsSinceEpoch();
+            d.framePresented(frame);
+            if (d.clock->clockType() == AVClock::AudioClock) {
+                const qreal v_a_ = frame.timestamp() - d.clock->value();
+                v_a = correctV_A(v_a, v_a_);
+                //qDebug("v_a:%.4f, v_a_: %.4f", v_a, v_a_);
             }
-            //qDebug("v_a:%.4f, v_a_: %.4f", v_a, v_a_);
         }
     }
 #if 0
@@ -623,6 +1091,12 @@ void VideoThread::run()
         while (d.dec && d.dec->decode(Packet::createEOF())) {d.dec->flush();}
     }
 #endif
+    if (filter_stage)
+        filter_stage->finish();
+    governor.removeClient(gov_id);
+    // the decoder can be reused by others
+    if (lowres)
+        setDecoderLowres(static_cast<VideoDecoder*>(d.dec), 0);
     d.packets.clear();
     qDebug("Video thread stops running...");
 }
@@ -46,17 +46,44 @@ public:
     void setContrast(int val);
     void setSaturation(int val);
     void setEQ(int b, int c, int s);
+    void setHue(int val);
+    void setEQ(int b, int c, int s, int h);
+    /*!
+     * \brief setAsyncFilter
+     * Apply filters and deliver frames in a separated thread connected by a bounded frame queue,
+     * so that expensive filters do not slow down decoding. Takes effect when thread starts.
+     */
+    void setAsyncFilter(bool value);
+    bool isAsyncFilter() const;
+    /*!
+     * \brief setLowLatency
+     * Present frames as soon as decoded if not synced to audio, drop frames if queued packets exceed \a targetMs,
+     * and skip to the next key frame if far behind. Packet queue must be in BufferTime mode. Latency estimation is in Statistics::latency
+     */
+    void setLowLatency(bool value, int targetMs);
+    /*!
+     * \brief setRealTimeStart
+     * Wall clock time in us of the frame with \a pts, e.g. from AVFormatContext.start_time_realtime. Used to estimate glass-to-glass latency
+     */
+    void setRealTimeStart(qint64 us, qreal pts);
 
 public Q_SLOTS:
     void addCaptureTask();
     void clearRenderers();
 
 protected:
-    void applyFilters(VideoFrame& frame);
+    // filters can output 0..N frames for 1 input frame. all output frames are appended to outFrames
+    void applyFilters(const VideoFrame& frame, QList<VideoFrame>& outFrames);
+    // drop frames buffered in filters. called when seeking
+    void flushFilters();
+    // notify filters that all frames are decoded, e.g. to process the last incomplete batch
+    void endOfStreamFilters();
     // deliver video frame to video renderers. frame may be converted to a suitable format for renderer
     bool deliverVideoFrame(VideoFrame &frame);
     virtual void run();
     // wait for value msec. every usleep is a small time, then process next task and get new delay
+private:
+    friend class VideoFilterStage;
 };
 
 
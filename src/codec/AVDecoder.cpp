@@ -110,12 +110,15 @@ bool AVDecoder::open()
     }
     // CODEC_FLAG_OUTPUT_CORRUPT, CODEC_FLAG2_SHOW_ALL?
     // TODO: skip for none-ffmpeg based decoders
+    // discard levels set by VideoDecoder::setDiscardLevel() are still in the context if reopened
+    d.restoreDiscardOptions();
     d.applyOptionsForDict();
     av_opt_set_int(d.codec_ctx, "refcounted_frames", d.enableFrameRef(), 0); // why dict may have no effect?
     // TODO: only open for ff decoders
     //av_dict_set(&d.dict, "lowres", "1", 0);
     // dict is used for a specified AVCodec options (priv_class), av_opt_set_xxx(avctx) is only for avctx
     AV_ENSURE_OK(avcodec_open2(d.codec_ctx, codec, d.options.isEmpty() ? NULL : &d.dict), false);
+    d.saveDiscardOptions();
     d.is_open = true;
     static const char* thread_name[] = { "Single", "Frame", "Slice"};
     qDebug("%s thread type: %s, count: %d", metaObject()->className(), thread_name[d.codec_ctx->active_thread_type], d.codec_ctx->thread_count);
@@ -244,8 +247,10 @@ void AVDecoder::setOptions(const QVariantHash &dict)
     DPTR_D(AVDecoder);
     d.options = dict;
     // if dict is empty, can not return here, default options will be set for AVCodecContext
-    // apply to AVCodecContext
+    // apply to AVCodecContext. the temporary discard level is dropped, so options without skip_xxx keep the previous values
+    d.restoreDiscardOptions();
     d.applyOptionsForContext();
+    d.saveDiscardOptions();
     /* set AVDecoder meta properties.
      * we do not check whether the property exists thus we can set dynamic properties.
      */
@@ -300,4 +305,22 @@ void AVDecoderPrivate::applyOptionsForContext()
     // TODO: wrong if opt is empty
     Internal::setOptionsToFFmpegObj(options.value(QStringLiteral("avcodec")), codec_ctx);
 }
+
+void AVDecoderPrivate::saveDiscardOptions()
+{
+    if (!codec_ctx)
+        return;
+    skip_frame = codec_ctx->skip_frame;
+    skip_loop_filter = codec_ctx->skip_loop_filter;
+    skip_idct = codec_ctx->skip_idct;
+}
+
+void AVDecoderPrivate::restoreDiscardOptions()
+{
+    if (!codec_ctx)
+        return;
+    codec_ctx->skip_frame = (AVDiscard)skip_frame;
+    codec_ctx->skip_loop_filter = (AVDiscard)skip_loop_filter;
+    codec_ctx->skip_idct = (AVDiscard)skip_idct;
+}
 } //namespace QtAV
@@ -0,0 +1,228 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/DecoderPool.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include "QtAV/AVDecoder.h"
+#include "QtAV/private/AVCompat.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+namespace {
+// QVariantHash iteration order is not defined. use sorted maps for a stable key
+QVariant toStableVariant(const QVariant& v)
+{
+    if (v.type() != QVariant::Hash && v.type() != QVariant::Map)
+        return v;
+    QVariantMap m(v.toMap());
+    for (QVariantMap::iterator it = m.begin(); it != m.end(); ++it)
+        it.value() = toStableVariant(it.value());
+    return m;
+}
+
+void clearDecoderPool()
+{
+    DecoderPool::instance().clear(); // delete decoders before libraries (hw drivers) are unloaded
+}
+} //namespace
+
+class DecoderPoolPrivate : public DPtrPrivate<DecoderPool>
+{
+public:
+    struct Entry {
+        QByteArray key;
+        AVDecoder *decoder;
+    };
+    DecoderPoolPrivate()
+        : capacity(4)
+        , hits(0)
+        , misses(0)
+    {}
+    ~DecoderPoolPrivate() {
+        foreach (const Entry& e, entries) {
+            delete e.decoder;
+        }
+    }
+
+    mutable QMutex mutex;
+    QList<Entry> entries; // the last one is the most recently put
+    int capacity;
+    int hits, misses;
+};
+
+DecoderPool& DecoderPool::instance()
+{
+    static DecoderPool sPool;
+    return sPool;
+}
+
+DecoderPool::DecoderPool()
+{
+    qAddPostRoutine(clearDecoderPool);
+}
+
+DecoderPool::~DecoderPool()
+{
+}
+
+QByteArray DecoderPool::key(const QString &decoderName, void *avctx, const QVariantHash &options)
+{
+    const AVCodecContext *ctx = (const AVCodecContext*)avctx;
+    if (!ctx)
+        return QByteArray();
+    QByteArray k;
+    QDataStream ds(&k, QIODevice::WriteOnly);
+    ds << decoderName
+       << (qint32)ctx->codec_type << (qint32)ctx->codec_id << (qint32)ctx->codec_tag
+       << (qint32)ctx->profile << (qint32)ctx->level;
+    // time_base is used to compute the output timestamps
+    ds << (qint32)ctx->time_base.num << (qint32)ctx->time_base.den;
+    if (ctx->codec_type == AVMEDIA_TYPE_VIDEO)
+        ds << (qint32)ctx->width << (qint32)ctx->height << (qint32)ctx->pix_fmt;
+    else if (ctx->codec_type == AVMEDIA_TYPE_AUDIO)
+        ds << (qint32)ctx->sample_rate << (qint32)ctx->sample_fmt << (qint32)ctx->channels << (quint64)ctx->channel_layout;
+    // extradata (e.g. avcC, AudioSpecificConfig) is used to init the decoder
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (ctx->extradata && ctx->extradata_size > 0)
+        hash.addData((const char*)ctx->extradata, ctx->extradata_size);
+    QByteArray opt;
+    QDataStream ds_opt(&opt, QIODevice::WriteOnly);
+    ds_opt << toStableVariant(options);
+    hash.addData(opt);
+    ds << hash.result();
+    return k;
+}
+
+void DecoderPool::setCapacity(int value)
+{
+    DPTR_D(DecoderPool);
+    QList<AVDecoder*> evicted;
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        d.capacity = qMax(0, value);
+        while (d.entries.size() > d.capacity)
+            evicted.append(d.entries.takeFirst().decoder);
+    }
+    qDeleteAll(evicted);
+}
+
+int DecoderPool::capacity() const
+{
+    DPTR_D(const DecoderPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.capacity;
+}
+
+int DecoderPool::size() const
+{
+    DPTR_D(const DecoderPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.entries.size();
+}
+
+void DecoderPool::clear()
+{
+    DPTR_D(DecoderPool);
+    QList<DecoderPoolPrivate::Entry> entries;
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        entries.swap(d.entries);
+    }
+    foreach (const DecoderPoolPrivate::Entry& e, entries) {
+        delete e.decoder;
+    }
+}
+
+AVDecoder* DecoderPool::take(const QByteArray &key)
+{
+    DPTR_D(DecoderPool);
+    if (key.isEmpty())
+        return 0;
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    for (int i = d.entries.size() - 1; i >= 0; --i) {
+        if (d.entries.at(i).key != key)
+            continue;
+        d.hits++;
+        AVDecoder *dec = d.entries.takeAt(i).decoder;
+        // no thread affinity in pool. pull to the thread using it
+        if (!dec->thread())
+            dec->moveToThread(QThread::currentThread());
+        return dec;
+    }
+    d.misses++;
+    return 0;
+}
+
+void DecoderPool::put(AVDecoder *decoder, const QByteArray &key)
+{
+    if (!decoder)
+        return;
+    DPTR_D(DecoderPool);
+    decoder->disconnect();
+    if (key.isEmpty() || !decoder->isOpen()) {
+        delete decoder;
+        return;
+    }
+    decoder->flush(); // drop buffered frames of the previous source. worker threads are kept
+    // a pooled decoder can be taken in any thread. an object without thread affinity can be pulled by take()
+    if (decoder->thread() == QThread::currentThread())
+        decoder->moveToThread(0);
+    AVDecoder *evicted = decoder;
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        if (d.capacity > 0) {
+            evicted = d.entries.size() >= d.capacity ? d.entries.takeFirst().decoder : 0;
+            DecoderPoolPrivate::Entry e;
+            e.key = key;
+            e.decoder = decoder;
+            d.entries.append(e);
+        }
+    }
+    delete evicted;
+}
+
+int DecoderPool::hits() const
+{
+    DPTR_D(const DecoderPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.hits;
+}
+
+int DecoderPool::misses() const
+{
+    DPTR_D(const DecoderPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.misses;
+}
+} //namespace QtAV
@@ -75,6 +75,7 @@ public:
     }
 
     AVFrame *frame; //set once and not change
+    AudioFormat format; // format of the last frame. reused if not changed
 };
 
 AudioDecoderId AudioDecoderFFmpeg::id() const
@@ -162,14 +163,19 @@ bool AudioDecoderFFmpeg::decode(const Packet &packet)
 AudioFrame AudioDecoderFFmpeg::frame()
 {
     DPTR_D(AudioDecoderFFmpeg);
-    AudioFormat fmt;
-    fmt.setSampleFormatFFmpeg(d.frame->format);
-    fmt.setChannelLayoutFFmpeg(d.frame->channel_layout);
-    fmt.setSampleRate(d.frame->sample_rate);
-    if (!fmt.isValid()) {// need more data to decode to get a frame
+    if (d.format.sampleFormatFFmpeg() != d.frame->format
+            || d.format.channelLayoutFFmpeg() != (qint64)d.frame->channel_layout
+            || d.format.sampleRate() != d.frame->sample_rate) {
+        AudioFormat fmt;
+        fmt.setSampleFormatFFmpeg(d.frame->format);
+        fmt.setChannelLayoutFFmpeg(d.frame->channel_layout);
+        fmt.setSampleRate(d.frame->sample_rate);
+        d.format = fmt;
+    }
+    if (!d.format.isValid()) {// need more data to decode to get a frame
         return AudioFrame();
     }
-    AudioFrame f(fmt);
+    AudioFrame f(d.format);
     //av_frame_get_pkt_duration ffmpeg
     f.setBits(d.frame->extended_data); // TODO: ref
     f.setBytesPerLine(d.frame->linesize[0], 0); // for correct alignment
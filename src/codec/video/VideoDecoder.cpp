@@ -122,4 +122,44 @@ QString VideoDecoder::name() const
 {
     return QLatin1String(VideoDecoder::name(id()));
 }
+
+void VideoDecoder::setDiscardLevel(DiscardLevel frames, DiscardLevel loopFilter, DiscardLevel idct)
+{
+    DPTR_D(VideoDecoder);
+    AVCodecContext *ctx = d.codec_ctx;
+    if (!ctx)
+        return;
+    // no option lookup. decoders read the fields for every packet
+    // DiscardDefault restores the value from options(), and a level never discards less than options()
+    ctx->skip_frame = (AVDiscard)(frames == DiscardDefault ? d.skip_frame : qMax<int>(frames, d.skip_frame));
+    ctx->skip_loop_filter = (AVDiscard)(loopFilter == DiscardDefault ? d.skip_loop_filter : qMax<int>(loopFilter, d.skip_loop_filter));
+    ctx->skip_idct = (AVDiscard)(idct == DiscardDefault ? d.skip_idct : qMax<int>(idct, d.skip_idct));
+}
+
+void VideoDecoder::slowDiscardLevel(int nbSlow, int nbFrameDrop, int nbSkip, DiscardLevel *frames, DiscardLevel *loopFilter)
+{
+    if (nbSlow < nbFrameDrop) {
+        *frames = DiscardDefault;
+        *loopFilter = DiscardDefault;
+        return;
+    }
+    switch ((nbSlow - nbFrameDrop)/qMax(1, (nbSkip - nbFrameDrop)/3)) {
+    case 0:
+        *frames = DiscardNonRef;
+        *loopFilter = DiscardDefault;
+        break;
+    case 1:
+        *frames = DiscardNonRef;
+        *loopFilter = DiscardBidir;
+        break;
+    case 2:
+        *frames = DiscardBidir;
+        *loopFilter = DiscardNonKey;
+        break;
+    default:
+        *frames = DiscardNonKey;
+        *loopFilter = DiscardNonKey;
+        break;
+    }
+}
 } //namespace QtAV
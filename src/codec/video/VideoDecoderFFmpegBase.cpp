@@ -168,6 +168,17 @@ VideoFrame VideoDecoderFFmpegBase::frame()
     // in s. TODO: what about AVFrame.pts? av_frame_get_best_effort_timestamp? move to VideoFrame::from(AVFrame*)
     frame.setTimestamp((double)d.frame->best_effort_timestamp/1000.0);
     frame.setMetaData(QStringLiteral("avbuf"), QVariant::fromValue(AVFrameBuffersRef(new AVFrameBuffers(d.frame))));
+    // used by deinterlacers
+#ifdef AV_FRAME_FLAG_INTERLACED
+    const bool interlaced = !!(d.frame->flags & AV_FRAME_FLAG_INTERLACED);
+    const bool tff = !!(d.frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST);
+#else
+    const bool interlaced = !!d.frame->interlaced_frame;
+    const bool tff = !!d.frame->top_field_first;
+#endif
+    frame.setMetaData(QStringLiteral("interlaced"), interlaced);
+    if (interlaced)
+        frame.setMetaData(QStringLiteral("top_field_first"), tff);
     d.updateColorDetails(&frame);
     if (frame.format().hasPalette()) {
         frame.setMetaData(QStringLiteral("pallete"), QByteArray((const char*)d.frame->data[1], 256*4));
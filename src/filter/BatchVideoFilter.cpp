@@ -0,0 +1,312 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/BatchVideoFilter.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include "QtAV/private/Filter_p.h"
+#include "utils/Logger.h"
+
+namespace QtAV {
+
+class BatchVideoFilterPrivate;
+class BatchWorker : public QThread
+{
+public:
+    BatchWorker(BatchVideoFilterPrivate* p) : d(p) {}
+protected:
+    void run() Q_DECL_OVERRIDE;
+private:
+    BatchVideoFilterPrivate *d;
+};
+
+class BatchVideoFilterPrivate Q_DECL_FINAL : public VideoFilterPrivate
+{
+public:
+    BatchVideoFilterPrivate()
+        : q(0)
+        , batch_size(8)
+        , interval(0)
+        , queue_size(32)
+        , policy(BatchVideoFilter::DropOldest)
+        , stopping(false)
+        , finishing(false)
+        , serial(0)
+        , dropped(0)
+        , worker(this)
+    {}
+    void run();
+
+    BatchVideoFilter *q;
+    int batch_size;
+    int interval;
+    int queue_size;
+    BatchVideoFilter::OverflowPolicy policy;
+    bool stopping;
+    bool finishing;
+    int serial; // increased by flush() to drop the incomplete batch in worker
+    qint64 dropped;
+    mutable QMutex mutex;
+    QWaitCondition cond_empty; // worker waits for frames
+    QWaitCondition cond_full; // Block policy waits for worker
+    QQueue<VideoFrame> queue;
+    BatchWorker worker;
+};
+
+void BatchWorker::run()
+{
+    d->run();
+}
+
+void BatchVideoFilterPrivate::run()
+{
+    QList<VideoFrame> batch;
+    QElapsedTimer timer; // started when the first frame of batch arrives
+    int batch_serial = 0;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        batch_serial = serial;
+    }
+    while (true) {
+        bool end = false;
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            while (!stopping && !finishing && queue.isEmpty()) {
+                if (batch.isEmpty() || interval <= 0) {
+                    cond_empty.wait(&mutex);
+                    continue;
+                }
+                const qint64 remain = interval - timer.elapsed();
+                if (remain <= 0)
+                    break;
+                cond_empty.wait(&mutex, (unsigned long)remain);
+            }
+            if (stopping)
+                break;
+            if (batch_serial != serial) {
+                batch.clear();
+                batch_serial = serial;
+            }
+            while (!queue.isEmpty() && batch.size() < batch_size) {
+                if (batch.isEmpty())
+                    timer.start();
+                batch.append(queue.dequeue());
+            }
+            cond_full.wakeAll();
+            end = finishing && queue.isEmpty();
+            if (end)
+                finishing = false;
+            const bool timeout = interval > 0 && !batch.isEmpty() && timer.elapsed() >= interval;
+            if (batch.size() < batch_size && !timeout && !end)
+                continue;
+        }
+        if (!batch.isEmpty())
+            q->processBatch(batch);
+        batch.clear();
+        if (end)
+            Q_EMIT q->finished();
+    }
+}
+
+BatchVideoFilter::BatchVideoFilter(QObject *parent)
+    : VideoFilter(*new BatchVideoFilterPrivate(), parent)
+{
+    DPTR_D(BatchVideoFilter);
+    d.q = this;
+}
+
+BatchVideoFilter::~BatchVideoFilter()
+{
+    stop();
+}
+
+void BatchVideoFilter::setBatchSize(int value)
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.batch_size = qMax(1, value);
+}
+
+int BatchVideoFilter::batchSize() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().batch_size;
+}
+
+void BatchVideoFilter::setBatchInterval(int value)
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.interval = qMax(0, value);
+    d.cond_empty.wakeAll();
+}
+
+int BatchVideoFilter::batchInterval() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().interval;
+}
+
+void BatchVideoFilter::setQueueSize(int value)
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.queue_size = qMax(1, value);
+    d.cond_full.wakeAll();
+}
+
+int BatchVideoFilter::queueSize() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().queue_size;
+}
+
+void BatchVideoFilter::setOverflowPolicy(OverflowPolicy value)
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.policy = value;
+    d.cond_full.wakeAll();
+}
+
+BatchVideoFilter::OverflowPolicy BatchVideoFilter::overflowPolicy() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().policy;
+}
+
+qint64 BatchVideoFilter::droppedFrames() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().dropped;
+}
+
+void BatchVideoFilter::flush()
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.queue.clear();
+    d.finishing = false;
+    d.serial++;
+    d.cond_full.wakeAll();
+}
+
+void BatchVideoFilter::endOfStream()
+{
+    finish();
+}
+
+void BatchVideoFilter::finish()
+{
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (!d.worker.isRunning()) {
+        if (d.queue.isEmpty()) {
+            lock.unlock();
+            Q_EMIT finished();
+            return;
+        }
+        d.worker.start();
+    }
+    d.finishing = true;
+    d.cond_empty.wakeAll();
+}
+
+void BatchVideoFilter::stop()
+{
+    DPTR_D(BatchVideoFilter);
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        d.stopping = true;
+        d.cond_empty.wakeAll();
+        d.cond_full.wakeAll();
+    }
+    d.worker.wait();
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.queue.clear();
+    d.finishing = false;
+    d.stopping = false;
+}
+
+void BatchVideoFilter::processBatch(const QList<VideoFrame> &frames)
+{
+    Q_UNUSED(frames);
+}
+
+void BatchVideoFilter::addResult(qreal timestamp, const QVariant &result)
+{
+    Q_EMIT resultReady(timestamp, result);
+}
+
+void BatchVideoFilter::process(Statistics *statistics, VideoFrame *frame)
+{
+    Q_UNUSED(statistics);
+    if (!frame || !frame->isValid())
+        return;
+    DPTR_D(BatchVideoFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.stopping)
+        return;
+    if (!d.worker.isRunning())
+        d.worker.start();
+    if (d.queue.size() >= d.queue_size) {
+        if (d.policy == DropNewest) {
+            d.dropped++;
+            return;
+        }
+        if (d.policy == DropOldest) {
+            d.queue.dequeue();
+            d.dropped++;
+        } else {
+            while (d.queue.size() >= d.queue_size && d.policy == Block && !d.stopping)
+                d.cond_full.wait(&d.mutex);
+            if (d.stopping)
+                return;
+            while (d.queue.size() >= d.queue_size) { // policy changed while waiting
+                d.queue.dequeue();
+                d.dropped++;
+            }
+        }
+    }
+    d.queue.enqueue(*frame);
+    d.cond_empty.wakeOne();
+}
+
+} //namespace QtAV
@@ -0,0 +1,571 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/DeinterlaceFilter.h"
+#include <limits.h> //INT_MAX
+#include <stdint.h>
+#include <string.h> //memcpy
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include "QtAV/private/Filter_p.h"
+#include "QtAV/Statistics.h"
+#include "QtAV/VideoFrame.h"
+#include "utils/GPUMemCopy.h"
+#include "utils/Logger.h"
+
+#ifndef Q_PROCESSOR_X86 // qt4
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64)
+#define Q_PROCESSOR_X86
+#endif
+#endif
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+int DeintAvgRow8_SSE2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count);
+int DeintAvgRow16_SSE2(const uint16_t *a, const uint16_t *b, uint16_t *dst, int count);
+int DeintBlendRow8_SSE2(const uint8_t *a, const uint8_t *c, const uint8_t *b, uint8_t *dst, int count);
+int DeintBlendRow16_SSE2(const uint16_t *a, const uint16_t *c, const uint16_t *b, uint16_t *dst, int count);
+int DeintELARow8_SSE2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width);
+#endif
+
+Q_GLOBAL_STATIC(QThreadPool, deinterlaceThreadPool)
+
+namespace {
+struct DeintPlane {
+    const uchar *src;
+    uchar *dst;
+    int src_stride, dst_stride;
+    int height;
+    int count; // samples per row
+    bool ela; // single channel plane, i.e. luma
+};
+
+struct DeintJob {
+    DeinterlaceFilter::Mode mode;
+    int parity; // rows of the field to keep. 0: top field
+    bool sse2;
+    int nb_planes;
+    DeintPlane planes[4];
+};
+
+// the same rounding as _mm_avg_epu8/16
+template<typename T> inline T avg(T a, T b) { return T((int(a) + int(b) + 1) >> 1); }
+template<typename T> inline int absdiff(T a, T b) { return a > b ? int(a) - int(b) : int(b) - int(a); }
+
+// simd row kernels. return the number of samples processed
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+inline int simdAvgRow(const quint8 *a, const quint8 *b, quint8 *d, int n) { return DeintAvgRow8_SSE2(a, b, d, n);}
+inline int simdAvgRow(const quint16 *a, const quint16 *b, quint16 *d, int n) { return DeintAvgRow16_SSE2(a, b, d, n);}
+inline int simdBlendRow(const quint8 *a, const quint8 *c, const quint8 *b, quint8 *d, int n) { return DeintBlendRow8_SSE2(a, c, b, d, n);}
+inline int simdBlendRow(const quint16 *a, const quint16 *c, const quint16 *b, quint16 *d, int n) { return DeintBlendRow16_SSE2(a, c, b, d, n);}
+// x in [1, return value) is processed
+inline int simdELARow(const quint8 *a, const quint8 *b, quint8 *d, int w) { return DeintELARow8_SSE2(a, b, d, w);}
+inline int simdELARow(const quint16*, const quint16*, quint16*, int) { return 0;} // sse2 has no unsigned 16 bit min
+#else
+template<typename T> inline int simdAvgRow(const T*, const T*, T*, int) { return 0;}
+template<typename T> inline int simdBlendRow(const T*, const T*, const T*, T*, int) { return 0;}
+template<typename T> inline int simdELARow(const T*, const T*, T*, int) { return 0;}
+#endif
+
+// x in [x0, x1) of a row of width w
+template<typename T>
+void elaRow(const T *a, const T *b, T *d, int w, int x0, int x1)
+{
+    for (int x = x0; x < x1; ++x) {
+        const int xm = x > 0 ? x - 1 : x;
+        const int xp = x < w - 1 ? x + 1 : x;
+        const int dm = absdiff(a[xm], b[xp]);
+        const int d0 = absdiff(a[x], b[x]);
+        const int dp = absdiff(a[xp], b[xm]);
+        if (d0 <= dm && d0 <= dp)
+            d[x] = avg(a[x], b[x]);
+        else if (dm <= dp)
+            d[x] = avg(a[xm], b[xp]);
+        else
+            d[x] = avg(a[xp], b[xm]);
+    }
+}
+
+template<typename T>
+void processRows(const DeintJob& job, int plane, int y0, int y1)
+{
+    const DeintPlane &p = job.planes[plane];
+    const int n = p.count;
+#define SRC_ROW(Y) reinterpret_cast<const T*>(p.src + (Y)*p.src_stride)
+    for (int y = y0; y < y1; ++y) {
+        T *d = reinterpret_cast<T*>(p.dst + y*p.dst_stride);
+        const T *c = SRC_ROW(y);
+        if (job.mode == DeinterlaceFilter::LinearBlend) {
+            const T *a = SRC_ROW(qMax(y - 1, 0));
+            const T *b = SRC_ROW(qMin(y + 1, p.height - 1));
+            int x = job.sse2 ? simdBlendRow(a, c, b, d, n) : 0;
+            for (; x < n; ++x)
+                d[x] = avg(avg(a[x], b[x]), c[x]);
+            continue;
+        }
+        int ya = y - 1, yb = y + 1;
+        if (ya < 0)
+            ya = yb;
+        if (yb >= p.height)
+            yb = ya;
+        if ((y & 1) == job.parity || ya < 0 || yb >= p.height) { // line of current field, or only 1 line
+            memcpy(d, c, n*sizeof(T));
+            continue;
+        }
+        const T *a = SRC_ROW(ya);
+        const T *b = SRC_ROW(yb);
+        if (p.ela) {
+            const int x = job.sse2 ? simdELARow(a, b, d, n) : 0;
+            if (x > 1) {
+                elaRow(a, b, d, n, 0, 1);
+                elaRow(a, b, d, n, x, n);
+            } else {
+                elaRow(a, b, d, n, 0, n);
+            }
+            continue;
+        }
+        int x = job.sse2 ? simdAvgRow(a, b, d, n) : 0;
+        for (; x < n; ++x)
+            d[x] = avg(a[x], b[x]);
+    }
+#undef SRC_ROW
+}
+
+void processSlice(const DeintJob& job, bool word, int slice, int nb_slices)
+{
+    for (int i = 0; i < job.nb_planes; ++i) {
+        const int h = job.planes[i].height;
+        const int y0 = h*slice/nb_slices;
+        const int y1 = h*(slice + 1)/nb_slices;
+        if (word)
+            processRows<quint16>(job, i, y0, y1);
+        else
+            processRows<quint8>(job, i, y0, y1);
+    }
+}
+
+class DeintSliceTask : public QRunnable
+{
+public:
+    DeintSliceTask(const DeintJob *j, bool w, int s, int n, QSemaphore *sem)
+        : job(j), word(w), slice(s), nb_slices(n), done(sem)
+    {}
+    void run() Q_DECL_OVERRIDE {
+        processSlice(*job, word, slice, nb_slices);
+        done->release();
+    }
+private:
+    const DeintJob *job;
+    bool word;
+    int slice, nb_slices;
+    QSemaphore *done;
+};
+
+// inverse telecine
+static const int kCombThreshold = 20*20; // (c-a)*(c-b) of 8 bit samples
+static const int kCombedDenominator = 128; // a frame is combed if more than 1/128 samples are combed
+static const int kDupRatio = 4; // a duplicated frame differs at least 4 times less than the others in a cycle
+static const int kStaticDiff = 16; // average difference < 1 (8 bit). cadence can not be detected
+static const int kCycle = 5; // 3:2 pulldown. 4 film frames in 5 video frames
+
+// combed samples of the frame woven from the rows of the parity field of \a keep and the other rows of \a other
+template<typename T>
+int combCount(const uchar *keep, int keep_stride, const uchar *other, int other_stride, int w, int h, int parity, int shift)
+{
+    int n = 0;
+    for (int y = 1; y < h - 1; ++y) {
+        if ((y & 1) == parity)
+            continue;
+        const T *a = reinterpret_cast<const T*>(keep + (y - 1)*keep_stride);
+        const T *b = reinterpret_cast<const T*>(keep + (y + 1)*keep_stride);
+        const T *c = reinterpret_cast<const T*>(other + y*other_stride);
+        for (int x = 0; x < w; ++x) {
+            const int ca = (int(c[x]) >> shift) - (int(a[x]) >> shift);
+            const int cb = (int(c[x]) >> shift) - (int(b[x]) >> shift);
+            if (ca*cb > kCombThreshold)
+                ++n;
+        }
+    }
+    return n;
+}
+
+// average absolute difference x16 of 8 bit samples. 1/4 samples are compared
+template<typename T>
+int frameDiff(const uchar *a, int a_stride, const uchar *b, int b_stride, int w, int h, int shift)
+{
+    qint64 sum = 0, n = 0;
+    for (int y = 0; y < h; y += 2) {
+        const T *ra = reinterpret_cast<const T*>(a + y*a_stride);
+        const T *rb = reinterpret_cast<const T*>(b + y*b_stride);
+        for (int x = 0; x < w; x += 2) {
+            sum += absdiff(T(ra[x] >> shift), T(rb[x] >> shift));
+            ++n;
+        }
+    }
+    return n ? int(sum*16/n) : 0;
+}
+} //namespace
+
+class DeinterlaceFilterPrivate Q_DECL_FINAL : public VideoFilterPrivate
+{
+public:
+    DeinterlaceFilterPrivate()
+        : mode(DeinterlaceFilter::EdgeAdaptive)
+        , field_order(DeinterlaceFilter::FieldOrderAuto)
+        , field_rate(false)
+        , interlaced_only(true)
+        , threads(0)
+        , prev_ts(-1)
+        , ivtc(false)
+        , cycle_pos(0)
+        , drop_phase(-1)
+        , min_phase(-1)
+    {
+        resetCadence();
+    }
+    void resetCadence() {
+        prev_in = VideoFrame();
+        prev_matched = VideoFrame();
+        cycle_pos = 0;
+        drop_phase = min_phase = -1;
+        for (int i = 0; i < kCycle; ++i)
+            cycle_diff[i] = 0;
+    }
+    /*!
+     * Weave the \a parity field of \a keep and the other field of prev_in if it has less combing. Measure the difference to the previous matched frame.
+     * \return invalid frame if it's still combed
+     */
+    VideoFrame matchFields(const VideoFrame& keep, int parity, bool word, int *diff);
+    // update the cadence with the difference of current frame. return true if it should be dropped
+    bool decimate(int diff);
+
+    DeinterlaceFilter::Mode mode;
+    DeinterlaceFilter::FieldOrder field_order;
+    bool field_rate;
+    bool interlaced_only;
+    int threads;
+    qreal prev_ts;
+    bool ivtc;
+    VideoFrame prev_in;
+    VideoFrame prev_matched;
+    int cycle_pos; // position of current frame in a cycle
+    int drop_phase; // cycle position of the duplicated frames. -1: cadence is not locked
+    int min_phase; // duplicated position of the last cycle
+    int cycle_diff[kCycle];
+};
+
+VideoFrame DeinterlaceFilterPrivate::matchFields(const VideoFrame &keep, int parity, bool word, int *diff)
+{
+    const VideoFormat fmt(keep.format());
+    const int shift = word ? fmt.bitsPerComponent() - 8 : 0;
+    const int w = fmt.bytesPerLine(keep.width(), 0)/(word ? 2 : 1); // samples of plane 0
+    const int h = keep.height();
+    bool use_prev = prev_in.isValid() && prev_in.format() == fmt && prev_in.size() == keep.size();
+    const int comb_c = word ? combCount<quint16>(keep.constBits(0), keep.bytesPerLine(0), keep.constBits(0), keep.bytesPerLine(0), w, h, parity, shift)
+                            : combCount<quint8>(keep.constBits(0), keep.bytesPerLine(0), keep.constBits(0), keep.bytesPerLine(0), w, h, parity, shift);
+    int comb = comb_c;
+    if (use_prev) {
+        const int comb_p = word ? combCount<quint16>(keep.constBits(0), keep.bytesPerLine(0), prev_in.constBits(0), prev_in.bytesPerLine(0), w, h, parity, shift)
+                                : combCount<quint8>(keep.constBits(0), keep.bytesPerLine(0), prev_in.constBits(0), prev_in.bytesPerLine(0), w, h, parity, shift);
+        use_prev = 4*comb_p < 3*comb_c; // prefer the current frame
+        if (use_prev)
+            comb = comb_p;
+    }
+    VideoFrame out(keep);
+    if (use_prev) {
+        int pitch[4];
+        for (int i = 0; i < keep.planeCount(); ++i)
+            pitch[i] = keep.bytesPerLine(i);
+        out = VideoFrame::allocate(fmt, keep.width(), keep.height(), pitch);
+        if (!out.isValid()) {
+            out = keep;
+            comb = comb_c;
+        } else {
+            for (int i = 0; i < keep.planeCount(); ++i) {
+                const int n = fmt.bytesPerLine(keep.planeWidth(i), i);
+                for (int y = 0; y < keep.planeHeight(i); ++y) {
+                    const VideoFrame &src = (y & 1) == parity ? keep : prev_in;
+                    memcpy(out.bits(i) + y*out.bytesPerLine(i), src.constBits(i) + y*src.bytesPerLine(i), n);
+                }
+            }
+        }
+    }
+    prev_in = keep;
+    *diff = INT_MAX;
+    if (prev_matched.isValid() && prev_matched.format() == fmt && prev_matched.size() == out.size()) {
+        *diff = word ? frameDiff<quint16>(out.constBits(0), out.bytesPerLine(0), prev_matched.constBits(0), prev_matched.bytesPerLine(0), w, h, shift)
+                     : frameDiff<quint8>(out.constBits(0), out.bytesPerLine(0), prev_matched.constBits(0), prev_matched.bytesPerLine(0), w, h, shift);
+    }
+    prev_matched = out;
+    if (comb*kCombedDenominator > w*h/2)
+        return VideoFrame();
+    return out;
+}
+
+bool DeinterlaceFilterPrivate::decimate(int diff)
+{
+    const int pos = cycle_pos;
+    cycle_pos = (cycle_pos + 1) % kCycle;
+    cycle_diff[pos] = diff;
+    bool drop = false;
+    if (pos == drop_phase) {
+        // the previous cycle is still in cycle_diff. cadence is broken if the frame is not duplicated, e.g. edited video
+        int others = INT_MAX;
+        for (int i = 0; i < kCycle; ++i) {
+            if (i != pos)
+                others = qMin(others, cycle_diff[i]);
+        }
+        drop = qint64(diff)*kDupRatio < others || others <= kStaticDiff;
+        if (!drop)
+            drop_phase = min_phase = -1;
+    }
+    if (pos != kCycle - 1)
+        return drop;
+    int m = 0;
+    for (int i = 1; i < kCycle; ++i) {
+        if (cycle_diff[i] < cycle_diff[m])
+            m = i;
+    }
+    int second = INT_MAX;
+    for (int i = 0; i < kCycle; ++i) {
+        if (i != m)
+            second = qMin(second, cycle_diff[i]);
+    }
+    if (second <= kStaticDiff) // no motion. keep the cadence
+        return drop;
+    if (qint64(cycle_diff[m])*kDupRatio >= second) { // no duplicated frame
+        drop_phase = min_phase = -1;
+        return drop;
+    }
+    // lock if the same position is duplicated in 2 cycles
+    if (m == min_phase)
+        drop_phase = m;
+    else
+        drop_phase = -1;
+    min_phase = m;
+    return drop;
+}
+
+DeinterlaceFilter::DeinterlaceFilter(QObject *parent)
+    : VideoFilter(*new DeinterlaceFilterPrivate(), parent)
+{
+}
+
+DeinterlaceFilter::Mode DeinterlaceFilter::mode() const
+{
+    return d_func().mode;
+}
+
+void DeinterlaceFilter::setMode(Mode value)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (d.mode == value)
+        return;
+    d.mode = value;
+    Q_EMIT modeChanged();
+}
+
+DeinterlaceFilter::FieldOrder DeinterlaceFilter::fieldOrder() const
+{
+    return d_func().field_order;
+}
+
+void DeinterlaceFilter::setFieldOrder(FieldOrder value)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (d.field_order == value)
+        return;
+    d.field_order = value;
+    Q_EMIT fieldOrderChanged();
+}
+
+void DeinterlaceFilter::setFieldRate(bool value)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (d.field_rate == value)
+        return;
+    d.field_rate = value;
+    Q_EMIT fieldRateChanged();
+}
+
+bool DeinterlaceFilter::isFieldRate() const
+{
+    return d_func().field_rate;
+}
+
+void DeinterlaceFilter::setInterlacedOnly(bool value)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (d.interlaced_only == value)
+        return;
+    d.interlaced_only = value;
+    Q_EMIT interlacedOnlyChanged();
+}
+
+bool DeinterlaceFilter::isInterlacedOnly() const
+{
+    return d_func().interlaced_only;
+}
+
+void DeinterlaceFilter::setInverseTelecine(bool value)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (d.ivtc == value)
+        return;
+    d.ivtc = value;
+    d.resetCadence();
+    Q_EMIT inverseTelecineChanged();
+}
+
+bool DeinterlaceFilter::isInverseTelecine() const
+{
+    return d_func().ivtc;
+}
+
+void DeinterlaceFilter::setThreads(int value)
+{
+    d_func().threads = qMax(0, value);
+}
+
+int DeinterlaceFilter::threads() const
+{
+    return d_func().threads;
+}
+
+void DeinterlaceFilter::flush()
+{
+    DPTR_D(DeinterlaceFilter);
+    d.prev_ts = -1;
+    d.resetCadence();
+}
+
+void DeinterlaceFilter::process(Statistics *statistics, VideoFrame *frame)
+{
+    DPTR_D(DeinterlaceFilter);
+    if (!frame || !frame->isValid() || !frame->constBits(0))
+        return;
+    const VideoFormat fmt(frame->format());
+    if (fmt.isHWAccelerated() || fmt.isBitStream() || fmt.hasPalette())
+        return;
+    // 16 bit samples can be averaged only if every component is 16 bit
+    bool word = false;
+    if (fmt.bitsPerComponent() > 8 && fmt.bitsPerComponent() <= 16 && !fmt.isBigEndian() && fmt.bytesPerPixel(0) == 2*fmt.channels(0))
+        word = true;
+    else if (fmt.bitsPerComponent() != 8)
+        return;
+    const qreal ts = frame->timestamp();
+    qreal dt = ts - d.prev_ts;
+    if (d.prev_ts < 0 || dt <= 0 || dt > 0.5) {
+        dt = 0.04;
+        if (statistics && statistics->video.frame_rate > 0)
+            dt = 1.0/statistics->video.frame_rate;
+    }
+    d.prev_ts = ts;
+    bool tff = d.field_order == TopFieldFirst;
+    if (d.field_order == FieldOrderAuto) {
+        const QVariant v(frame->metaData(QStringLiteral("top_field_first")));
+        tff = !v.isValid() || v.toBool();
+    }
+    qreal out_ts = ts;
+    if (d.ivtc) {
+        int diff = 0;
+        const VideoFrame matched(d.matchFields(*frame, tff ? 0 : 1, word, &diff));
+        if (d.decimate(diff)) {
+            discardFrame();
+            return;
+        }
+        if (d.drop_phase >= 0) {
+            // 4 frames after the dropped frame in dt*5 seconds
+            const int p = (d.cycle_pos - d.drop_phase - 2 + 2*kCycle) % kCycle; // cycle_pos is the next position
+            out_ts = ts + qreal(p)*dt/4.0;
+        }
+        if (matched.isValid()) {
+            VideoFrame out(matched);
+            if (out.constBits(0) != frame->constBits(0)) { // woven with the previous frame
+                out.setDisplayAspectRatio(frame->displayAspectRatio());
+                out.setColorSpace(frame->colorSpace());
+                out.setColorRange(frame->colorRange());
+            }
+            out.setTimestamp(out_ts);
+            out.setMetaData(QStringLiteral("interlaced"), false);
+            *frame = out;
+            return;
+        }
+        // combed. deinterlace 1 frame
+    } else {
+        const QVariant interlaced(frame->metaData(QStringLiteral("interlaced")));
+        if (d.interlaced_only && interlaced.isValid() && !interlaced.toBool())
+            return;
+    }
+
+    DeintJob job;
+    job.mode = d.mode;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    job.sse2 = detect_sse2();
+#else
+    job.sse2 = false;
+#endif
+    job.nb_planes = qMin(frame->planeCount(), 4);
+    int pitch[4] = {0};
+    for (int i = 0; i < job.nb_planes; ++i) {
+        pitch[i] = frame->bytesPerLine(i);
+    }
+    int nb_slices = d.threads > 0 ? d.threads : QThread::idealThreadCount();
+    nb_slices = qBound(1, nb_slices, qMax(1, frame->height()/32)); // too small slices are slower
+    const int nb_out = d.mode != LinearBlend && d.field_rate && !d.ivtc ? 2 : 1;
+    for (int f = 0; f < nb_out; ++f) {
+        // every row is written by the slices
+        VideoFrame out(VideoFrame::allocate(fmt, frame->width(), frame->height(), pitch));
+        if (!out.isValid())
+            return;
+        for (int i = 0; i < job.nb_planes; ++i) {
+            DeintPlane &p = job.planes[i];
+            p.src = frame->constBits(i);
+            p.src_stride = frame->bytesPerLine(i);
+            p.dst = out.bits(i);
+            p.dst_stride = out.bytesPerLine(i);
+            p.height = frame->planeHeight(i);
+            p.count = fmt.bytesPerLine(frame->planeWidth(i), i)/(word ? 2 : 1);
+            p.ela = i == 0 && fmt.channels(0) == 1 && d.mode == EdgeAdaptive;
+        }
+        // top field is the even lines
+        job.parity = (tff ? 0 : 1) ^ f;
+        QSemaphore done;
+        for (int s = 1; s < nb_slices; ++s)
+            deinterlaceThreadPool()->start(new DeintSliceTask(&job, word, s, nb_slices, &done));
+        processSlice(job, word, 0, nb_slices);
+        done.acquire(nb_slices - 1);
+
+        out.setTimestamp(out_ts + qreal(f)*dt/2.0);
+        out.setDisplayAspectRatio(frame->displayAspectRatio());
+        out.setColorSpace(frame->colorSpace());
+        out.setColorRange(frame->colorRange());
+        out.setMetaData(QStringLiteral("interlaced"), false);
+        if (nb_out == 1)
+            *frame = out;
+        else
+            addOutputFrame(out);
+    }
+}
+
+} //namespace QtAV
@@ -0,0 +1,115 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <emmintrin.h>
+
+/*
+ * Row kernels of DeinterlaceFilter. Rounding is the same as _mm_avg_epu8/16: (x + y + 1) >> 1, so the scalar code in
+ * DeinterlaceFilter.cpp gives exactly the same results.
+ * Functions return the number of samples processed. Remaining samples are processed by the caller.
+ */
+namespace QtAV {
+
+// dst = avg(a, b)
+int DeintAvgRow8_SSE2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count)
+{
+    const int n = count & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu8(x, y));
+    }
+    return n;
+}
+
+int DeintAvgRow16_SSE2(const uint16_t *a, const uint16_t *b, uint16_t *dst, int count)
+{
+    const int n = count & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu16(x, y));
+    }
+    return n;
+}
+
+// vertical [1 2 1] low pass: dst = avg(avg(a, b), c), a, b: neighbour rows, c: current row
+int DeintBlendRow8_SSE2(const uint8_t *a, const uint8_t *c, const uint8_t *b, uint8_t *dst, int count)
+{
+    const int n = count & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        const __m128i z = _mm_loadu_si128((const __m128i*)(c + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu8(_mm_avg_epu8(x, y), z));
+    }
+    return n;
+}
+
+int DeintBlendRow16_SSE2(const uint16_t *a, const uint16_t *c, const uint16_t *b, uint16_t *dst, int count)
+{
+    const int n = count & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        const __m128i z = _mm_loadu_si128((const __m128i*)(c + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu16(_mm_avg_epu16(x, y), z));
+    }
+    return n;
+}
+
+static inline __m128i absdiff_epu8(__m128i x, __m128i y)
+{
+    return _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+}
+
+/*
+ * edge-based line average: interpolate along the direction (-1, 0, +1) with the minimal difference between the row above(a) and below(b).
+ * x in [1, return value) is processed. the caller processes x == 0 and the rest
+ */
+int DeintELARow8_SSE2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int width)
+{
+    int x = 1;
+    for (; x + 16 <= width - 1; x += 16) {
+        const __m128i am = _mm_loadu_si128((const __m128i*)(a + x - 1));
+        const __m128i a0 = _mm_loadu_si128((const __m128i*)(a + x));
+        const __m128i ap = _mm_loadu_si128((const __m128i*)(a + x + 1));
+        const __m128i bm = _mm_loadu_si128((const __m128i*)(b + x - 1));
+        const __m128i b0 = _mm_loadu_si128((const __m128i*)(b + x));
+        const __m128i bp = _mm_loadu_si128((const __m128i*)(b + x + 1));
+        const __m128i dm = absdiff_epu8(am, bp);
+        const __m128i d0 = absdiff_epu8(a0, b0);
+        const __m128i dp = absdiff_epu8(ap, bm);
+        const __m128i mn = _mm_min_epu8(d0, _mm_min_epu8(dm, dp));
+        // prefer vertical, then -1
+        const __m128i m0 = _mm_cmpeq_epi8(d0, mn);
+        const __m128i mm = _mm_andnot_si128(m0, _mm_cmpeq_epi8(dm, mn));
+        const __m128i v = _mm_or_si128(_mm_and_si128(m0, _mm_avg_epu8(a0, b0)),
+                          _mm_or_si128(_mm_and_si128(mm, _mm_avg_epu8(am, bp)),
+                                       _mm_andnot_si128(_mm_or_si128(m0, mm), _mm_avg_epu8(ap, bm))));
+        _mm_storeu_si128((__m128i*)(dst + x), v);
+    }
+    return x;
+}
+
+} //namespace QtAV
+#endif
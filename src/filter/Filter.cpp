@@ -24,6 +24,7 @@
 #include "QtAV/Statistics.h"
 #include "QtAV/AVOutput.h"
 #include "QtAV/AVPlayer.h"
+#include "QtAV/VideoFrame.h"
 #include "filter/FilterManager.h"
 #include "utils/Logger.h"
 
@@ -177,9 +178,47 @@ bool VideoFilter::prepareContext(VideoFilterContext *&ctx, Statistics *statistic
     return true;
 }
 
-void VideoFilter::apply(Statistics *statistics, VideoFrame *frame)
+bool VideoFilter::apply(Statistics *statistics, VideoFrame *frame)
 {
+    DPTR_D(VideoFilter);
     process(statistics, frame);
+    if (!d.replace_input)
+        return true;
+    // only 1 frame can be returned. rate changing filters should use apply(statistics, frame, outFrames)
+    const bool has_output = !d.out_frames.isEmpty();
+    if (frame)
+        *frame = has_output ? d.out_frames.first() : VideoFrame();
+    d.out_frames.clear();
+    d.replace_input = false;
+    return has_output;
+}
+
+int VideoFilter::apply(Statistics *statistics, const VideoFrame &frame, QList<VideoFrame> &outFrames)
+{
+    DPTR_D(VideoFilter);
+    VideoFrame f(frame);
+    process(statistics, &f);
+    if (!d.replace_input) {
+        outFrames.append(f);
+        return 1;
+    }
+    const int n = d.out_frames.size();
+    outFrames.append(d.out_frames);
+    d.out_frames.clear();
+    d.replace_input = false;
+    return n;
+}
+
+void VideoFilter::addOutputFrame(const VideoFrame &frame)
+{
+    DPTR_D(VideoFilter);
+    d.replace_input = true;
+    d.out_frames.append(frame);
+}
+
+void VideoFilter::discardFrame()
+{
+    d_func().replace_input = true;
 }
 
 } //namespace QtAV
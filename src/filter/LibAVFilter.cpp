@@ -26,6 +26,7 @@
 #include "QtAV/AudioFrame.h"
 #include "QtAV/VideoFrame.h"
 #include "QtAV/private/AVCompat.h"
+#include "QtAV/private/AVDecoder_p.h"
 #include "utils/internal.h"
 #include "utils/Logger.h"
 
@@ -38,6 +39,7 @@
 // TODO: filter_complex
 // NO COPY in push/pull
 #define QTAV_HAVE_av_buffersink_get_frame (LIBAV_MODULE_CHECK(LIBAVFILTER, 4, 2, 0) || FFMPEG_MODULE_CHECK(LIBAVFILTER, 3, 79, 100)) //3.79.101: ff2.0.4
+#define QTAV_HAVE_av_buffersink_get_time_base (LIBAV_MODULE_CHECK(LIBAVFILTER, 7, 0, 0) || FFMPEG_MODULE_CHECK(LIBAVFILTER, 6, 72, 100)) //ff3.3
 
 namespace QtAV {
 
@@ -78,6 +80,8 @@ class LibAVFilter::Private
 public:
     Private()
         : avframe(0)
+        , threads(0)
+        , thread_type(LibAVFilter::SliceThreading)
         , status(LibAVFilter::NotConfigured)
     {
 #if QTAV_HAVE(AVFILTER)
@@ -116,6 +120,9 @@ public:
 #if QTAV_HAVE(AVFILTER)
         avfilter_graph_free(&filter_graph);
         filter_graph = avfilter_graph_alloc();
+        // MUST be set before adding filters
+        filter_graph->nb_threads = threads;
+        filter_graph->thread_type = thread_type == LibAVFilter::SliceThreading ? AVFILTER_THREAD_SLICE : 0;
         //QString sws_flags_str;
         // pixel_aspect==sar, pixel_aspect is more compatible
         QString buffersrc_args = args;
@@ -179,12 +186,25 @@ public:
         return false;
     }
 #if QTAV_HAVE(AVFILTER)
+    // in seconds. the sink time base can differ from the source 1/1000000, e.g. yadif=1 halves it, fps uses 1/rate
+    qreal timestamp(qint64 pts) const {
+        AVRational tb = {1, 1000000};
+#if QTAV_HAVE_av_buffersink_get_time_base
+        tb = av_buffersink_get_time_base(out_filter_ctx);
+#else
+        if (out_filter_ctx && out_filter_ctx->nb_inputs > 0)
+            tb = out_filter_ctx->inputs[0]->time_base;
+#endif //QTAV_HAVE_av_buffersink_get_time_base
+        return qreal(pts)*av_q2d(tb);
+    }
     AVFilterGraph *filter_graph;
     AVFilterContext *in_filter_ctx;
     AVFilterContext *out_filter_ctx;
 #endif //QTAV_HAVE(AVFILTER)
     AVFrame *avframe;
     QString options;
+    int threads;
+    LibAVFilter::ThreadType thread_type;
     LibAVFilter::Status status;
 };
 
@@ -246,6 +266,36 @@ LibAVFilter::Status LibAVFilter::status() const
     return priv->status;
 }
 
+void LibAVFilter::setThreads(int value)
+{
+    if (value < 0)
+        value = 0;
+    if (priv->threads == value)
+        return;
+    priv->threads = value;
+    if (priv->status == ConfigureOk)
+        priv->status = NotConfigured;
+}
+
+int LibAVFilter::threads() const
+{
+    return priv->threads;
+}
+
+void LibAVFilter::setThreadType(ThreadType value)
+{
+    if (priv->thread_type == value)
+        return;
+    priv->thread_type = value;
+    if (priv->status == ConfigureOk)
+        priv->status = NotConfigured;
+}
+
+LibAVFilter::ThreadType LibAVFilter::threadType() const
+{
+    return priv->thread_type;
+}
+
 bool LibAVFilter::pushVideoFrame(Frame *frame, bool changed)
 {
     return priv->pushVideoFrame(frame, changed, sourceArguments());
@@ -267,7 +317,9 @@ void* LibAVFilter::pullFrameHolder()
     int ret = av_buffersink_read(priv->out_filter_ctx, holder->bufferRef());
 #endif //QTAV_HAVE_av_buffersink_get_frame
     if (ret < 0) {
-        qWarning("av_buffersink_get_frame error: %s", av_err2str(ret));
+        // EAGAIN: need more input, e.g. the 1st frame for yadif, or frames dropped by select, fps
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            qWarning("av_buffersink_get_frame error: %s", av_err2str(ret));
         delete holder;
         return 0;
     }
@@ -350,23 +402,35 @@ void LibAVFilterVideo::process(Statistics *statistics, VideoFrame *frame)
       //  emit statusChanged();
     if (!ok)
         return;
-
-    AVFrameHolderRef ref((AVFrameHolder*)pullFrameHolder());
-    if (!ref)
-        return;
-    const AVFrame *f = ref->frame();
-    VideoFrame vf(f->width, f->height, VideoFormat(f->format));
-    vf.setBits((quint8**)f->data);
-    vf.setBytesPerLine((int*)f->linesize);
-    vf.setMetaData(QStringLiteral("avframe_hoder_ref"), QVariant::fromValue(ref));
-    vf.setTimestamp(ref->frame()->pts/1000000.0); //pkt_pts?
-    //vf.setMetaData(frame->availableMetaData());
-    *frame = vf;
+    // N:M. the graph may output 0 frame (need more input, dropped), 1 frame or more (yadif=1, fps etc.)
+    discardFrame();
+    while (true) {
+        AVFrameHolderRef ref((AVFrameHolder*)pullFrameHolder());
+        if (!ref)
+            break;
+        const AVFrame *f = ref->frame();
+        VideoFrame vf(f->width, f->height, VideoFormat(f->format));
+        vf.setBits((quint8**)f->data);
+        vf.setBytesPerLine((int*)f->linesize);
+        vf.setMetaData(QStringLiteral("avframe_hoder_ref"), QVariant::fromValue(ref));
+        vf.setTimestamp(priv->timestamp(f->pts)); //pkt_pts?
+        vf.setColorSpace(frame->colorSpace());
+        vf.setColorRange(frame->colorRange());
+        //vf.setMetaData(frame->availableMetaData());
+        addOutputFrame(vf);
+    }
 #else
     Q_UNUSED(frame);
 #endif //QTAV_HAVE(AVFILTER)
 }
 
+void LibAVFilterVideo::flush()
+{
+    // frames buffered in graph are dropped. graph will be recreated for the next frame
+    if (priv->status == ConfigureOk)
+        priv->status = NotConfigured;
+}
+
 QString LibAVFilterVideo::sourceArguments() const
 {
     DPTR_D(const LibAVFilterVideo);
@@ -459,7 +523,7 @@ void LibAVFilterAudio::process(Statistics *statistics, AudioFrame *frame)
     af.setBytesPerLine(f->linesize[0], 0); // for correct alignment
     af.setSamplesPerChannel(f->nb_samples);
     af.setMetaData(QStringLiteral("avframe_hoder_ref"), QVariant::fromValue(ref));
-    af.setTimestamp(ref->frame()->pts/1000000.0); //pkt_pts?
+    af.setTimestamp(priv->timestamp(f->pts)); //pkt_pts?
     //af.setMetaData(frame->availableMetaData());
     *frame = af;
 #else
@@ -481,6 +545,19 @@ bool LibAVFilter::Private::pushVideoFrame(Frame *frame, bool changed, const QStr
     if (!vf->constBits(0)) {
         *vf = vf->to(vf->format());
     }
+    // frames from ffmpeg decoders hold refs of AVBufferRef. add a ref instead of copying planes
+    bool ref = false;
+#if QTAV_HAVE(AVBUFREF)
+    const QVariant v = vf->metaData(QStringLiteral("avbuf"));
+    if (v.isValid()) {
+        AVFrameBuffersRef buf = v.value<AVFrameBuffersRef>();
+        const uchar* planes[4] = { 0 };
+        const int nb_planes = qMin(vf->planeCount(), 4);
+        for (int i = 0; i < nb_planes; ++i)
+            planes[i] = vf->constBits(i);
+        ref = buf && buf->ref(avframe, planes, nb_planes);
+    }
+#endif //QTAV_HAVE(AVBUFREF)
     avframe->pts = frame->timestamp() * 1000000.0; // time_base is 1/1000000
     avframe->width = vf->width();
     avframe->height = vf->height();
@@ -490,6 +567,18 @@ bool LibAVFilter::Private::pushVideoFrame(Frame *frame, bool changed, const QStr
         avframe->linesize[i] = vf->bytesPerLine(i);
     }
     //TODO: side data for vf_codecview etc
+#if QTAV_HAVE(AVBUFREF)
+    if (ref) {
+        // the refs are moved to graph and avframe is reset
+        const int ret = av_buffersrc_add_frame_flags(in_filter_ctx, avframe, 0);
+        if (ret < 0) {
+            qWarning("av_buffersrc_add_frame_flags error: %s", av_err2str(ret));
+            av_frame_unref(avframe); // release the refs not taken by graph
+            return false;
+        }
+        return true;
+    }
+#endif //QTAV_HAVE(AVBUFREF)
     //int ret = av_buffersrc_add_frame_flags(in_filter_ctx, avframe, AV_BUFFERSRC_FLAG_KEEP_REF);
     /*
      * av_buffersrc_write_frame equals to av_buffersrc_add_frame_flags with AV_BUFFERSRC_FLAG_KEEP_REF.
@@ -0,0 +1,422 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/OverlayFilter.h"
+#include <stdint.h>
+#include <string.h>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include "QtAV/private/Filter_p.h"
+#include "QtAV/private/AVCompat.h"
+#include "QtAV/VideoFrame.h"
+#include "utils/GPUMemCopy.h"
+#include "utils/Logger.h"
+
+#ifndef Q_PROCESSOR_X86 // qt4
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64)
+#define Q_PROCESSOR_X86
+#endif
+#endif
+
+// ffmpeg3.0 151aa2e/ libav>11 2268db2
+#if AV_MODULE_CHECK(LIBAVUTIL, 55, 0, 0, 0, 100)
+#define DESC_VAL(X) (X)
+#define DESC_OFFSET(X) (X.offset)
+#else
+#define DESC_VAL(X) (X##_minus1 + 1)
+#define DESC_OFFSET(X) (X.offset_plus1) // only used to compare
+#endif
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+int OverlayBlendRow8_SSE2(const uint8_t *src, uint8_t *dst, const uint16_t *oa, const uint8_t *inv, int count);
+#endif
+
+namespace {
+struct OverlayLayout {
+    int depth;
+    int shift; // P010
+    int bytes; // bytes per sample
+    int log2_cw, log2_ch;
+    int plane_u, plane_v;
+    bool v_first;
+    bool interleaved() const { return plane_u == plane_v; }
+};
+
+bool getLayout(const VideoFormat& fmt, OverlayLayout* layout)
+{
+    if (!fmt.isValid() || fmt.isRGB() || fmt.hasPalette() || fmt.isHWAccelerated() || fmt.isBigEndian() || fmt.isBitStream())
+        return false;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)fmt.pixelFormatFFmpeg());
+    if (!desc || desc->nb_components < 3)
+        return false;
+    const AVComponentDescriptor &y = desc->comp[0];
+    const AVComponentDescriptor &u = desc->comp[1];
+    const AVComponentDescriptor &v = desc->comp[2];
+    const int depth = DESC_VAL(y.depth);
+    if (depth < 8 || depth > 16 || DESC_VAL(u.depth) != depth || DESC_VAL(v.depth) != depth)
+        return false;
+    if (y.shift != u.shift || y.shift != v.shift || depth + y.shift > 16)
+        return false;
+    const int bytes = depth > 8 ? 2 : 1;
+    if (y.plane != 0 || DESC_VAL(y.step) != bytes || u.plane == 0 || v.plane == 0)
+        return false;
+    const bool interleaved = u.plane == v.plane;
+    if (DESC_VAL(u.step) != (interleaved ? 2 : 1)*bytes || DESC_VAL(v.step) != DESC_VAL(u.step))
+        return false;
+    if (layout) {
+        layout->depth = depth;
+        layout->shift = y.shift;
+        layout->bytes = bytes;
+        layout->log2_cw = desc->log2_chroma_w;
+        layout->log2_ch = desc->log2_chroma_h;
+        layout->plane_u = u.plane;
+        layout->plane_v = v.plane;
+        layout->v_first = interleaved && DESC_OFFSET(v) < DESC_OFFSET(u);
+    }
+    return true;
+}
+
+// premultiplied overlay in a rect of a frame plane
+struct OverlayPlane {
+    int plane;
+    int x, y; // top left in samples. for interleaved chroma, x counts both u and v
+    int width, height; // in samples
+    // overlay value*alpha. value is in the frame's sample domain, i.e. depth and shift applied
+    QVector<quint16> oa; // 8 bit formats
+    QVector<quint32> oa_hi; // 9~16 bit formats
+    QVector<quint8> inv; // 255 - alpha
+    void resize(int bytes) {
+        if (bytes == 1)
+            oa.resize(width*height);
+        else
+            oa_hi.resize(width*height);
+        inv.resize(width*height);
+    }
+    void set(int i, quint32 value, int alpha) {
+        if (!oa.isEmpty())
+            oa[i] = quint16(value);
+        else
+            oa_hi[i] = value;
+        inv[i] = 255 - alpha;
+    }
+};
+
+// bounding rect of pixels with non-zero alpha
+QRect opaqueRect(const QImage& img)
+{
+    int left = img.width(), right = -1, top = img.height(), bottom = -1;
+    for (int y = 0; y < img.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        for (int x = 0; x < img.width(); ++x) {
+            if (!qAlpha(line[x]))
+                continue;
+            left = qMin(left, x);
+            right = qMax(right, x);
+            top = qMin(top, y);
+            bottom = qMax(bottom, y);
+        }
+    }
+    if (right < 0)
+        return QRect();
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+} //namespace
+
+class OverlayFilterPrivate Q_DECL_FINAL : public VideoFilterPrivate
+{
+public:
+    OverlayFilterPrivate()
+        : dirty(true)
+        , cache_format(-1)
+        , cache_width(0)
+        , cache_height(0)
+        , cache_cs(ColorSpace_Unknown)
+        , cache_range(ColorRange_Unknown)
+    {}
+    // called in process() with mutex locked
+    void updateCache(const VideoFrame& frame, const OverlayLayout& l) {
+        if (!dirty && cache_format == frame.format().pixelFormatFFmpeg()
+                && cache_width == frame.width() && cache_height == frame.height()
+                && cache_cs == frame.colorSpace() && cache_range == frame.colorRange())
+            return;
+        dirty = false;
+        cache_format = frame.format().pixelFormatFFmpeg();
+        cache_width = frame.width();
+        cache_height = frame.height();
+        cache_cs = frame.colorSpace();
+        cache_range = frame.colorRange();
+        planes.clear();
+        // area to blend in luma plane
+        const QRect r = QRect(opaque.topLeft() + pos, opaque.size()) & QRect(0, 0, frame.width(), frame.height());
+        if (r.isEmpty())
+            return;
+        qreal kr = 0.299, kb = 0.114;
+        if (cache_cs == ColorSpace_BT709 || (cache_cs == ColorSpace_Unknown && frame.height() > 576)) {
+            kr = 0.2126;
+            kb = 0.0722;
+        }
+        const qreal kg = 1.0 - kr - kb;
+        const qreal max = qreal((1 << l.depth) - 1);
+        const qreal scale = qreal(1 << (l.depth - 8));
+        qreal y_off = 0, y_scale = max/255.0, c_scale = max/255.0;
+        if (cache_range != ColorRange_Full) {
+            y_off = 16.0*scale;
+            y_scale = 219.0/255.0*scale;
+            c_scale = 224.0/255.0*scale;
+        }
+        const qreal center = qreal(1 << (l.depth - 1));
+        // overlay premultiplied pixel at frame position (x, y). 0 if outside the image
+#define OVERLAY_PIXEL(X, Y) (r.contains(X, Y) ? reinterpret_cast<const QRgb*>(image.constScanLine((Y) - pos.y()))[(X) - pos.x()] : 0)
+        // luma
+        OverlayPlane yp;
+        yp.plane = 0;
+        yp.x = r.x();
+        yp.y = r.y();
+        yp.width = r.width();
+        yp.height = r.height();
+        yp.resize(l.bytes);
+        for (int y = 0; y < yp.height; ++y) {
+            for (int x = 0; x < yp.width; ++x) {
+                const QRgb c = OVERLAY_PIXEL(r.x() + x, r.y() + y);
+                const int a = qAlpha(c);
+                const qreal luma = kr*qRed(c) + kg*qGreen(c) + kb*qBlue(c); // premultiplied
+                // (off + scale*luma/alpha)*alpha, alpha in [0, 255]
+                const int v = qBound(0, qRound(y_off*a + y_scale*luma*255.0), int(max)*a);
+                yp.set(y*yp.width + x, quint32(v) << l.shift, a);
+            }
+        }
+        planes.append(yp);
+        // chroma. average the premultiplied pixels in each chroma block
+        const int cx0 = r.left() >> l.log2_cw, cx1 = r.right() >> l.log2_cw;
+        const int cy0 = r.top() >> l.log2_ch, cy1 = r.bottom() >> l.log2_ch;
+        const int cw = cx1 - cx0 + 1;
+        const int ch = cy1 - cy0 + 1;
+        const qreal n = qreal(1 << (l.log2_cw + l.log2_ch));
+        const int comps = l.interleaved() ? 2 : 1;
+        OverlayPlane up, vp;
+        up.plane = l.plane_u;
+        vp.plane = l.plane_v;
+        up.x = vp.x = cx0*comps;
+        up.y = vp.y = cy0;
+        up.width = vp.width = cw*comps;
+        up.height = vp.height = ch;
+        up.resize(l.bytes);
+        if (!l.interleaved())
+            vp.resize(l.bytes);
+        for (int cy = 0; cy < ch; ++cy) {
+            for (int cx = 0; cx < cw; ++cx) {
+                qreal sr = 0, sg = 0, sb = 0, sa = 0;
+                for (int y = (cy0 + cy) << l.log2_ch; y < (cy0 + cy + 1) << l.log2_ch; ++y) {
+                    for (int x = (cx0 + cx) << l.log2_cw; x < (cx0 + cx + 1) << l.log2_cw; ++x) {
+                        const QRgb c = OVERLAY_PIXEL(x, y);
+                        sr += qRed(c);
+                        sg += qGreen(c);
+                        sb += qBlue(c);
+                        sa += qAlpha(c);
+                    }
+                }
+                const int a = qRound(sa/n);
+                const qreal luma = (kr*sr + kg*sg + kb*sb)/n;
+                const qreal cb = (sb/n - luma)/(2.0*(1.0 - kb));
+                const qreal cr = (sr/n - luma)/(2.0*(1.0 - kr));
+                const quint32 u = quint32(qBound(0, qRound(center*a + c_scale*cb*255.0), int(max)*a)) << l.shift;
+                const quint32 v = quint32(qBound(0, qRound(center*a + c_scale*cr*255.0), int(max)*a)) << l.shift;
+                const int i = cy*up.width + cx*comps;
+                if (l.interleaved()) {
+                    up.set(i, l.v_first ? v : u, a);
+                    up.set(i + 1, l.v_first ? u : v, a);
+                } else {
+                    up.set(i, u, a);
+                    vp.set(i, v, a);
+                }
+            }
+        }
+#undef OVERLAY_PIXEL
+        planes.append(up);
+        if (!l.interleaved())
+            planes.append(vp);
+    }
+
+    mutable QMutex mutex;
+    QImage image;
+    QRect opaque; // in image
+    QPoint pos;
+    bool dirty;
+    // cache parameters
+    int cache_format;
+    int cache_width, cache_height;
+    ColorSpace cache_cs;
+    ColorRange cache_range;
+    QVector<OverlayPlane> planes;
+};
+
+OverlayFilter::OverlayFilter(QObject *parent)
+    : VideoFilter(*new OverlayFilterPrivate(), parent)
+{
+}
+
+bool OverlayFilter::isFormatSupported(const VideoFormat &format)
+{
+    return getLayout(format, 0);
+}
+
+void OverlayFilter::setImage(const QImage &value)
+{
+    DPTR_D(OverlayFilter);
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        if (value.isNull() && d.image.isNull())
+            return;
+        if (value.format() == QImage::Format_ARGB32_Premultiplied)
+            d.image = value;
+        else
+            d.image = value.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        d.opaque = opaqueRect(d.image);
+        d.dirty = true;
+    }
+    Q_EMIT imageChanged();
+}
+
+QImage OverlayFilter::image() const
+{
+    DPTR_D(const OverlayFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.image;
+}
+
+void OverlayFilter::setPosition(const QPoint &value)
+{
+    DPTR_D(OverlayFilter);
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        if (d.pos == value)
+            return;
+        d.pos = value;
+        d.dirty = true;
+    }
+    Q_EMIT positionChanged();
+}
+
+QPoint OverlayFilter::position() const
+{
+    DPTR_D(const OverlayFilter);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.pos;
+}
+
+void OverlayFilter::process(Statistics *statistics, VideoFrame *frame)
+{
+    Q_UNUSED(statistics);
+    DPTR_D(OverlayFilter);
+    if (!frame || !frame->isValid() || !frame->constBits(0))
+        return;
+    OverlayLayout l;
+    if (!getLayout(frame->format(), &l))
+        return;
+    {
+        QMutexLocker lock(&d.mutex);
+        Q_UNUSED(lock);
+        if (d.image.isNull() || d.opaque.isEmpty())
+            return;
+        d.updateCache(*frame, l);
+    }
+    if (d.planes.isEmpty())
+        return;
+    // decoded frames share the buffers with decoder and may be used as reference frames, and copies of a frame
+    // (displayed, captured or queued frames) share the data. write in place only if no one else can see the data.
+    // otherwise blend into a new frame and copy the samples outside the overlay only
+    const bool writable = frame->isWritable();
+    VideoFrame out;
+    if (!writable) {
+        int pitch[4] = {0};
+        for (int i = 0; i < frame->planeCount(); ++i)
+            pitch[i] = frame->bytesPerLine(i);
+        out = VideoFrame::allocate(frame->format(), frame->width(), frame->height(), pitch);
+        if (!out.isValid())
+            return;
+        for (int i = 0; i < frame->planeCount(); ++i) {
+            const OverlayPlane *p = 0;
+            foreach (const OverlayPlane& o, d.planes) {
+                if (o.plane == i)
+                    p = &o;
+            }
+            const int n = frame->format().bytesPerLine(frame->planeWidth(i), i);
+            for (int y = 0; y < frame->planeHeight(i); ++y) {
+                const uchar *s = frame->constBits(i) + y*frame->bytesPerLine(i);
+                uchar *dst = out.bits(i) + y*out.bytesPerLine(i);
+                if (!p || y < p->y || y >= p->y + p->height) {
+                    memcpy(dst, s, n);
+                    continue;
+                }
+                const int x0 = p->x*l.bytes;
+                const int x1 = (p->x + p->width)*l.bytes;
+                memcpy(dst, s, x0);
+                memcpy(dst + x1, s + x1, n - x1);
+            }
+        }
+        out.setTimestamp(frame->timestamp());
+        out.setDisplayAspectRatio(frame->displayAspectRatio());
+        out.setColorSpace(frame->colorSpace());
+        out.setColorRange(frame->colorRange());
+    }
+    VideoFrame &target = writable ? *frame : out;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    const bool sse2 = detect_sse2();
+#endif
+    foreach (const OverlayPlane& p, d.planes) {
+        const int src_stride = frame->bytesPerLine(p.plane);
+        const int stride = target.bytesPerLine(p.plane);
+        const uchar *src = frame->constBits(p.plane) + p.y*src_stride + p.x*l.bytes;
+        uchar *dst = target.bits(p.plane) + p.y*stride + p.x*l.bytes;
+        const quint8 *inv = p.inv.constData();
+        if (l.bytes == 2) {
+            const quint32 *oa = p.oa_hi.constData();
+            for (int y = 0; y < p.height; ++y, src += src_stride, dst += stride, oa += p.width, inv += p.width) {
+                const quint16 *s16 = reinterpret_cast<const quint16*>(src);
+                quint16 *d16 = reinterpret_cast<quint16*>(dst);
+                for (int x = 0; x < p.width; ++x)
+                    d16[x] = quint16((oa[x] + quint32(s16[x])*inv[x] + 127)/255);
+            }
+            continue;
+        }
+        const quint16 *oa = p.oa.constData();
+        for (int y = 0; y < p.height; ++y, src += src_stride, dst += stride, oa += p.width, inv += p.width) {
+            int x = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+            if (sse2)
+                x = OverlayBlendRow8_SSE2(src, dst, oa, inv, p.width);
+#endif
+            for (; x < p.width; ++x) {
+                const quint32 v = oa[x] + quint32(src[x])*inv[x] + 128;
+                dst[x] = quint8((v + (v >> 8)) >> 8);
+            }
+        }
+    }
+    if (!writable)
+        *frame = out;
+}
+
+} //namespace QtAV
@@ -0,0 +1,53 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace QtAV {
+
+/*
+ * Blend a row of premultiplied overlay into 8 bit samples: dst = (oa + src*inv)/255
+ * oa: overlay value*alpha, inv: 255 - alpha. src can be dst.
+ * x/255 is computed as (x + 128 + ((x + 128) >> 8)) >> 8, which is exact rounding for x in [0, 255*255]
+ * Returns the number of samples processed. Remaining samples are processed by the caller.
+ */
+int OverlayBlendRow8_SSE2(const uint8_t *src, uint8_t *dst, const uint16_t *oa, const uint8_t *inv, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(128);
+    const int n = count & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i d = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i v = _mm_loadu_si128((const __m128i*)(inv + i));
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(v, zero));
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(v, zero));
+        lo = _mm_add_epi16(_mm_add_epi16(lo, _mm_loadu_si128((const __m128i*)(oa + i))), c128);
+        hi = _mm_add_epi16(_mm_add_epi16(hi, _mm_loadu_si128((const __m128i*)(oa + i + 8))), c128);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return n;
+}
+
+} //namespace QtAV
+#endif
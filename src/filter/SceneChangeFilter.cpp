@@ -0,0 +1,233 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/SceneChangeFilter.h"
+#include <stdint.h>
+#include <string.h>
+#include <QtCore/QVector>
+#include "QtAV/private/Filter_p.h"
+#include "QtAV/private/AVCompat.h"
+#include "QtAV/VideoFrame.h"
+#include "utils/GPUMemCopy.h"
+#include "utils/ring.h"
+#include "utils/Logger.h"
+
+#ifndef Q_PROCESSOR_X86 // qt4
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64)
+#define Q_PROCESSOR_X86
+#endif
+#endif
+
+#if AV_MODULE_CHECK(LIBAVUTIL, 55, 0, 0, 0, 100)
+#define DESC_VAL(X) (X)
+#else
+#define DESC_VAL(X) (X##_minus1 + 1)
+#endif
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+int SceneBlockSumRow8_SSE2(const uint8_t *src, int count, uint32_t *sums);
+uint32_t SceneSAD8_SSE2(const uint8_t *a, const uint8_t *b, int count);
+#endif
+
+static const int kBlockSize = 8; // thumbnail pixel is the average of 8x8 luma pixels
+static const int kHistBins = 64;
+
+class SceneChangeFilterPrivate Q_DECL_FINAL : public VideoFilterPrivate
+{
+public:
+    SceneChangeFilterPrivate()
+        : threshold(0.3)
+        , min_interval(0.5)
+        , score(0)
+        , last_cut(-1)
+        , has_prev(false)
+        , scores(ring<qreal>(8))
+    {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+        sse2 = detect_sse2();
+#else
+        sse2 = false;
+#endif
+    }
+    // average 8 bit luma in blocks. return false if format is not supported
+    bool makeThumbnail(const VideoFrame& frame) {
+        const VideoFormat fmt(frame.format());
+        if (!frame.constBits(0) || fmt.isRGB() || fmt.hasPalette() || fmt.isHWAccelerated() || fmt.isBitStream() || fmt.channels(0) != 1)
+            return false;
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)fmt.pixelFormatFFmpeg());
+        if (!desc)
+            return false;
+        const int depth = DESC_VAL(desc->comp[0].depth);
+        const int bits = depth + desc->comp[0].shift; // significant bits of a sample
+        if (depth < 8 || bits > 16 || (depth > 8 && fmt.isBigEndian()))
+            return false;
+        const int bw = frame.width()/kBlockSize;
+        const int bh = frame.height()/kBlockSize;
+        if (bw <= 0 || bh <= 0)
+            return false;
+        thumb.resize(bw*bh);
+        sums.resize(bw);
+        const int stride = frame.bytesPerLine(0);
+        for (int by = 0; by < bh; ++by) {
+            memset(sums.data(), 0, bw*sizeof(quint32));
+            for (int y = by*kBlockSize; y < (by + 1)*kBlockSize; ++y) {
+                const uchar *src = frame.constBits(0) + y*stride;
+                if (depth == 8) {
+                    int x = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+                    if (sse2)
+                        x = SceneBlockSumRow8_SSE2(src, bw*kBlockSize, sums.data());
+#endif
+                    for (; x < bw*kBlockSize; ++x)
+                        sums[x/kBlockSize] += src[x];
+                } else {
+                    const quint16 *src16 = reinterpret_cast<const quint16*>(src);
+                    for (int x = 0; x < bw*kBlockSize; ++x)
+                        sums[x/kBlockSize] += src16[x] >> (bits - 8);
+                }
+            }
+            for (int bx = 0; bx < bw; ++bx)
+                thumb[by*bw + bx] = quint8((sums[bx] + kBlockSize*kBlockSize/2)/(kBlockSize*kBlockSize));
+        }
+        return true;
+    }
+    // mean absolute difference of thumbnails and histogram distance. [0, 1]
+    qreal compare() const {
+        const int n = thumb.size();
+        const quint8 *a = thumb.constData();
+        const quint8 *b = prev_thumb.constData();
+        quint32 sad = 0;
+        int i = 0;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+        if (sse2) {
+            sad = SceneSAD8_SSE2(a, b, n);
+            i = n & ~15;
+        }
+#endif
+        for (; i < n; ++i)
+            sad += qAbs(int(a[i]) - int(b[i]));
+        int hist[kHistBins], prev_hist[kHistBins];
+        memset(hist, 0, sizeof(hist));
+        memset(prev_hist, 0, sizeof(prev_hist));
+        for (i = 0; i < n; ++i) {
+            hist[a[i]*kHistBins/256]++;
+            prev_hist[b[i]*kHistBins/256]++;
+        }
+        int hist_diff = 0;
+        for (i = 0; i < kHistBins; ++i)
+            hist_diff += qAbs(hist[i] - prev_hist[i]);
+        // histogram is robust to motion, sad detects cuts between scenes with similar histogram. mean difference of 64 is large enough
+        const qreal d_hist = qreal(hist_diff)/qreal(2*n);
+        const qreal d_sad = qMin<qreal>(1.0, qreal(sad)/qreal(n)/64.0);
+        return (d_hist + d_sad)/2.0;
+    }
+
+    qreal threshold;
+    qreal min_interval;
+    qreal score;
+    qreal last_cut;
+    bool has_prev;
+    bool sse2;
+    QVector<quint32> sums;
+    QVector<quint8> thumb, prev_thumb;
+    ring<qreal> scores; // recent scores
+};
+
+SceneChangeFilter::SceneChangeFilter(QObject *parent)
+    : VideoFilter(*new SceneChangeFilterPrivate(), parent)
+{
+}
+
+void SceneChangeFilter::setThreshold(qreal value)
+{
+    DPTR_D(SceneChangeFilter);
+    if (d.threshold == value)
+        return;
+    d.threshold = value;
+    Q_EMIT thresholdChanged();
+}
+
+qreal SceneChangeFilter::threshold() const
+{
+    return d_func().threshold;
+}
+
+void SceneChangeFilter::setMinInterval(qreal value)
+{
+    DPTR_D(SceneChangeFilter);
+    if (d.min_interval == value)
+        return;
+    d.min_interval = value;
+    Q_EMIT minIntervalChanged();
+}
+
+qreal SceneChangeFilter::minInterval() const
+{
+    return d_func().min_interval;
+}
+
+qreal SceneChangeFilter::score() const
+{
+    return d_func().score;
+}
+
+void SceneChangeFilter::flush()
+{
+    DPTR_D(SceneChangeFilter);
+    d.has_prev = false;
+    d.last_cut = -1;
+    d.score = 0;
+    while (!d.scores.empty())
+        d.scores.pop_front();
+}
+
+void SceneChangeFilter::process(Statistics *statistics, VideoFrame *frame)
+{
+    Q_UNUSED(statistics);
+    DPTR_D(SceneChangeFilter);
+    if (!frame || !frame->isValid())
+        return;
+    if (!d.makeThumbnail(*frame))
+        return;
+    if (!d.has_prev || d.prev_thumb.size() != d.thumb.size()) { // first frame or size changed
+        d.has_prev = true;
+        d.thumb.swap(d.prev_thumb);
+        return;
+    }
+    d.score = d.compare();
+    qreal avg = 0;
+    for (int i = 0; i < (int)d.scores.size(); ++i)
+        avg += d.scores.at(i);
+    if (!d.scores.empty())
+        avg /= qreal(d.scores.size());
+    d.scores.push_back(d.score);
+    d.thumb.swap(d.prev_thumb);
+    if (d.score <= d.threshold || d.score <= 2.0*avg) // continuous high motion is not a cut
+        return;
+    const qreal t = frame->timestamp();
+    if (d.last_cut >= 0 && t >= d.last_cut && t - d.last_cut < d.min_interval)
+        return;
+    d.last_cut = t;
+    Q_EMIT sceneChanged(t, qBound<qreal>(0.0, (d.score - qMax(avg, d.threshold))/(1.0 - qMax(avg, d.threshold)), 1.0));
+}
+
+} //namespace QtAV
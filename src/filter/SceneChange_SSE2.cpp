@@ -0,0 +1,57 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace QtAV {
+
+/*
+ * Kernels of SceneChangeFilter. Functions process the first count & ~15 samples, the caller processes the rest.
+ */
+// add the sum of each 8 pixels group to sums[i/8]
+int SceneBlockSumRow8_SSE2(const uint8_t *src, int count, uint32_t *sums)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const int n = count & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i s = _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(src + i)), zero);
+        sums[i/8] += _mm_cvtsi128_si32(s);
+        sums[i/8 + 1] += _mm_cvtsi128_si32(_mm_srli_si128(s, 8));
+    }
+    return n;
+}
+
+// sum of absolute differences
+uint32_t SceneSAD8_SSE2(const uint8_t *a, const uint8_t *b, int count)
+{
+    __m128i sum = _mm_setzero_si128();
+    const int n = count & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(x, y));
+    }
+    return uint32_t(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+}
+
+} //namespace QtAV
+#endif
@@ -0,0 +1,351 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/VideoEQFilter.h"
+#include <stdint.h>
+#include <string.h> //memcpy
+#include <QtCore/QVector>
+#include <QtCore/qmath.h>
+#include "QtAV/private/Filter_p.h"
+#include "QtAV/private/AVCompat.h"
+#include "QtAV/VideoFrame.h"
+#include "utils/GPUMemCopy.h"
+#include "utils/Logger.h"
+
+#ifndef Q_PROCESSOR_X86 // qt4
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64)
+#define Q_PROCESSOR_X86
+#endif
+#endif
+
+// ffmpeg3.0 151aa2e/ libav>11 2268db2
+#if AV_MODULE_CHECK(LIBAVUTIL, 55, 0, 0, 0, 100)
+#define DESC_VAL(X) (X)
+#define DESC_OFFSET(X) (X.offset)
+#else
+#define DESC_VAL(X) (X##_minus1 + 1)
+#define DESC_OFFSET(X) (X.offset_plus1) // only used to compare
+#endif
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+int EQChromaInterleaved8_SSE2(const uint8_t *src, uint8_t *dst, int pairs, int a, int b);
+int EQChromaPlanar8_SSE2(const uint8_t *srcu, const uint8_t *srcv, uint8_t *dstu, uint8_t *dstv, int width, int a, int b);
+int EQChromaInterleaved16_SSE2(const uint16_t *src, uint16_t *dst, int pairs, int a, int b, int depth, int bits_shift);
+int EQChromaPlanar16_SSE2(const uint16_t *srcu, const uint16_t *srcv, uint16_t *dstu, uint16_t *dstv, int width, int a, int b, int depth, int bits_shift);
+#endif
+
+namespace {
+// yuv layout the filter can process
+struct EQLayout {
+    int depth; // significant bits
+    int shift; // bits shifted left in a sample, e.g. P010
+    int bytes; // bytes per sample
+    int plane_u, plane_v; // plane_u == plane_v for semi-planar
+    bool v_first; // NV21
+    bool interleaved() const { return plane_u == plane_v; }
+};
+
+bool getLayout(const VideoFormat& fmt, EQLayout* layout)
+{
+    if (!fmt.isValid() || fmt.isRGB() || fmt.hasPalette() || fmt.isHWAccelerated() || fmt.isBigEndian() || fmt.isBitStream())
+        return false;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)fmt.pixelFormatFFmpeg());
+    if (!desc || desc->nb_components < 3)
+        return false;
+    const AVComponentDescriptor &y = desc->comp[0];
+    const AVComponentDescriptor &u = desc->comp[1];
+    const AVComponentDescriptor &v = desc->comp[2];
+    const int depth = DESC_VAL(y.depth);
+    if (depth < 8 || depth > 16 || DESC_VAL(u.depth) != depth || DESC_VAL(v.depth) != depth)
+        return false;
+    if (y.shift != u.shift || y.shift != v.shift || depth + y.shift > 16)
+        return false;
+    const int bytes = depth > 8 ? 2 : 1;
+    if (y.plane != 0 || DESC_VAL(y.step) != bytes || u.plane == 0 || v.plane == 0)
+        return false;
+    const bool interleaved = u.plane == v.plane;
+    if (DESC_VAL(u.step) != (interleaved ? 2 : 1)*bytes || DESC_VAL(v.step) != DESC_VAL(u.step))
+        return false;
+    if (layout) {
+        layout->depth = depth;
+        layout->shift = y.shift;
+        layout->bytes = bytes;
+        layout->plane_u = u.plane;
+        layout->plane_v = v.plane;
+        layout->v_first = interleaved && DESC_OFFSET(v) < DESC_OFFSET(u);
+    }
+    return true;
+}
+
+template<typename T>
+void lutPlane(const uchar* src, int src_stride, uchar* dst, int dst_stride, int width, int height, const quint16* lut, int shift)
+{
+    for (int y = 0; y < height; ++y) {
+        const T *s = reinterpret_cast<const T*>(src + y*src_stride);
+        T *d = reinterpret_cast<T*>(dst + y*dst_stride);
+        for (int x = 0; x < width; ++x)
+            d[x] = T(lut[s[x] >> shift] << shift);
+    }
+}
+
+template<typename T>
+inline void rotateUV(T su, T sv, T* du, T* dv, int a, int b, int center, int shift)
+{
+    const int u = int(su >> shift) - center;
+    const int v = int(sv >> shift) - center;
+    *du = T(qBound(0, ((a*u - b*v + (1 << 11)) >> 12) + center, 2*center - 1) << shift);
+    *dv = T(qBound(0, ((b*u + a*v + (1 << 11)) >> 12) + center, 2*center - 1) << shift);
+}
+} //namespace
+
+class VideoEQFilterPrivate Q_DECL_FINAL : public VideoFilterPrivate
+{
+public:
+    VideoEQFilterPrivate()
+        : brightness(0)
+        , contrast(0)
+        , saturation(0)
+        , hue(0)
+        , lut_depth(0)
+        , lut_range(ColorRange_Unknown)
+        , lut_dirty(true)
+    {}
+    bool isIdentity() const {
+        return qFuzzyIsNull(brightness) && qFuzzyIsNull(contrast) && qFuzzyIsNull(saturation) && qFuzzyIsNull(hue);
+    }
+    // the same as ColorTransform: contrast scales around the middle gray, brightness is an offset in full range
+    void updateLut(int depth, ColorRange range) {
+        if (!lut_dirty && lut_depth == depth && lut_range == range)
+            return;
+        lut_dirty = false;
+        lut_depth = depth;
+        lut_range = range;
+        const int max = (1 << depth) - 1;
+        qreal black = 0, white = max;
+        if (range != ColorRange_Full) {
+            black = 16 << (depth - 8);
+            white = 235 << (depth - 8);
+        }
+        const qreal c = contrast + 1.0;
+        lut.resize(max + 1);
+        for (int i = 0; i <= max; ++i) {
+            const qreal y = (qreal(i) - black)/(white - black);
+            lut[i] = qBound(0, qRound(black + ((y - 0.5)*c + 0.5 + brightness)*(white - black)), max);
+        }
+    }
+    // chroma matrix in Q12. contrast also scales chroma because it's applied on rgb
+    void chromaMatrix(int* a, int* b) const {
+        const qreal s = (contrast + 1.0)*(saturation + 1.0);
+        const qreal h = hue*M_PI;
+        *a = qBound(-32767, qRound(s*qCos(h)*4096.0), 32767);
+        *b = qBound(-32767, qRound(s*qSin(h)*4096.0), 32767);
+    }
+
+    qreal brightness, contrast, saturation, hue;
+    int lut_depth;
+    ColorRange lut_range;
+    bool lut_dirty;
+    QVector<quint16> lut;
+};
+
+VideoEQFilter::VideoEQFilter(QObject *parent)
+    : VideoFilter(*new VideoEQFilterPrivate(), parent)
+{
+}
+
+bool VideoEQFilter::isFormatSupported(const VideoFormat &format)
+{
+    return getLayout(format, 0);
+}
+
+qreal VideoEQFilter::brightness() const
+{
+    return d_func().brightness;
+}
+
+void VideoEQFilter::setBrightness(qreal value)
+{
+    DPTR_D(VideoEQFilter);
+    value = qBound<qreal>(-1.0, value, 1.0);
+    if (d.brightness == value)
+        return;
+    d.brightness = value;
+    d.lut_dirty = true;
+    Q_EMIT brightnessChanged(value);
+}
+
+qreal VideoEQFilter::contrast() const
+{
+    return d_func().contrast;
+}
+
+void VideoEQFilter::setContrast(qreal value)
+{
+    DPTR_D(VideoEQFilter);
+    value = qBound<qreal>(-1.0, value, 1.0);
+    if (d.contrast == value)
+        return;
+    d.contrast = value;
+    d.lut_dirty = true;
+    Q_EMIT contrastChanged(value);
+}
+
+qreal VideoEQFilter::saturation() const
+{
+    return d_func().saturation;
+}
+
+void VideoEQFilter::setSaturation(qreal value)
+{
+    DPTR_D(VideoEQFilter);
+    value = qBound<qreal>(-1.0, value, 1.0);
+    if (d.saturation == value)
+        return;
+    d.saturation = value;
+    Q_EMIT saturationChanged(value);
+}
+
+qreal VideoEQFilter::hue() const
+{
+    return d_func().hue;
+}
+
+void VideoEQFilter::setHue(qreal value)
+{
+    DPTR_D(VideoEQFilter);
+    value = qBound<qreal>(-1.0, value, 1.0);
+    if (d.hue == value)
+        return;
+    d.hue = value;
+    Q_EMIT hueChanged(value);
+}
+
+bool VideoEQFilter::isIdentity() const
+{
+    return d_func().isIdentity();
+}
+
+void VideoEQFilter::process(Statistics *statistics, VideoFrame *frame)
+{
+    Q_UNUSED(statistics);
+    DPTR_D(VideoEQFilter);
+    if (!frame || !frame->isValid() || d.isIdentity())
+        return;
+    EQLayout l;
+    if (!frame->constBits(0) || !getLayout(frame->format(), &l))
+        return;
+    // decoded frames share the buffers with decoder and may be used as reference frames, and copies of a frame
+    // (displayed, captured or queued frames) share the data. write in place only if no one else can see the data.
+    // otherwise write into a new frame. every luma and chroma sample is written below, so only other planes are copied
+    const bool writable = frame->isWritable();
+    VideoFrame out;
+    if (writable) {
+        out = *frame;
+    } else {
+        int pitch[4] = {0};
+        for (int i = 0; i < frame->planeCount(); ++i)
+            pitch[i] = frame->bytesPerLine(i);
+        out = VideoFrame::allocate(frame->format(), frame->width(), frame->height(), pitch);
+        if (!out.isValid())
+            return;
+        // e.g. alpha
+        for (int i = 1; i < frame->planeCount(); ++i) {
+            if (i == l.plane_u || i == l.plane_v)
+                continue;
+            const int n = frame->format().bytesPerLine(frame->planeWidth(i), i);
+            for (int y = 0; y < frame->planeHeight(i); ++y)
+                memcpy(out.bits(i) + y*out.bytesPerLine(i), frame->constBits(i) + y*frame->bytesPerLine(i), n);
+        }
+        out.setTimestamp(frame->timestamp());
+        out.setDisplayAspectRatio(frame->displayAspectRatio());
+        out.setColorSpace(frame->colorSpace());
+        out.setColorRange(frame->colorRange());
+    }
+    // luma
+    d.updateLut(l.depth, frame->colorRange());
+    if (l.bytes == 1)
+        lutPlane<quint8>(frame->constBits(0), frame->bytesPerLine(0), out.bits(0), out.bytesPerLine(0), frame->width(), frame->height(), d.lut.constData(), 0);
+    else
+        lutPlane<quint16>(frame->constBits(0), frame->bytesPerLine(0), out.bits(0), out.bytesPerLine(0), frame->width(), frame->height(), d.lut.constData(), l.shift);
+    // chroma
+    int a = 0, b = 0;
+    d.chromaMatrix(&a, &b);
+    if (l.v_first) // swapping u and v inverts the rotation
+        b = -b;
+    const int center = 1 << (l.depth - 1);
+    const int cw = frame->planeWidth(l.plane_u);
+    const int ch = frame->planeHeight(l.plane_u);
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    const bool sse2 = detect_sse2();
+#else
+    const bool sse2 = false;
+#endif
+    for (int y = 0; y < ch; ++y) {
+        int x = 0;
+        const uchar *su = frame->constBits(l.plane_u) + y*frame->bytesPerLine(l.plane_u);
+        const uchar *sv = frame->constBits(l.plane_v) + y*frame->bytesPerLine(l.plane_v);
+        uchar *du = out.bits(l.plane_u) + y*out.bytesPerLine(l.plane_u);
+        uchar *dv = out.bits(l.plane_v) + y*out.bytesPerLine(l.plane_v);
+        if (l.bytes == 1) {
+            if (l.interleaved()) {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+                if (sse2)
+                    x = EQChromaInterleaved8_SSE2(su, du, cw, a, b);
+#endif
+                for (; x < cw; ++x)
+                    rotateUV<quint8>(su[2*x], su[2*x+1], &du[2*x], &du[2*x+1], a, b, center, 0);
+            } else {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+                if (sse2)
+                    x = EQChromaPlanar8_SSE2(su, sv, du, dv, cw, a, b);
+#endif
+                for (; x < cw; ++x)
+                    rotateUV<quint8>(su[x], sv[x], &du[x], &dv[x], a, b, center, 0);
+            }
+            continue;
+        }
+        const quint16 *su16 = reinterpret_cast<const quint16*>(su);
+        const quint16 *sv16 = reinterpret_cast<const quint16*>(sv);
+        quint16 *du16 = reinterpret_cast<quint16*>(du);
+        quint16 *dv16 = reinterpret_cast<quint16*>(dv);
+        if (l.interleaved()) {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+            if (sse2)
+                x = EQChromaInterleaved16_SSE2(su16, du16, cw, a, b, l.depth, l.shift);
+#endif
+            for (; x < cw; ++x)
+                rotateUV<quint16>(su16[2*x], su16[2*x+1], &du16[2*x], &du16[2*x+1], a, b, center, l.shift);
+        } else {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+            if (sse2)
+                x = EQChromaPlanar16_SSE2(su16, sv16, du16, dv16, cw, a, b, l.depth, l.shift);
+#endif
+            for (; x < cw; ++x)
+                rotateUV<quint16>(su16[x], sv16[x], &du16[x], &dv16[x], a, b, center, l.shift);
+        }
+    }
+    Q_UNUSED(sse2);
+    if (!writable)
+        *frame = out;
+}
+
+} //namespace QtAV
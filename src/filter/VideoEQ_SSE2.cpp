@@ -0,0 +1,139 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <emmintrin.h>
+
+/*
+ * Chroma kernels of VideoEQFilter. (u, v) relative to the center value is rotated and scaled by a 2x2 matrix in Q12:
+ *   u' = (a*u - b*v) >> 12
+ *   v' = (b*u + a*v) >> 12
+ * u and v are interleaved as 16 bit pairs so that _mm_madd_epi16 computes a whole row of the matrix.
+ * Functions return the number of pixels processed. Remaining pixels are processed by the caller.
+ */
+namespace QtAV {
+
+// 4 interleaved signed 16 bit (u, v) pairs => 4 int32 u', 4 int32 v', then back to 4 saturated 16 bit pairs
+static inline __m128i eq_rotate_pairs(__m128i uv, __m128i mu, __m128i mv, __m128i round)
+{
+    const __m128i u = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uv, mu), round), 12);
+    const __m128i v = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uv, mv), round), 12);
+    return _mm_packs_epi32(_mm_unpacklo_epi32(u, v), _mm_unpackhi_epi32(u, v));
+}
+
+// 16 bytes of interleaved 8 bit (u, v) => 16 bytes
+static inline __m128i eq_rotate_uv8(__m128i x, __m128i mu, __m128i mv, __m128i round)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(128);
+    __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(x, zero), c128);
+    __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(x, zero), c128);
+    lo = _mm_add_epi16(eq_rotate_pairs(lo, mu, mv, round), c128);
+    hi = _mm_add_epi16(eq_rotate_pairs(hi, mu, mv, round), c128);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// 8 interleaved 16 bit samples (4 pairs) => signed values relative to center, clamped to valid range
+static inline __m128i eq_rotate_uv16(__m128i x, __m128i mu, __m128i mv, __m128i round, __m128i center, __m128i vmin, __m128i vmax, __m128i shift)
+{
+    x = _mm_sub_epi16(_mm_srl_epi16(x, shift), center); // wraps to signed for 16 bit depth
+    x = eq_rotate_pairs(x, mu, mv, round);
+    return _mm_min_epi16(_mm_max_epi16(x, vmin), vmax);
+}
+
+int EQChromaInterleaved8_SSE2(const uint8_t *src, uint8_t *dst, int pairs, int a, int b)
+{
+    const __m128i mu = _mm_set_epi16(-b, a, -b, a, -b, a, -b, a);
+    const __m128i mv = _mm_set_epi16(a, b, a, b, a, b, a, b);
+    const __m128i round = _mm_set1_epi32(1 << 11);
+    const int n = pairs & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(src + 2*i));
+        _mm_storeu_si128((__m128i*)(dst + 2*i), eq_rotate_uv8(x, mu, mv, round));
+    }
+    return n;
+}
+
+int EQChromaPlanar8_SSE2(const uint8_t *srcu, const uint8_t *srcv, uint8_t *dstu, uint8_t *dstv, int width, int a, int b)
+{
+    const __m128i mu = _mm_set_epi16(-b, a, -b, a, -b, a, -b, a);
+    const __m128i mv = _mm_set_epi16(a, b, a, b, a, b, a, b);
+    const __m128i round = _mm_set1_epi32(1 << 11);
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    const int n = width & ~15;
+    for (int i = 0; i < n; i += 16) {
+        const __m128i u = _mm_loadu_si128((const __m128i*)(srcu + i));
+        const __m128i v = _mm_loadu_si128((const __m128i*)(srcv + i));
+        const __m128i lo = eq_rotate_uv8(_mm_unpacklo_epi8(u, v), mu, mv, round);
+        const __m128i hi = eq_rotate_uv8(_mm_unpackhi_epi8(u, v), mu, mv, round);
+        _mm_storeu_si128((__m128i*)(dstu + i), _mm_packus_epi16(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask)));
+        _mm_storeu_si128((__m128i*)(dstv + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+    return n;
+}
+
+// depth: significant bits. bits_shift: bits the samples are shifted left, e.g. 6 for P010
+int EQChromaInterleaved16_SSE2(const uint16_t *src, uint16_t *dst, int pairs, int a, int b, int depth, int bits_shift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(bits_shift);
+    const __m128i mu = _mm_set_epi16(-b, a, -b, a, -b, a, -b, a);
+    const __m128i mv = _mm_set_epi16(a, b, a, b, a, b, a, b);
+    const __m128i round = _mm_set1_epi32(1 << 11);
+    const int c = 1 << (depth - 1);
+    const __m128i center = _mm_set1_epi16((short)c);
+    const __m128i vmin = _mm_set1_epi16((short)-c);
+    const __m128i vmax = _mm_set1_epi16((short)(c - 1));
+    const int n = pairs & ~3;
+    for (int i = 0; i < n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + 2*i));
+        x = _mm_add_epi16(eq_rotate_uv16(x, mu, mv, round, center, vmin, vmax, shift), center);
+        _mm_storeu_si128((__m128i*)(dst + 2*i), _mm_sll_epi16(x, shift));
+    }
+    return n;
+}
+
+int EQChromaPlanar16_SSE2(const uint16_t *srcu, const uint16_t *srcv, uint16_t *dstu, uint16_t *dstv, int width, int a, int b, int depth, int bits_shift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(bits_shift);
+    const __m128i mu = _mm_set_epi16(-b, a, -b, a, -b, a, -b, a);
+    const __m128i mv = _mm_set_epi16(a, b, a, b, a, b, a, b);
+    const __m128i round = _mm_set1_epi32(1 << 11);
+    const int c = 1 << (depth - 1);
+    const __m128i center = _mm_set1_epi16((short)c);
+    const __m128i vmin = _mm_set1_epi16((short)-c);
+    const __m128i vmax = _mm_set1_epi16((short)(c - 1));
+    const int n = width & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const __m128i u = _mm_loadu_si128((const __m128i*)(srcu + i));
+        const __m128i v = _mm_loadu_si128((const __m128i*)(srcv + i));
+        const __m128i lo = eq_rotate_uv16(_mm_unpacklo_epi16(u, v), mu, mv, round, center, vmin, vmax, shift);
+        const __m128i hi = eq_rotate_uv16(_mm_unpackhi_epi16(u, v), mu, mv, round, center, vmin, vmax, shift);
+        // deinterleave signed values by sign extension. no saturation because values are in 16 bit range
+        const __m128i ou = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+        const __m128i ov = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+        _mm_storeu_si128((__m128i*)(dstu + i), _mm_sll_epi16(_mm_add_epi16(ou, center), shift));
+        _mm_storeu_si128((__m128i*)(dstv + i), _mm_sll_epi16(_mm_add_epi16(ov, center), shift));
+    }
+    return n;
+}
+
+} //namespace QtAV
+#endif
@@ -0,0 +1,338 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/MediaIO.h"
+#include "QtAV/private/MediaIO_p.h"
+#include "QtAV/private/mkid.h"
+#include "QtAV/private/factory.h"
+#include <cmath>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include "utils/Logger.h"
+
+namespace QtAV {
+/*!
+ * \brief The LiveEmuIO class
+ * Replays a local file or QIODevice as a live network stream, for reproducible buffering and stall tests without a network.
+ * Byte n becomes available at a time computed only from the properties, so every run sees the same arrival schedule:
+ *  - bitRate: delivery rate in bits per second. 0: no rate limit, and no stalls or spikes
+ *  - burstSize: bytes delivered at once, like a network packet. Default is 1316 (7 mpeg-ts packets, a common udp payload)
+ *  - latency: ms before the first byte
+ *  - stallInterval, stallDuration: delivery stops for stallDuration ms after every stallInterval ms. the schedule is shifted
+ *  - spikeInterval, spikeDuration: bytes scheduled in the last spikeDuration ms of every spikeInterval ms are held
+ *    and released together when the interval ends, i.e. a latency spike without losing bitrate
+ * The clock starts at the first read(). read() blocks like a socket until the next byte is available.
+ * Nothing is dropped if the reader is slow, so it behaves like a source with an unlimited receive buffer.
+ * dataArrived() reports when each returned range became available and when it was read, stalledTime() is the total
+ * time read() waited for data.
+ * abort() wakes up a blocking read(). Not seekable. Use url "liveemu:path" or set device.
+ */
+class LiveEmuIOPrivate;
+class LiveEmuIO Q_DECL_FINAL : public MediaIO
+{
+    Q_OBJECT
+    Q_PROPERTY(QIODevice* device READ device WRITE setDevice)
+    Q_PROPERTY(int bitRate READ bitRate WRITE setBitRate)
+    Q_PROPERTY(int burstSize READ burstSize WRITE setBurstSize)
+    Q_PROPERTY(int latency READ latency WRITE setLatency)
+    Q_PROPERTY(int stallInterval READ stallInterval WRITE setStallInterval)
+    Q_PROPERTY(int stallDuration READ stallDuration WRITE setStallDuration)
+    Q_PROPERTY(int spikeInterval READ spikeInterval WRITE setSpikeInterval)
+    Q_PROPERTY(int spikeDuration READ spikeDuration WRITE setSpikeDuration)
+    Q_PROPERTY(qint64 stalledTime READ stalledTime)
+    Q_PROPERTY(qint64 bytesRead READ bytesRead)
+    DPTR_DECLARE_PRIVATE(LiveEmuIO)
+public:
+    LiveEmuIO();
+    ~LiveEmuIO();
+    QString name() const Q_DECL_OVERRIDE;
+    const QStringList& protocols() const Q_DECL_OVERRIDE
+    {
+        static QStringList p = QStringList() << QStringLiteral("liveemu");
+        return p;
+    }
+    // MUST open/close outside. url is ignored if device is set
+    void setDevice(QIODevice *dev);
+    QIODevice* device() const;
+    void setBitRate(int value);
+    int bitRate() const;
+    void setBurstSize(int value);
+    int burstSize() const;
+    void setLatency(int value);
+    int latency() const;
+    void setStallInterval(int value);
+    int stallInterval() const;
+    void setStallDuration(int value);
+    int stallDuration() const;
+    void setSpikeInterval(int value);
+    int spikeInterval() const;
+    void setSpikeDuration(int value);
+    int spikeDuration() const;
+    qint64 stalledTime() const;
+    qint64 bytesRead() const;
+    /// ms since the first read() when the byte at position - 1 becomes available
+    qint64 arrivalTime(qint64 position) const;
+
+    bool isSeekable() const Q_DECL_OVERRIDE { return false;}
+    void abort(bool value = true) Q_DECL_OVERRIDE;
+    qint64 read(char *data, qint64 maxSize) Q_DECL_OVERRIDE;
+    bool seek(qint64 offset, int from) Q_DECL_OVERRIDE;
+    qint64 position() const Q_DECL_OVERRIDE;
+    qint64 size() const Q_DECL_OVERRIDE { return 0;} // unknown, as a live stream
+Q_SIGNALS:
+    /*!
+     * \brief dataArrived
+     * Emitted in the reading thread for each read(). Bytes before \a position became available at \a arrivalTime,
+     * and were returned at \a readTime (ms since the first read). readTime - arrivalTime is the time the data was buffered
+     * in "network", 0 means the reader was waiting for data.
+     */
+    void dataArrived(qint64 position, qint64 arrivalTime, qint64 readTime);
+protected:
+    void onUrlChanged() Q_DECL_OVERRIDE;
+};
+typedef LiveEmuIO MediaIOLiveEmu;
+static const MediaIOId MediaIOId_LiveEmu = mkid::id32base36_6<'L','i','v','e','E','m'>::value;
+static const char kLiveEmuName[] = "LiveEmu";
+FACTORY_REGISTER(MediaIO, LiveEmu, kLiveEmuName)
+
+class LiveEmuIOPrivate Q_DECL_FINAL : public MediaIOPrivate
+{
+public:
+    LiveEmuIOPrivate()
+        : MediaIOPrivate()
+        , dev(0)
+        , bit_rate(4000000)
+        , burst(1316)
+        , latency(0)
+        , stall_interval(0)
+        , stall_duration(0)
+        , spike_interval(0)
+        , spike_duration(0)
+        , pos(0)
+        , stalled(0)
+        , abort(false)
+    {}
+    ~LiveEmuIOPrivate() {
+        if (file.isOpen())
+            file.close();
+    }
+    QIODevice* source() {
+        if (dev)
+            return dev;
+        return file.isOpen() ? &file : 0;
+    }
+    void reset() {
+        pos = 0;
+        stalled = 0;
+        abort = false;
+        timer.invalidate();
+    }
+
+    QIODevice *dev;
+    QFile file;
+    int bit_rate;
+    int burst;
+    int latency;
+    int stall_interval;
+    int stall_duration;
+    int spike_interval;
+    int spike_duration;
+    qint64 pos;
+    qint64 stalled;
+    bool abort;
+    QElapsedTimer timer;
+    mutable QMutex mutex;
+    QWaitCondition cond; // wakes a blocking read() if aborted
+};
+
+LiveEmuIO::LiveEmuIO() : MediaIO(*new LiveEmuIOPrivate()) {}
+
+LiveEmuIO::~LiveEmuIO()
+{
+    DPTR_D(LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.abort = true;
+    d.cond.wakeAll();
+}
+
+QString LiveEmuIO::name() const { return QLatin1String(kLiveEmuName);}
+
+void LiveEmuIO::setDevice(QIODevice *dev)
+{
+    DPTR_D(LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.dev = dev;
+    d.reset();
+}
+
+QIODevice* LiveEmuIO::device() const
+{
+    return d_func().dev;
+}
+
+void LiveEmuIO::abort(bool value)
+{
+    DPTR_D(LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.abort = value;
+    d.cond.wakeAll();
+}
+
+#define LIVEEMU_PROPERTY(TYPE, GETTER, SETTER, MEMBER) \
+    void LiveEmuIO::SETTER(TYPE value) { \
+        DPTR_D(LiveEmuIO); \
+        QMutexLocker lock(&d.mutex); \
+        Q_UNUSED(lock); \
+        d.MEMBER = qMax<TYPE>(0, value); \
+    } \
+    TYPE LiveEmuIO::GETTER() const { \
+        QMutexLocker lock(&d_func().mutex); \
+        Q_UNUSED(lock); \
+        return d_func().MEMBER; \
+    }
+LIVEEMU_PROPERTY(int, bitRate, setBitRate, bit_rate)
+LIVEEMU_PROPERTY(int, burstSize, setBurstSize, burst)
+LIVEEMU_PROPERTY(int, latency, setLatency, latency)
+LIVEEMU_PROPERTY(int, stallInterval, setStallInterval, stall_interval)
+LIVEEMU_PROPERTY(int, stallDuration, setStallDuration, stall_duration)
+LIVEEMU_PROPERTY(int, spikeInterval, setSpikeInterval, spike_interval)
+LIVEEMU_PROPERTY(int, spikeDuration, setSpikeDuration, spike_duration)
+#undef LIVEEMU_PROPERTY
+
+qint64 LiveEmuIO::stalledTime() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().stalled;
+}
+
+qint64 LiveEmuIO::bytesRead() const
+{
+    return position();
+}
+
+qint64 LiveEmuIO::arrivalTime(qint64 position) const
+{
+    DPTR_D(const LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.bit_rate <= 0)
+        return d.latency;
+    qint64 end = position;
+    if (d.burst > 0) // the whole burst arrives with its last byte
+        end = (position + d.burst - 1)/d.burst*d.burst;
+    double t = double(end)*8000.0/double(d.bit_rate);
+    if (d.stall_interval > 0 && d.stall_duration > 0)
+        t += std::floor(t/double(d.stall_interval))*double(d.stall_duration);
+    if (d.spike_interval > 0 && d.spike_duration > 0) {
+        const double phase = std::fmod(t, double(d.spike_interval));
+        if (phase >= double(d.spike_interval - d.spike_duration))
+            t += double(d.spike_interval) - phase;
+    }
+    return d.latency + qint64(std::ceil(t));
+}
+
+qint64 LiveEmuIO::read(char *data, qint64 maxSize)
+{
+    DPTR_D(LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    QIODevice *dev = d.source();
+    if (!dev || maxSize <= 0 || d.abort)
+        return 0;
+    if (!d.timer.isValid())
+        d.timer.start();
+    const qint64 pos = d.pos;
+    lock.unlock();
+    // wait for the next byte like a blocking socket
+    const qint64 t0 = arrivalTime(pos + 1);
+    qint64 now = d.timer.elapsed();
+    lock.relock();
+    if (t0 > now) {
+        const qint64 start = now;
+        while (now < t0 && !d.abort) {
+            d.cond.wait(&d.mutex, (unsigned long)qMin<qint64>(t0 - now, 20LL));
+            now = d.timer.elapsed();
+        }
+        d.stalled += now - start;
+        if (d.abort)
+            return 0;
+    }
+    lock.unlock();
+    // all bytes available now, at least 1
+    qint64 lo = 1, hi = maxSize;
+    while (lo < hi) {
+        const qint64 mid = lo + (hi - lo + 1)/2;
+        if (arrivalTime(pos + mid) <= now)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    const qint64 n = dev->read(data, lo);
+    if (n <= 0)
+        return n;
+    lock.relock();
+    d.pos += n;
+    lock.unlock();
+    Q_EMIT dataArrived(pos + n, arrivalTime(pos + n), now);
+    return n;
+}
+
+bool LiveEmuIO::seek(qint64 offset, int from)
+{
+    Q_UNUSED(offset);
+    Q_UNUSED(from);
+    abort(false); // seek request is done
+    return false;
+}
+
+qint64 LiveEmuIO::position() const
+{
+    QMutexLocker lock(&d_func().mutex);
+    Q_UNUSED(lock);
+    return d_func().pos;
+}
+
+void LiveEmuIO::onUrlChanged()
+{
+    DPTR_D(LiveEmuIO);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.file.isOpen())
+        d.file.close();
+    d.reset();
+    QString path(url());
+    if (path.startsWith(QLatin1String("liveemu:")))
+        path = path.mid(8);
+    d.file.setFileName(path);
+    if (path.isEmpty())
+        return;
+    if (!d.file.open(QIODevice::ReadOnly))
+        qWarning() << "Failed to open [" << d.file.fileName() << "]: " << d.file.errorString();
+}
+
+} //namespace QtAV
+#include "LiveEmuIO.moc"
@@ -32,6 +32,7 @@ FACTORY_DEFINE(MediaIO)
 
 extern bool RegisterMediaIOQIODevice_Man();
 extern bool RegisterMediaIOQFile_Man();
+extern bool RegisterMediaIOLiveEmu_Man();
 extern bool RegisterMediaIOWinRT_Man();
 void MediaIO::registerAll()
 {
@@ -41,6 +42,7 @@ void MediaIO::registerAll()
     done = true;
     RegisterMediaIOQIODevice_Man();
     RegisterMediaIOQFile_Man();
+    RegisterMediaIOLiveEmu_Man();
 #ifdef Q_OS_WINRT
     RegisterMediaIOWinRT_Man();
 #endif
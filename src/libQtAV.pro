@@ -82,7 +82,13 @@ sse4_1 {
 sse2 {
   DEFINES += QTAV_HAVE_SSE2=1
   !config_simd: CONFIG *= simd
-  SSE2_SOURCES += utils/CopyFrame_SSE2.cpp
+  SSE2_SOURCES += utils/CopyFrame_SSE2.cpp \
+                  filter/VideoEQ_SSE2.cpp \
+                  filter/Deinterlace_SSE2.cpp \
+                  filter/Overlay_SSE2.cpp \
+                  filter/SceneChange_SSE2.cpp \
+                  AudioRemix_SSE2.cpp \
+                  utils/FrameCopy_SSE2.cpp
 }
 
 win32 {
@@ -440,6 +446,8 @@ SOURCES += \
     subtitle/Subtitle.cpp \
     subtitle/SubtitleProcessor.cpp \
     subtitle/SubtitleProcessorFFmpeg.cpp \
+    utils/FrameBufferPool.cpp \
+    utils/FrameCopy.cpp \
     utils/GPUMemCopy.cpp \
     utils/Logger.cpp \
     AudioThread.cpp \
@@ -447,6 +455,7 @@ SOURCES += \
     AVThread.cpp \
     AudioFormat.cpp \
     AudioFrame.cpp \
+    AudioRemix.cpp \
     AudioResampler.cpp \
     AudioResamplerTemplate.cpp \
     codec/audio/AudioDecoder.cpp \
@@ -454,6 +463,7 @@ SOURCES += \
     codec/audio/AudioEncoder.cpp \
     codec/audio/AudioEncoderFFmpeg.cpp \
     codec/AVDecoder.cpp \
+    codec/DecoderPool.cpp \
     codec/AVEncoder.cpp \
     AVMuxer.cpp \
     AVDemuxer.cpp \
@@ -465,22 +475,31 @@ SOURCES += \
     filter/FilterContext.cpp \
     filter/FilterManager.cpp \
     filter/LibAVFilter.cpp \
+    filter/OverlayFilter.cpp \
+    filter/SceneChangeFilter.cpp \
+    filter/BatchVideoFilter.cpp \
     filter/SubtitleFilter.cpp \
+    filter/DeinterlaceFilter.cpp \
     filter/EncodeFilter.cpp \
+    filter/VideoEQFilter.cpp \
     ImageConverter.cpp \
     ImageConverterFF.cpp \
     Packet.cpp \
     PacketBuffer.cpp \
+    QualityGovernor.cpp \
+    BufferController.cpp \
     AVError.cpp \
     AVPlayer.cpp \
     AVPlayerPrivate.cpp \
     AVTranscoder.cpp \
     AVClock.cpp \
+    ClockGroup.cpp \
     VideoCapture.cpp \
     VideoFormat.cpp \
     VideoFrame.cpp \
     io/MediaIO.cpp \
     io/QIODeviceIO.cpp \
+    io/LiveEmuIO.cpp \
     output/audio/AudioOutput.cpp \
     output/audio/AudioOutputBackend.cpp \
     output/audio/AudioOutputNull.cpp \
@@ -511,17 +530,21 @@ SDK_HEADERS *= \
     QtAV/AudioFrame.h \
     QtAV/AudioOutput.h \
     QtAV/AVDecoder.h \
+    QtAV/DecoderPool.h \
     QtAV/AVEncoder.h \
     QtAV/AVDemuxer.h \
     QtAV/AVMuxer.h \
     QtAV/Filter.h \
     QtAV/FilterContext.h \
     QtAV/LibAVFilter.h \
+    QtAV/OverlayFilter.h \
+    QtAV/DeinterlaceFilter.h \
     QtAV/EncodeFilter.h \
     QtAV/Frame.h \
     QtAV/FrameReader.h \
     QtAV/QPainterRenderer.h \
     QtAV/Packet.h \
+    QtAV/QualityGovernor.h \
     QtAV/AVError.h \
     QtAV/AVPlayer.h \
     QtAV/AVTranscoder.h \
@@ -531,7 +554,9 @@ SDK_HEADERS *= \
     QtAV/MediaIO.h \
     QtAV/AVOutput.h \
     QtAV/AVClock.h \
+    QtAV/ClockGroup.h \
     QtAV/VideoDecoder.h \
+    QtAV/VideoEQFilter.h \
     QtAV/VideoEncoder.h \
     QtAV/VideoFormat.h \
     QtAV/VideoFrame.h \
@@ -540,6 +565,8 @@ SDK_HEADERS *= \
     QtAV/Statistics.h \
     QtAV/SubImage.h \
     QtAV/Subtitle.h \
+    QtAV/SceneChangeFilter.h \
+    QtAV/BatchVideoFilter.h \
     QtAV/SubtitleFilter.h \
     QtAV/SurfaceInterop.h \
     QtAV/version.h
@@ -575,9 +602,11 @@ HEADERS *= \
     AVThread_p.h \
     AudioThread.h \
     PacketBuffer.h \
+    BufferController.h \
     VideoThread.h \
     ImageConverter.h \
     ImageConverter_p.h \
+    AudioRemix.h \
     codec/video/VideoDecoderFFmpegBase.h \
     codec/video/VideoDecoderFFmpegHW.h \
     codec/video/VideoDecoderFFmpegHW_p.h \
@@ -585,6 +614,9 @@ HEADERS *= \
     subtitle/CharsetDetector.h \
     subtitle/PlainText.h \
     utils/BlockingQueue.h \
+    utils/ByteRing.h \
+    utils/FrameBufferPool.h \
+    utils/FrameCopy.h \
     utils/GPUMemCopy.h \
     utils/Logger.h \
     utils/SharedPtr.h \
@@ -127,10 +127,13 @@ public:
       , vol(1)
       , speed(1.0)
       , nb_buffers(kBufferCount)
+      , nb_buffers_requested(kBufferCount)
       , buffer_samples(kBufferSamples)
+      , target_latency(0)
       , features(0)
       , play_pos(0)
       , processed_remain(0)
+      , pulled(0)
       , msecs_ahead(0)
       , scale_samples(0)
       , backend(0)
@@ -161,6 +164,7 @@ public:
     void resetStatus() {
         play_pos = 0;
         processed_remain = 0;
+        pulled = backend ? backend->pulledBytes() : 0;
         msecs_ahead = 0;
 #if AO_USE_TIMER
         timer.invalidate();
@@ -181,10 +185,13 @@ public:
     AudioFormat requested;
     //AudioFrame audio_frame;
     quint32 nb_buffers;
+    quint32 nb_buffers_requested; // by setBufferCount(). nb_buffers can be changed by target_latency
     qint32 buffer_samples;
+    int target_latency;
     int features;
     int play_pos; // index or bytes
     int processed_remain;
+    int pulled; // Pull mode. backend pulled bytes when frame_infos.front() is dequeued
     int msecs_ahead;
 #if AO_USE_TIMER
     QElapsedTimer timer;
@@ -214,6 +221,12 @@ AudioOutputPrivate::~AudioOutputPrivate()
 
 void AudioOutputPrivate::playInitialData()
 {
+    // the device callback outputs silence until data is queued
+    if (backend->bufferControl() & AudioOutputBackend::Pull) {
+        pulled = backend->pulledBytes(); // the ring is reset in backend open()
+        backend->play();
+        return;
+    }
     const char c = (format.sampleFormat() == AudioFormat::SampleFormat_Unsigned8
                     || format.sampleFormat() == AudioFormat::SampleFormat_Unsigned8Planar)
             ? 0x80 : 0;
@@ -337,7 +350,11 @@ void AudioOutput::flush()
     while (!d.frame_infos.empty()) {
         if (d.backend)
             d.backend->flush();
+        const size_t n = d.frame_infos.size();
         waitForNextBuffer();
+        // Pull mode returns as soon as the ring has enough space
+        if (d.frame_infos.size() == n && d.backend && (d.backend->bufferControl() & AudioOutputBackend::Pull))
+            d.uwait(d.frame_infos.front().duration);
     }
 }
 
@@ -356,12 +373,19 @@ bool AudioOutput::open()
     Q_UNUSED(lock);
     d.available = false;
     d.paused = false;
+    if (d.target_latency > 0 && bufferSize() > 0) {
+        const int bytes = d.format.bytesForDuration(qint64(d.target_latency)*1000LL);
+        d.nb_buffers = qMax(2, (bytes + bufferSize() - 1)/bufferSize());
+    } else {
+        d.nb_buffers = d.nb_buffers_requested;
+    }
     d.resetStatus();
     if (!d.backend)
         return false;
     d.backend->audio = this;
     d.backend->buffer_size = bufferSize();
     d.backend->buffer_count = bufferCount();
+    d.backend->target_latency = d.target_latency;
     d.backend->format = audioFormat();
     // TODO: open next backend if fail and emit backendChanged()
     if (!d.backend->open())
@@ -383,6 +407,8 @@ bool AudioOutput::close()
     d.resetStatus();
     if (!d.backend)
         return false;
+    if ((d.backend->bufferControl() & AudioOutputBackend::Pull) && d.backend->underruns() > 0)
+        qDebug("audio device underruns: %d", d.backend->underruns());
     // TODO: drain() before close
     d.backend->audio = 0;
     return d.backend->close();
@@ -444,7 +470,29 @@ bool AudioOutput::receiveData(const QByteArray &data, qreal pts)
         return false;
     }
     d.frame_infos.push_back(AudioOutputPrivate::FrameInfo(queue_data, pts, d.format.durationForBytes(queue_data.size())));
-    return d.backend->write(queue_data); // backend is not null here
+    if (!(d.backend->bufferControl() & AudioOutputBackend::Pull))
+        return d.backend->write(queue_data); // backend is not null here
+    // Pull mode: the frame can be larger than the ring. queue the part fits and wait for the device to pull the rest
+    int offset = 0;
+    qint64 waited = 0;
+    while (offset < queue_data.size()) {
+        const int n = qMin(queue_data.size() - offset, d.backend->ringWritable());
+        if (n > 0) {
+            if (!d.backend->write(QByteArray::fromRawData(queue_data.constData() + offset, n)))
+                return false;
+            offset += n;
+            waited = 0;
+            continue;
+        }
+        if (!d.available || waited > 1000000LL) {
+            qWarning("audio device does not pull data. %d bytes dropped", queue_data.size() - offset);
+            return false;
+        }
+        const qint64 us = qMax<qint64>(1000LL, d.format.durationForBytes(qMin(queue_data.size() - offset, d.backend->ringSize()/2)));
+        d.uwait(us);
+        waited += us;
+    }
+    return true;
 }
 
 AudioFormat AudioOutput::setAudioFormat(const AudioFormat& format)
@@ -581,6 +629,28 @@ int AudioOutput::bufferCount() const
 void AudioOutput::setBufferCount(int value)
 {
     d_func().nb_buffers = value;
+    d_func().nb_buffers_requested = value;
+}
+
+void AudioOutput::setTargetLatency(int ms)
+{
+    d_func().target_latency = qMax(0, ms);
+}
+
+int AudioOutput::targetLatency() const
+{
+    return d_func().target_latency;
+}
+
+qreal AudioOutput::deviceLatency() const
+{
+    DPTR_D(const AudioOutput);
+    if (!d.backend || !d.available)
+        return -1.0;
+    const qreal t = d.backend->getLatency();
+    if (t < 0 || !(d.backend->bufferControl() & AudioOutputBackend::Pull))
+        return t;
+    return t + qreal(d.format.durationForBytes(d.backend->ringReadable()))/1000000.0;
 }
 
 // no virtual functions inside because it can be called in ctor
@@ -699,6 +769,36 @@ bool AudioOutput::waitForNextBuffer() // parameter bool wait: if no wait and no
         }
         // what if c always 0?
         remove = c;
+    } else if (f & AudioOutputBackend::Pull) {
+        // the callback does not wake us up because QWaitCondition requires a lock. sleep for the duration of missing space
+#if AO_USE_TIMER
+        d.timer.restart();
+#endif //AO_USE_TIMER
+        // a frame larger than the ring is written in parts by receiveData()
+        const int next = qMin(fi.data.size(), d.backend->ringSize());
+        int writable = d.backend->ringWritable();
+        while (writable < next) {
+            d.uwait(qMax<qint64>(1000LL, d.format.durationForBytes(next - writable)));
+#if AO_USE_TIMER
+            if (!d.timer.isValid()) {
+                qWarning("invalid timer. closed in another thread");
+                return false;
+            }
+            if (d.timer.elapsed() > 1000)
+                return false;
+#endif //AO_USE_TIMER
+            writable = d.backend->ringWritable();
+        }
+        // dequeue the frames pulled by the device, keep the bytes of a partially pulled frame
+        const int pulled = d.backend->pulledBytes();
+        int free_bytes = d.processed_remain + (pulled - d.pulled);
+        d.pulled = pulled;
+        while (!d.frame_infos.empty() && free_bytes >= d.frame_infos.front().data.size()) {
+            free_bytes -= d.frame_infos.front().data.size();
+            d.frame_infos.pop_front();
+        }
+        d.processed_remain = d.frame_infos.empty() ? 0 : free_bytes;
+        return true;
     } else if (f & AudioOutputBackend::OffsetBytes) { //TODO: similar to Callback+getWritableBytes()
         int s = d.backend->getOffsetByBytes();
         int processed = s - d.play_pos;
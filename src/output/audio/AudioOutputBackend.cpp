@@ -21,6 +21,7 @@
 
 #include "QtAV/private/AudioOutputBackend.h"
 #include "QtAV/private/factory.h"
+#include "utils/ByteRing.h"
 #include "utils/Logger.h"
 
 namespace QtAV {
@@ -59,9 +60,21 @@ AudioOutputBackend::AudioOutputBackend(AudioOutput::DeviceFeatures f, QObject *p
     , available(true)
     , buffer_size(0)
     , buffer_count(0)
+    , target_latency(0)
     , m_features(f)
+    , m_ring(0)
+    , m_silence(0)
+    , m_starving(false)
 {}
 
+AudioOutputBackend::~AudioOutputBackend()
+{
+    if (m_ring) {
+        delete m_ring;
+        m_ring = 0;
+    }
+}
+
 void AudioOutputBackend::onCallback()
 {
     if (!audio)
@@ -69,6 +82,68 @@ void AudioOutputBackend::onCallback()
     audio->onCallback();
 }
 
+void AudioOutputBackend::resetRing()
+{
+    if (!m_ring)
+        m_ring = new ByteRing();
+    m_ring->reset(buffer_size*buffer_count);
+    m_silence = format.isUnsigned() && !format.isFloat() ? char(0x80) : 0;
+    m_pulled = 0;
+    m_underruns = 0;
+    m_starving = false;
+}
+
+bool AudioOutputBackend::writeRing(const QByteArray &data)
+{
+    if (!m_ring)
+        return false;
+    // AudioOutput waits for enough space in the ring
+    const int n = m_ring->write(data.constData(), data.size());
+    if (n < data.size())
+        qWarning("audio ring overflow. %d bytes dropped", data.size() - n);
+    return n > 0;
+}
+
+int AudioOutputBackend::pull(void *dst, int bytes)
+{
+    char *d = (char*)dst;
+    const int n = m_ring ? m_ring->read(d, bytes) : 0;
+    if (n < bytes)
+        memset(d + n, m_silence, bytes - n);
+    // count an underrun when data comes again. no data yet or drained at the end of stream is not an underrun
+    if (n > 0) {
+        if (m_starving)
+            m_underruns.ref();
+        m_pulled.fetchAndAddRelease(n);
+    }
+    m_starving = n < bytes && (n > 0 || m_pulled.fetchAndAddRelaxed(0) != 0);
+    return n;
+}
+
+int AudioOutputBackend::ringSize() const
+{
+    return m_ring ? m_ring->capacity() : 0;
+}
+
+int AudioOutputBackend::ringWritable() const
+{
+    return m_ring ? m_ring->writable() : 0;
+}
+
+int AudioOutputBackend::ringReadable() const
+{
+    return m_ring ? m_ring->readable() : 0;
+}
+
+int AudioOutputBackend::pulledBytes() const
+{
+    return m_pulled.fetchAndAddAcquire(0);
+}
+
+int AudioOutputBackend::underruns() const
+{
+    return m_underruns.fetchAndAddAcquire(0);
+}
 
 FACTORY_DEFINE(AudioOutputBackend)
 
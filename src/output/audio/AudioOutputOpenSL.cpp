@@ -20,7 +20,6 @@
 ******************************************************************************/
 
 #include "QtAV/private/AudioOutputBackend.h"
-#include <QtCore/QSemaphore>
 #include <QtCore/QThread>
 #include <SLES/OpenSLES.h>
 #ifdef Q_OS_ANDROID
@@ -62,12 +61,9 @@ public:
     bool open() Q_DECL_OVERRIDE;
     bool close() Q_DECL_OVERRIDE;
     BufferControl bufferControl() const Q_DECL_OVERRIDE;
-    void onCallback() Q_DECL_OVERRIDE;
-    void acquireNextBuffer() Q_DECL_OVERRIDE;
     bool write(const QByteArray& data) Q_DECL_OVERRIDE;
     bool play() Q_DECL_OVERRIDE;
-    //default return -1. means not the control
-    int getPlayedCount() Q_DECL_OVERRIDE;
+    qreal getLatency() Q_DECL_OVERRIDE;
     bool setVolume(qreal value) Q_DECL_OVERRIDE;
     qreal getVolume() const Q_DECL_OVERRIDE;
     bool setMute(bool value = true) Q_DECL_OVERRIDE;
@@ -79,6 +75,9 @@ public:
     static void playCallback(SLPlayItf player, void *ctx, SLuint32 event);
 private:
     SLDataFormat_PCM_EX audioFormatToSL(const AudioFormat &format);
+    int queuedCount() const;
+    // pull the next device buffer from the ring and enqueue it. called in buffer queue callback, or in play() to start
+    bool enqueuePulled();
 
     SLObjectItf engineObject;
     SLEngineItf engine;
@@ -95,10 +94,9 @@ private:
     int m_android_api_level;
     SLint16 m_sl_major, m_sl_minor, m_sl_step;
     SLint32 m_streamType;
-    quint32 buffers_queued;
-    QSemaphore sem;
 
-    // Enqueue does not copy data. We MUST keep the data until it is played out
+    // Enqueue does not copy data. kDeviceBuffers buffers of buffer_size are pulled and enqueued in turn
+    enum { kDeviceBuffers = 2 };
     int queue_data_write;
     QByteArray queue_data;
 };
@@ -152,10 +150,10 @@ void AudioOutputOpenSL::bufferQueueCallbackAndroid(SLAndroidSimpleBufferQueueItf
     (*bufferQueue)->GetState(bufferQueue, &state);
     qDebug(">>>>>>>>>>>>>>bufferQueueCallback state.count=%lu .playIndex=%lu", state.count, state.playIndex);
 #endif
+    Q_UNUSED(bufferQueue);
+    // a buffer is played out. real-time thread: no lock, no allocation
     AudioOutputOpenSL *ao = reinterpret_cast<AudioOutputOpenSL*>(context);
-    if (ao->bufferControl() & AudioOutputBackend::CountCallback) {
-        ao->onCallback();
-    }
+    ao->enqueuePulled();
 }
 #endif
 void AudioOutputOpenSL::bufferQueueCallback(SLBufferQueueItf bufferQueue, void *context)
@@ -165,10 +163,9 @@ void AudioOutputOpenSL::bufferQueueCallback(SLBufferQueueItf bufferQueue, void *
     (*bufferQueue)->GetState(bufferQueue, &state);
     qDebug(">>>>>>>>>>>>>>bufferQueueCallback state.count=%lu .playIndex=%lu", state.count, state.playIndex);
 #endif
+    Q_UNUSED(bufferQueue);
     AudioOutputOpenSL *ao = reinterpret_cast<AudioOutputOpenSL*>(context);
-    if (ao->bufferControl() & AudioOutputBackend::CountCallback) {
-        ao->onCallback();
-    }
+    ao->enqueuePulled();
 }
 
 void AudioOutputOpenSL::playCallback(SLPlayItf player, void *ctx, SLuint32 event)
@@ -195,7 +192,6 @@ AudioOutputOpenSL::AudioOutputOpenSL(QObject *parent)
     , m_sl_minor(0)
     , m_sl_step(0)
     , m_streamType(-1)
-    , buffers_queued(0)
     , queue_data_write(0)
 {
 #ifdef Q_OS_ANDROID
@@ -246,29 +242,52 @@ bool AudioOutputOpenSL::isSupported(AudioFormat::ChannelLayout channelLayout) co
 
 AudioOutputBackend::BufferControl AudioOutputOpenSL::bufferControl() const
 {
-    return CountCallback;//BufferControl(Callback | PlayedCount);
+    return Pull;
 }
 
-void AudioOutputOpenSL::onCallback()
+int AudioOutputOpenSL::queuedCount() const
 {
-    if (bufferControl() & CountCallback)
-        sem.release();
+#ifdef Q_OS_ANDROID
+    if (m_android) {
+        SLAndroidSimpleBufferQueueState state;
+        (*m_bufferQueueItf_android)->GetState(m_bufferQueueItf_android, &state);
+        return state.count;
+    }
+#endif
+    SLBufferQueueState state;
+    (*m_bufferQueueItf)->GetState(m_bufferQueueItf, &state);
+    return state.count;
 }
 
-void AudioOutputOpenSL::acquireNextBuffer()
+bool AudioOutputOpenSL::enqueuePulled()
 {
-    if (bufferControl() & CountCallback)
-        sem.acquire();
+    if (queue_data.isEmpty())
+        return false;
+    // the buffer played out longest ago
+    char *buf = (char*)queue_data.constData() + queue_data_write;
+    pull(buf, buffer_size);
+    queue_data_write += buffer_size;
+    if (queue_data_write >= queue_data.size())
+        queue_data_write = 0;
+#ifdef Q_OS_ANDROID
+    if (m_android)
+        SL_ENSURE((*m_bufferQueueItf_android)->Enqueue(m_bufferQueueItf_android, buf, buffer_size), false);
+    else
+#endif
+    SL_ENSURE((*m_bufferQueueItf)->Enqueue(m_bufferQueueItf, buf, buffer_size), false);
+    return true;
 }
 
 bool AudioOutputOpenSL::open()
 {
-    queue_data.resize(buffer_size*buffer_count);
-    SLDataLocator_BufferQueue bufferQueueLocator = { SL_DATALOCATOR_BUFFERQUEUE, (SLuint32)buffer_count };
+    resetRing();
+    queue_data.resize(buffer_size*kDeviceBuffers);
+    queue_data_write = 0;
+    SLDataLocator_BufferQueue bufferQueueLocator = { SL_DATALOCATOR_BUFFERQUEUE, (SLuint32)kDeviceBuffers };
     SLDataFormat_PCM_EX pcmFormat = audioFormatToSL(format);
     SLDataSource audioSrc = { &bufferQueueLocator, &pcmFormat };
 #ifdef Q_OS_ANDROID
-    SLDataLocator_AndroidSimpleBufferQueue bufferQueueLocator_android = { SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, (SLuint32)buffer_count };
+    SLDataLocator_AndroidSimpleBufferQueue bufferQueueLocator_android = { SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, (SLuint32)kDeviceBuffers };
     if (m_android)
         audioSrc.pLocator = &bufferQueueLocator_android;
 #endif
@@ -325,11 +344,7 @@ bool AudioOutputOpenSL::open()
     // Volume interface
     //SL_ENSURE((*m_playerObject)->GetInterface(m_playerObject, SL_IID_VOLUME, &m_volumeItf), false);
 
-    /*
-     * DO NOT call sem.release(buffer_count - sem.available()) because playInitialData() will enqueue buffers and then sem.release() is called in callback.
-     * Otherwise, Enqueue() the 1st(or more) real buffer may report SL_RESULT_BUFFER_INSUFFICIENT and noise will be played.
-     * Can not Enqueue() internally here because buffers are managed in AudioOutput to ensure 0-copy
-     */
+    // device buffers are enqueued in play(), then in the buffer queue callback
     return true;
 }
 
@@ -367,24 +382,7 @@ bool AudioOutputOpenSL::close()
 
 bool AudioOutputOpenSL::write(const QByteArray& data)
 {
-    // assume data.size() <= buffer_size. It's true in QtAV
-    const int s = qMin(queue_data.size() - queue_data_write, data.size());
-    // assume data.size() <= buffer_size. It's true in QtAV
-    if (s < data.size())
-        queue_data_write = 0;
-    memcpy((char*)queue_data.constData() + queue_data_write, data.constData(), data.size());
-    //qDebug("enqueue %p, queue_data_write: %d/%d available:%d", data.constData(), queue_data_write, queue_data.size(), sem.available());
-#ifdef Q_OS_ANDROID
-    if (m_android)
-        SL_ENSURE((*m_bufferQueueItf_android)->Enqueue(m_bufferQueueItf_android, queue_data.constData() + queue_data_write, data.size()), false);
-    else
-#endif
-    SL_ENSURE((*m_bufferQueueItf)->Enqueue(m_bufferQueueItf, queue_data.constData() + queue_data_write, data.size()), false);
-    buffers_queued++;
-    queue_data_write += data.size();
-    if (queue_data_write == queue_data.size())
-        queue_data_write = 0;
-    return true;
+    return writeRing(data);
 }
 
 bool AudioOutputOpenSL::play()
@@ -393,29 +391,21 @@ bool AudioOutputOpenSL::play()
     (*m_playItf)->GetPlayState(m_playItf, &state);
     if (state == SL_PLAYSTATE_PLAYING)
         return true;
+    // start the callbacks. silence is pulled if no data is queued yet
+    if (queuedCount() == 0) {
+        for (int i = 0; i < kDeviceBuffers; ++i) {
+            if (!enqueuePulled())
+                return false;
+        }
+    }
     SL_ENSURE((*m_playItf)->SetPlayState(m_playItf, SL_PLAYSTATE_PLAYING), false);
     return true;
 }
 
-int AudioOutputOpenSL::getPlayedCount()
+qreal AudioOutputOpenSL::getLatency()
 {
-    int processed = buffers_queued;
-    SLuint32 count = 0;
-#ifdef Q_OS_ANDROID
-    if (m_android) {
-        SLAndroidSimpleBufferQueueState state;
-        (*m_bufferQueueItf_android)->GetState(m_bufferQueueItf_android, &state);
-        count = state.count;
-    } else
-#endif
-    {
-        SLBufferQueueState state;
-        (*m_bufferQueueItf)->GetState(m_bufferQueueItf, &state);
-        count = state.count;
-    }
-    buffers_queued = count;
-    processed -= count;
-    return processed;
+    // the pulled buffer is played after the other enqueued buffers. mixer latency is unknown
+    return qreal(format.durationForBytes(buffer_size*(kDeviceBuffers - 1)))/1000000.0;
 }
 
 bool AudioOutputOpenSL::setVolume(qreal value)
@@ -39,12 +39,16 @@ public:
     bool close() Q_DECL_FINAL;
     virtual BufferControl bufferControl() const Q_DECL_FINAL;
     virtual bool write(const QByteArray& data) Q_DECL_FINAL;
-    virtual bool play() Q_DECL_FINAL { return true;}
+    virtual bool play() Q_DECL_FINAL;
+    qreal getLatency() Q_DECL_FINAL;
 private:
+    static int streamCallback(const void *input, void *output, unsigned long frameCount, const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags, void *userData);
+
     bool initialized;
     PaStreamParameters *outputParameters;
     PaStream *stream;
     double outputLatency;
+    volatile double callbackLatency; // measured in callback from the device clock
 };
 
 typedef AudioOutputPortAudio AudioOutputBackendPortAudio;
@@ -56,6 +60,8 @@ AudioOutputPortAudio::AudioOutputPortAudio(QObject *parent)
     , initialized(false)
     , outputParameters(new PaStreamParameters)
     , stream(0)
+    , outputLatency(0)
+    , callbackLatency(-1)
 {
     PaError err = paNoError;
     if ((err = Pa_Initialize()) != paNoError) {
@@ -97,21 +103,48 @@ AudioOutputPortAudio::~AudioOutputPortAudio()
 
 AudioOutputBackend::BufferControl AudioOutputPortAudio::bufferControl() const
 {
-    return Blocking;
+    return Pull;
 }
 
 bool AudioOutputPortAudio::write(const QByteArray& data)
 {
-    if (Pa_IsStreamStopped(stream))
-        Pa_StartStream(stream);
-    PaError err = Pa_WriteStream(stream, data.constData(), data.size()/format.channels()/format.bytesPerSample());
-    if (err == paUnanticipatedHostError) {
-        qWarning("Write portaudio stream error: %s", Pa_GetErrorText(err));
-        return   false;
+    return writeRing(data);
+}
+
+bool AudioOutputPortAudio::play()
+{
+    if (!stream)
+        return false;
+    if (!Pa_IsStreamStopped(stream))
+        return true;
+    PaError err = Pa_StartStream(stream);
+    if (err != paNoError) {
+        qWarning("Start portaudio stream error: %s", Pa_GetErrorText(err));
+        return false;
     }
     return true;
 }
 
+qreal AudioOutputPortAudio::getLatency()
+{
+    const double t = callbackLatency;
+    if (t >= 0)
+        return t;
+    return outputLatency;
+}
+
+int AudioOutputPortAudio::streamCallback(const void *input, void *output, unsigned long frameCount, const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags, void *userData)
+{
+    Q_UNUSED(input);
+    Q_UNUSED(statusFlags);
+    // real-time thread: no lock, no allocation
+    AudioOutputPortAudio *ao = reinterpret_cast<AudioOutputPortAudio*>(userData);
+    ao->pull(output, int(frameCount)*ao->format.bytesPerFrame());
+    if (timeInfo && timeInfo->outputBufferDacTime > timeInfo->currentTime)
+        ao->callbackLatency = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+    return paContinue;
+}
+
 //TODO: what about planar, int8, int24 etc that FFmpeg or Pa not support?
 static int toPaSampleFormat(AudioFormat::SampleFormat format)
 {
@@ -134,7 +167,13 @@ bool AudioOutputPortAudio::open()
 {
     outputParameters->sampleFormat = toPaSampleFormat(format.sampleFormat());
     outputParameters->channelCount = format.channels();
-    PaError err = Pa_OpenStream(&stream, NULL, outputParameters, format.sampleRate(), 0, paNoFlag, NULL, NULL);
+    if (target_latency > 0)
+        outputParameters->suggestedLatency = qreal(target_latency)/1000.0;
+    else
+        outputParameters->suggestedLatency = Pa_GetDeviceInfo(outputParameters->device)->defaultHighOutputLatency;
+    resetRing();
+    callbackLatency = -1;
+    PaError err = Pa_OpenStream(&stream, NULL, outputParameters, format.sampleRate(), paFramesPerBufferUnspecified, paNoFlag, AudioOutputPortAudio::streamCallback, this);
     if (err != paNoError) {
         qWarning("Open portaudio stream error: %s", Pa_GetErrorText(err));
         return false;
@@ -46,7 +46,7 @@ protected:
     bool write(const QByteArray& data) Q_DECL_FINAL;
     bool play() Q_DECL_FINAL;
     BufferControl bufferControl() const Q_DECL_FINAL;
-    int getWritableBytes() Q_DECL_FINAL;
+    qreal getLatency() Q_DECL_FINAL;
 
     bool setVolume(qreal value) Q_DECL_FINAL;
     qreal getVolume() const Q_DECL_FINAL;
@@ -62,6 +62,8 @@ private:
     static void writeCallback(pa_stream *s, size_t length, void *userdata);
     static void  successCallback(pa_stream*s, int success, void *userdata);
     static void sinkInfoCallback(struct pa_context *c, const struct pa_sink_input_info *i, int is_last, void *userdata);
+    // write the data requested by server from the ring. MUST be called with the mainloop lock, so pull() is never called concurrently
+    void writeRequested();
 
     bool waitPAOperation(pa_operation *op) const {
         if (!op) {
@@ -80,7 +82,8 @@ private:
     pa_context *ctx;
     pa_stream *stream;
     pa_sink_input_info info;
-    size_t writable_size; //has the same effect as pa_stream_writable_size
+    size_t writable_size; // requested by server and not written yet
+    bool data_started; // silence is written for the requests only after the first data, otherwise it delays the start
 };
 
 typedef AudioOutputPulse AudioOutputBackendPulse;
@@ -220,11 +223,37 @@ void AudioOutputPulse::latencyUpdateCallback(pa_stream *s, void *userdata)
 void AudioOutputPulse::writeCallback(pa_stream *s, size_t length, void *userdata)
 {
     Q_UNUSED(s);
-    // length: writable bytes. callback is called pirioddically
+    // length: writable bytes requested by server. called in mainloop thread with the lock
     AudioOutputPulse *p = reinterpret_cast<AudioOutputPulse*>(userdata);
     //qDebug("write callback: %d + %d", p->writable_size, length);
     p->writable_size = length;
-    p->onCallback();
+    p->writeRequested();
+}
+
+void AudioOutputPulse::writeRequested()
+{
+    if (!stream || writable_size == 0)
+        return;
+    size_t n = writable_size;
+    if (!data_started) {
+        // the request is served by write() when data comes. no other request until then
+        n = qMin<size_t>(n, ringReadable());
+        if (n == 0)
+            return;
+        data_started = true;
+    }
+    void *buf = 0;
+    if (pa_stream_begin_write(stream, &buf, &n) < 0 || !buf || n == 0) {
+        qWarning("PulseAudio error pa_stream_begin_write: %s", pa_strerror(pa_context_errno(ctx)));
+        return;
+    }
+    // silence for underrun, so the server keeps requesting data
+    pull(buf, int(n));
+    if (pa_stream_write(stream, buf, n, NULL, 0LL, PA_SEEK_RELATIVE) < 0) {
+        qWarning("PulseAudio error pa_stream_write: %s", pa_strerror(pa_context_errno(ctx)));
+        return;
+    }
+    writable_size -= qMin(writable_size, n);
 }
 
 void AudioOutputPulse::successCallback(pa_stream *s, int success, void *userdata)
@@ -251,6 +280,8 @@ void AudioOutputPulse::sinkInfoCallback(pa_context *c, const pa_sink_input_info
 bool AudioOutputPulse::init(const AudioFormat &format)
 {
     writable_size = 0;
+    data_started = false;
+    resetRing();
     loop = pa_threaded_mainloop_new();
     if (pa_threaded_mainloop_start(loop) < 0) {
         qWarning("PulseAudio failed to start mainloop");
@@ -317,13 +348,19 @@ bool AudioOutputPulse::init(const AudioFormat &format)
     pa_stream_set_latency_update_callback(stream, AudioOutputPulse::latencyUpdateCallback, this);
 
     pa_buffer_attr ba;
-    ba.maxlength = PA_STREAM_ADJUST_LATENCY;//-1;//buffer_size*buffer_count; // max buffer size on the server
-    ba.tlength = PA_STREAM_ADJUST_LATENCY;//(uint32_t)-1; // ?
+    ba.maxlength = (uint32_t)-1; // max buffer size on the server. default
+    // requests are filled with silence on underrun. limit the server buffer to the ring size, so the silence is short
+    ba.tlength = (uint32_t)ringSize();
     ba.prebuf = 1;//(uint32_t)-1; // play as soon as possible
     ba.minreq = (uint32_t)-1;
     //ba.fragsize = (uint32_t)-1; //latency
     // PA_STREAM_NOT_MONOTONIC?
     pa_stream_flags_t flags = pa_stream_flags_t(PA_STREAM_NOT_MONOTONIC|PA_STREAM_INTERPOLATE_TIMING|PA_STREAM_AUTO_TIMING_UPDATE);
+    if (target_latency > 0) {
+        // the server configures the sink latency to tlength
+        ba.tlength = format.bytesForDuration(qint64(target_latency)*1000LL);
+        flags = pa_stream_flags_t(flags|PA_STREAM_ADJUST_LATENCY);
+    }
     if (pa_stream_connect_playback(stream, NULL /*sink*/, &ba, flags, NULL, NULL) < 0) {
         qWarning("PulseAudio failed: pa_stream_connect_playback");
         return false;
@@ -355,6 +392,7 @@ AudioOutputPulse::AudioOutputPulse(QObject *parent)
     , ctx(0)
     , stream(0)
     , writable_size(0)
+    , data_started(false)
 {
     //setDeviceFeatures(DeviceFeatures()|SetVolume|SetMute);
 }
@@ -384,6 +422,8 @@ bool AudioOutputPulse::close()
     if (stream) {
         ScopedPALocker palock(loop);
         Q_UNUSED(palock);
+        // no more silence for requests, otherwise drain never finishes
+        pa_stream_set_write_callback(stream, NULL, NULL);
         PA_ENSURE_TRUE(waitPAOperation(pa_stream_drain(stream,  AudioOutputPulse::successCallback, this)), false);
     }
     if (loop) {
@@ -408,27 +448,31 @@ bool AudioOutputPulse::close()
 
 AudioOutputBackend::BufferControl AudioOutputPulse::bufferControl() const
 {
-    return BytesCallback;
+    return Pull;
 }
 
-int AudioOutputPulse::getWritableBytes()
+qreal AudioOutputPulse::getLatency()
 {
-    //return writable_size;
-    if (!loop || !stream) {
-        qWarning("pulseaudio is not open");
-        return 0;
-    }
+    if (!loop || !stream)
+        return -1.0;
     ScopedPALocker palock(loop);
     Q_UNUSED(palock);
-    return pa_stream_writable_size(stream);
+    pa_usec_t usec = 0;
+    int negative = 0;
+    // written but not played data + sink latency. interpolated by PA_STREAM_INTERPOLATE_TIMING
+    if (pa_stream_get_latency(stream, &usec, &negative) < 0)
+        return -1.0;
+    return negative ? 0.0 : qreal(usec)/1000000.0;
 }
 
 bool AudioOutputPulse::write(const QByteArray &data)
 {
+    if (!writeRing(data))
+        return false;
     ScopedPALocker palock(loop);
     Q_UNUSED(palock);
-    PA_ENSURE_TRUE(pa_stream_write(stream, data.constData(), data.size(), NULL, 0LL, PA_SEEK_RELATIVE) >= 0, false);
-    writable_size -= data.size();
+    if (!data_started) // later requests are written by callback
+        writeRequested();
     return true;
 }
 
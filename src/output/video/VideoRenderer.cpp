@@ -490,7 +490,8 @@ void VideoRenderer::handlePaintEvent()
                 //if (!vf->context() || vf->context()->type() != VideoFilterContext::OpenGL)
                 if (!vf->isSupported(VideoFilterContext::OpenGL))
                     continue;
-                vf->apply(d.statistics, &d.video_frame); //painter and paint device are ready, pass video frame is ok.
+                if (!vf->apply(d.statistics, &d.video_frame)) //painter and paint device are ready, pass video frame is ok.
+                    break; // discarded by filter
                 d.video_frame.setMetaData(QStringLiteral("gpu_filtered"), true);
             }
         }
@@ -0,0 +1,93 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_BYTERING_H
+#define QTAV_BYTERING_H
+
+#include <string.h>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+
+namespace QtAV {
+/*!
+ * \brief The ByteRing class
+ * Single producer single consumer lock-free byte ring. read() and write() never lock or allocate, so read() can be
+ * called in a real-time audio callback while another thread calls write().
+ * Positions are free running counters, the capacity is rounded up to a power of 2.
+ * reset() is not thread safe.
+ */
+class ByteRing
+{
+public:
+    explicit ByteRing(int capacity = 0) { reset(capacity);}
+    void reset(int capacity) {
+        int c = 1;
+        while (c < capacity)
+            c <<= 1;
+        m_data.fill(0, capacity > 0 ? c : 0);
+        m_mask = capacity > 0 ? c - 1 : 0;
+        m_r = 0;
+        m_w = 0;
+    }
+    int capacity() const { return m_data.size();}
+    // can be called from both side
+    int readable() const { return int(quint32(m_w.fetchAndAddAcquire(0)) - quint32(m_r.fetchAndAddAcquire(0)));}
+    int writable() const { return capacity() - readable();}
+    /// producer. \return bytes written, less than \a bytes if no enough space
+    int write(const char* src, int bytes) {
+        const quint32 w = quint32(m_w.fetchAndAddAcquire(0));
+        const int n = qMin(bytes, capacity() - int(w - quint32(m_r.fetchAndAddAcquire(0))));
+        if (n <= 0)
+            return 0;
+        copy(m_data.data(), w, src, n, true);
+        m_w.fetchAndAddRelease(n);
+        return n;
+    }
+    /// consumer. \return bytes read, less than \a bytes if no enough data
+    int read(char* dst, int bytes) {
+        const quint32 r = quint32(m_r.fetchAndAddAcquire(0));
+        const int n = qMin(bytes, int(quint32(m_w.fetchAndAddAcquire(0)) - r));
+        if (n <= 0)
+            return 0;
+        copy(dst, r, m_data.constData(), n, false);
+        m_r.fetchAndAddRelease(n);
+        return n;
+    }
+private:
+    // copy n bytes into (to_ring) or out of the ring at position pos
+    void copy(char* dst, quint32 pos, const char* src, int n, bool to_ring) const {
+        const int i = int(pos & m_mask);
+        const int n1 = qMin(n, capacity() - i);
+        if (to_ring) {
+            memcpy(dst + i, src, n1);
+            memcpy(dst, src + n1, n - n1);
+        } else {
+            memcpy(dst, src + i, n1);
+            memcpy(dst + n1, src, n - n1);
+        }
+    }
+
+    QByteArray m_data;
+    quint32 m_mask;
+    mutable QAtomicInt m_r, m_w;
+};
+} //namespace QtAV
+#endif // QTAV_BYTERING_H
@@ -0,0 +1,163 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "FrameBufferPool.h"
+#include <limits.h>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include "QtAV/QtAV_Global.h"
+
+namespace QtAV {
+namespace {
+static const int kMinClassShift = 12; // 4KB
+static const int kClassesPerShift = 4;
+static const int kMaxClasses = (31 - kMinClassShift)*kClassesPerShift + 1;
+static const int kMaxBlocksPerClass = 16; // decoder output + frame queue + renderer
+static const qint64 kMaxCachedBytes = 256*1024*1024; // about 20 4k nv12 frames
+
+// returns the class index and sets the class size in *classSize
+static int sizeClass(int size, int *classSize)
+{
+    if (size <= (1 << kMinClassShift)) {
+        *classSize = 1 << kMinClassShift;
+        return 0;
+    }
+    int k = kMinClassShift; // 2^k < size <= 2^(k+1)
+    while (((size - 1) >> (k + 1)) != 0)
+        ++k;
+    const int step = 1 << (k - 2);
+    const qint64 rounded = ((qint64)size + step - 1) & ~(qint64)(step - 1); // (2^k, 2^(k+1)]
+    const int m = int(rounded >> (k - 2)); // 5, 6, 7, 8
+    if (rounded > INT_MAX)
+        return -1;
+    *classSize = (int)rounded;
+    return (k - kMinClassShift)*kClassesPerShift + m - 4;
+}
+
+class Pool
+{
+public:
+    Pool() : hits(0), misses(0), cached_bytes(0) { free_list.resize(kMaxClasses);}
+    ~Pool() { clear();}
+    uchar* take(int index, int classSize) {
+        QMutexLocker lock(&mutex);
+        QVector<uchar*> &list = free_list[index];
+        if (list.isEmpty()) {
+            ++misses;
+            return NULL;
+        }
+        ++hits;
+        cached_bytes -= classSize;
+        uchar *p = list.last();
+        list.pop_back();
+        return p;
+    }
+    bool put(int index, int classSize, uchar *p) {
+        QMutexLocker lock(&mutex);
+        QVector<uchar*> &list = free_list[index];
+        if (list.size() >= kMaxBlocksPerClass || cached_bytes + classSize > kMaxCachedBytes)
+            return false;
+        list.append(p);
+        cached_bytes += classSize;
+        return true;
+    }
+    void miss() {
+        QMutexLocker lock(&mutex);
+        ++misses;
+    }
+    void clear() {
+        QMutexLocker lock(&mutex);
+        for (int i = 0; i < free_list.size(); ++i) {
+            foreach (uchar *p, free_list[i]) {
+                qFreeAligned(p);
+            }
+            free_list[i].clear();
+        }
+        cached_bytes = 0;
+    }
+
+    QMutex mutex;
+    QVector<QVector<uchar*> > free_list;
+    qint64 hits, misses;
+    qint64 cached_bytes;
+};
+} //namespace
+
+Q_GLOBAL_STATIC(Pool, frameBufferPool)
+
+FrameBuffer::~FrameBuffer()
+{
+    int classSize = 0;
+    const int index = sizeClass(m_capacity, &classSize);
+    Pool *pool = frameBufferPool(); // null if the pool is destroyed at exit
+    if (!pool || index < 0 || !pool->put(index, classSize, m_data))
+        qFreeAligned(m_data);
+}
+
+FrameBufferRef FrameBufferPool::get(int size)
+{
+    if (size <= 0)
+        return FrameBufferRef();
+    int classSize = 0;
+    const int index = sizeClass(size, &classSize);
+    Pool *pool = frameBufferPool();
+    uchar *p = NULL;
+    if (index >= 0 && pool)
+        p = pool->take(index, classSize);
+    else if (pool)
+        pool->miss();
+    if (!p) {
+        const int alloc_size = index >= 0 ? classSize : size;
+        p = (uchar*)qMallocAligned(alloc_size, Alignment);
+        if (!p) {
+            qWarning("FrameBufferPool: failed to allocate %d bytes", alloc_size);
+            return FrameBufferRef();
+        }
+        classSize = alloc_size;
+    }
+    return FrameBufferRef(new FrameBuffer(p, size, classSize));
+}
+
+void FrameBufferPool::stats(qint64 *hits, qint64 *misses, qint64 *cachedBytes)
+{
+    Pool *pool = frameBufferPool();
+    qint64 h = 0, m = 0, c = 0;
+    if (pool) {
+        QMutexLocker lock(&pool->mutex);
+        h = pool->hits;
+        m = pool->misses;
+        c = pool->cached_bytes;
+    }
+    if (hits)
+        *hits = h;
+    if (misses)
+        *misses = m;
+    if (cachedBytes)
+        *cachedBytes = c;
+}
+
+void FrameBufferPool::clear()
+{
+    Pool *pool = frameBufferPool();
+    if (pool)
+        pool->clear();
+}
+} //namespace QtAV
@@ -0,0 +1,69 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_FRAMEBUFFERPOOL_H
+#define QTAV_FRAMEBUFFERPOOL_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QSharedPointer>
+
+namespace QtAV {
+
+/*!
+ * \brief The FrameBuffer class
+ * A 64 bytes aligned host memory block from FrameBufferPool. The memory is not initialized.
+ * It is returned to the pool when the last reference is released.
+ */
+class FrameBuffer
+{
+    Q_DISABLE_COPY(FrameBuffer)
+public:
+    FrameBuffer(uchar* data, int size, int capacity) : m_data(data), m_size(size), m_capacity(capacity) {}
+    ~FrameBuffer();
+    uchar* data() const { return m_data;}
+    int size() const { return m_size;}
+    int capacity() const { return m_capacity;}
+    /// a QByteArray referencing the block without copy. it is valid as long as the block is referenced
+    QByteArray toByteArray() const { return QByteArray::fromRawData((const char*)m_data, m_size);}
+private:
+    uchar *m_data;
+    int m_size;
+    int m_capacity;
+};
+typedef QSharedPointer<FrameBuffer> FrameBufferRef;
+
+class FrameBufferPool
+{
+public:
+    enum { Alignment = 64 };
+    /*!
+     * \brief get
+     * Get a block of at least size bytes. Sizes are rounded up to a size class (4 classes for each power of 2),
+     * so frames of the same size and similar sizes share the cached blocks.
+     * \return null if out of memory
+     */
+    static FrameBufferRef get(int size);
+    static void stats(qint64* hits, qint64* misses, qint64* cachedBytes);
+    /// free all cached blocks
+    static void clear();
+};
+} //namespace QtAV
+#endif // QTAV_FRAMEBUFFERPOOL_H
@@ -0,0 +1,143 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "FrameCopy.h"
+#include <stdint.h>
+#include <string.h> //memcpy
+#include <QtCore/QAtomicInt>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVarLengthArray>
+#include "QtAV/QtAV_Global.h"
+#include "GPUMemCopy.h"
+
+#ifndef Q_PROCESSOR_X86 // qt4
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64)
+#define Q_PROCESSOR_X86
+#endif
+#endif
+
+namespace QtAV {
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+void CopyStream_SSE2(uint8_t *dst, const uint8_t *src, size_t size);
+#endif
+
+Q_GLOBAL_STATIC(QThreadPool, frameCopyThreadPool)
+
+namespace {
+static const size_t kParallelMin = 2*1024*1024; // smaller frames are copied by the caller. 1080p nv12 is about 3MB
+static const size_t kChunkMin = 1024*1024;
+static const size_t kNonTemporalMin = 4*1024*1024; // larger than L2 and a good part of L3. output is not read back soon
+
+enum CopyMode { CopyCached, CopyStream, CopyGPU };
+
+static void copyBytes(void *dst, const void *src, size_t size, CopyMode mode)
+{
+    switch (mode) {
+    case CopyGPU:
+        gpu_memcpy(dst, src, size);
+        return;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    case CopyStream:
+        CopyStream_SSE2((uint8_t*)dst, (const uint8_t*)src, size);
+        return;
+#endif
+    default:
+        memcpy(dst, src, size);
+        return;
+    }
+}
+
+struct CopyJob {
+    // chunk offsets are multiples of 64 inside a plane, so the alignment required by the streaming loads/stores of gpu_memcpy is kept
+    QVarLengthArray<PlaneCopy, 32> chunks;
+    QAtomicInt next;
+    CopyMode mode;
+
+    void run() {
+        int i = 0;
+        while ((i = next.fetchAndAddOrdered(1)) < chunks.size()) {
+            const PlaneCopy &c = chunks[i];
+            copyBytes(c.dst, c.src, c.size, mode);
+        }
+    }
+};
+
+class CopyTask : public QRunnable {
+public:
+    CopyTask(CopyJob *job, QSemaphore *done) : m_job(job), m_done(done) {}
+    void run() Q_DECL_OVERRIDE {
+        m_job->run();
+        m_done->release();
+    }
+private:
+    CopyJob *m_job;
+    QSemaphore *m_done;
+};
+} //namespace
+
+void frame_memcpy(const PlaneCopy *planes, int count, bool gpu)
+{
+    size_t total = 0;
+    for (int i = 0; i < count; ++i)
+        total += planes[i].size;
+    CopyMode mode = gpu ? CopyGPU : CopyCached;
+#if QTAV_HAVE(SSE2) && defined(Q_PROCESSOR_X86)
+    if (!gpu && total >= kNonTemporalMin && detect_sse2())
+        mode = CopyStream;
+#endif
+    // memory bandwidth is saturated by a few threads
+    const int threads = qBound(1, QThread::idealThreadCount(), 4);
+    if (total < kParallelMin || threads <= 1) {
+        for (int i = 0; i < count; ++i)
+            copyBytes(planes[i].dst, planes[i].src, planes[i].size, mode);
+        return;
+    }
+    // 2 chunks per thread to balance planes of different size
+    size_t chunk = qMax(kChunkMin, total/size_t(threads*2));
+    chunk = (chunk + 63) & ~(size_t)63;
+    CopyJob job;
+    job.mode = mode;
+    for (int i = 0; i < count; ++i) {
+        for (size_t offset = 0; offset < planes[i].size; offset += chunk) {
+            PlaneCopy c;
+            c.dst = (uchar*)planes[i].dst + offset;
+            c.src = (const uchar*)planes[i].src + offset;
+            c.size = qMin(chunk, planes[i].size - offset);
+            job.chunks.append(c);
+        }
+    }
+    QSemaphore done;
+    int helpers = 0;
+    for (int t = 1; t < qMin(threads, job.chunks.size()); ++t) {
+        CopyTask *task = new CopyTask(&job, &done);
+        if (!frameCopyThreadPool()->tryStart(task)) { // busy. the caller copies the rest
+            delete task;
+            break;
+        }
+        ++helpers;
+    }
+    job.run();
+    done.acquire(helpers);
+}
+} //namespace QtAV
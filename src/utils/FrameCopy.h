@@ -0,0 +1,43 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_FRAMECOPY_H
+#define QTAV_FRAMECOPY_H
+
+#include <stddef.h>
+
+namespace QtAV {
+
+struct PlaneCopy {
+    void *dst;
+    const void *src;
+    size_t size;
+};
+/*!
+ * \brief frame_memcpy
+ * Copy the planes of a frame. Large frames are split into chunks copied by a few pool threads and the caller in parallel,
+ * with non-temporal stores if the frame is larger than the cache. Small frames are copied by the caller with memcpy,
+ * so the data stays in cache for the next processing step.
+ * \param gpu sources are uncacheable GPU memory. gpu_memcpy() is used for each chunk
+ */
+void frame_memcpy(const PlaneCopy *planes, int count, bool gpu = false);
+} //namespace QtAV
+#endif // QTAV_FRAMECOPY_H
@@ -0,0 +1,54 @@
+/******************************************************************************
+    QtAV:  Multimedia framework based on Qt and FFmpeg
+    Copyright (C) 2012-2022 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+#if defined(__SSE__) || defined(_M_IX86) || defined(_M_X64) // gcc, clang defines __SSE__, vc does not
+#include <stdint.h>
+#include <string.h>
+#include <emmintrin.h>
+
+namespace QtAV {
+
+// copy with non-temporal stores which bypass the cache. the head and tail of unaligned dst are copied by memcpy
+void CopyStream_SSE2(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+    if (head > size)
+        head = size;
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+    const size_t n = size & ~(size_t)63;
+    for (size_t i = 0; i < n; i += 64) {
+        const __m128i x0 = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i x1 = _mm_loadu_si128((const __m128i*)(src + i + 16));
+        const __m128i x2 = _mm_loadu_si128((const __m128i*)(src + i + 32));
+        const __m128i x3 = _mm_loadu_si128((const __m128i*)(src + i + 48));
+        _mm_stream_si128((__m128i*)(dst + i), x0);
+        _mm_stream_si128((__m128i*)(dst + i + 16), x1);
+        _mm_stream_si128((__m128i*)(dst + i + 32), x2);
+        _mm_stream_si128((__m128i*)(dst + i + 48), x3);
+    }
+    _mm_sfence(); // streaming stores are weakly ordered
+    memcpy(dst + n, src + n, size - n);
+}
+
+} //namespace QtAV
+#endif
@@ -48,6 +48,9 @@ private:
 };
 
 void* gpu_memcpy(void* dst, const void* src, size_t size);
+// runtime cpu detection. check Q_PROCESSOR_X86 before calling them
+bool detect_sse2();
+bool detect_sse4();
 
 } //namespace QtAV
 
@@ -0,0 +1,104 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtCore/qmath.h>
+#include <QtAV/AudioFrame.h>
+#include <QtAV/AudioResampler.h>
+
+using namespace QtAV;
+
+static AudioFormat makeFormat(AudioFormat::SampleFormat f, int channels)
+{
+    AudioFormat af;
+    af.setSampleRate(48000);
+    af.setSampleFormat(f);
+    af.setChannels(channels);
+    return af;
+}
+
+// benchmark AudioFrame::to() fast path against AudioResampler. default input is 8 channels 48kHz float planar. usage: audioremix [-n frames] [-samples 1024]
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int count = 2000;
+    int samples = 1024;
+    int idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = a.arguments().at(idx + 1).toInt();
+    idx = a.arguments().indexOf(QLatin1String("-samples"));
+    if (idx > 0)
+        samples = a.arguments().at(idx + 1).toInt();
+    struct {
+        AudioFormat::SampleFormat in;
+        int in_channels;
+        AudioFormat::SampleFormat out;
+        int out_channels;
+        const char* name;
+    } cases[] = {
+        { AudioFormat::SampleFormat_FloatPlanar, 8, AudioFormat::SampleFormat_Signed16, 2, "7.1 fltp => stereo s16" },
+        { AudioFormat::SampleFormat_FloatPlanar, 8, AudioFormat::SampleFormat_Float, 2, "7.1 fltp => stereo flt" },
+        { AudioFormat::SampleFormat_FloatPlanar, 8, AudioFormat::SampleFormat_Float, 8, "7.1 fltp => 7.1 flt" },
+        { AudioFormat::SampleFormat_Signed16Planar, 8, AudioFormat::SampleFormat_Signed16, 8, "7.1 s16p => 7.1 s16" },
+        { AudioFormat::SampleFormat_FloatPlanar, 6, AudioFormat::SampleFormat_Signed16, 2, "5.1 fltp => stereo s16" },
+        { AudioFormat::SampleFormat_FloatPlanar, 1, AudioFormat::SampleFormat_Float, 2, "mono fltp => stereo flt" },
+    };
+    qDebug("%d frames, %d samples per channel", count, samples);
+    for (size_t c = 0; c < sizeof(cases)/sizeof(cases[0]); ++c) {
+        const AudioFormat in(makeFormat(cases[c].in, cases[c].in_channels));
+        const AudioFormat out(makeFormat(cases[c].out, cases[c].out_channels));
+        // a sine of different frequency per channel
+        QByteArray data(in.bytesPerFrame()*samples, 0);
+        const int bps = in.bytesPerSample();
+        for (int ch = 0; ch < in.channels(); ++ch) {
+            for (int i = 0; i < samples; ++i) {
+                const float v = 0.5f*qSin(float(i*(ch + 1))*0.01f);
+                char *p = data.data() + (ch*samples + i)*bps;
+                if (in.isFloat())
+                    *(float*)p = v;
+                else
+                    *(qint16*)p = qint16(v*32767.0f);
+            }
+        }
+        AudioFrame frame(in, data);
+        frame.setSamplesPerChannel(samples);
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray fast;
+        for (int i = 0; i < count; ++i)
+            fast = frame.to(out).data();
+        const qint64 fast_ms = qMax<qint64>(1, timer.elapsed());
+
+        AudioResampler *conv = AudioResampler::create(AudioResamplerId_FF);
+        if (!conv)
+            conv = AudioResampler::create(AudioResamplerId_Libav);
+        if (!conv) {
+            qWarning("no audio resampler is available");
+            return 1;
+        }
+        conv->setInAudioFormat(in);
+        conv->setOutAudioFormat(out);
+        conv->setInSampesPerChannel(samples);
+        const quint8* planes[8];
+        for (int i = 0; i < in.planeCount(); ++i)
+            planes[i] = frame.constBits(i);
+        timer.restart();
+        for (int i = 0; i < count; ++i)
+            conv->convert(planes);
+        const qint64 ref_ms = qMax<qint64>(1, timer.elapsed());
+        const QByteArray ref(conv->outData());
+        delete conv;
+        // compare the outputs
+        double maxdiff = 0;
+        const int n = qMin(fast.size(), ref.size())/out.bytesPerSample();
+        for (int i = 0; i < n; ++i) {
+            const double x = out.isFloat() ? ((const float*)fast.constData())[i] : ((const qint16*)fast.constData())[i]/32768.0;
+            const double y = out.isFloat() ? ((const float*)ref.constData())[i] : ((const qint16*)ref.constData())[i]/32768.0;
+            maxdiff = qMax(maxdiff, qAbs(x - y));
+        }
+        printf("%s: fast path %.1f frames/s, swresample %.1f frames/s, speedup %.2fx, size %d/%d, max diff %g\n", cases[c].name
+               , count*1000.0/fast_ms, count*1000.0/ref_ms, double(ref_ms)/double(fast_ms), fast.size(), ref.size(), maxdiff);
+        fflush(0);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QStringList>
+#include <QtAV/LibAVFilter.h>
+#include <QtAV/VideoFrame.h>
+
+using namespace QtAV;
+
+// check timestamps of libavfilter outputs whose time base is not the input one. usage: avfilter [-f yadif=1] [-n frames]
+// yadif=1 outputs 2 fields per frame in 1/2 input time base, so output timestamps must be in 1/2 frame interval
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QString options = QStringLiteral("yadif=1");
+    int count = 25;
+    int idx = a.arguments().indexOf(QLatin1String("-f"));
+    if (idx > 0)
+        options = a.arguments().at(idx + 1);
+    idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = a.arguments().at(idx + 1).toInt();
+    const int w = 320, h = 240;
+    const qreal t0 = 1.0, dt = 0.04;
+    VideoFormat fmt(VideoFormat::Format_YUV420P);
+    int bytes = 0;
+    for (int i = 0; i < fmt.planeCount(); ++i)
+        bytes += fmt.bytesPerLine(fmt.width(w, i), i)*fmt.height(h, i);
+    QByteArray data(bytes, 0);
+    VideoFrame frame(w, h, fmt, data);
+    uchar *p = (uchar*)data.data();
+    for (int i = 0; i < fmt.planeCount(); ++i) {
+        const int stride = fmt.bytesPerLine(fmt.width(w, i), i);
+        frame.setBits(p, i);
+        frame.setBytesPerLine(stride, i);
+        for (int y = 0; y < frame.planeHeight(i); ++y)
+            memset(p + y*stride, (y & 1) ? 16 : 235, stride);
+        p += stride*frame.planeHeight(i);
+    }
+    LibAVFilterVideo f;
+    f.setOptions(options);
+    QList<qreal> ts;
+    for (int i = 0; i < count; ++i) {
+        frame.setTimestamp(t0 + qreal(i)*dt);
+        QList<VideoFrame> out;
+        f.apply(0, frame, out);
+        foreach (const VideoFrame& o, out)
+            ts.append(o.timestamp());
+    }
+    qDebug() << options << "input frames:" << count << "output frames:" << ts.size();
+    int errors = 0;
+    if (ts.size() < count) { // yadif keeps 1 frame
+        qWarning("too few output frames: %d", ts.size());
+        ++errors;
+    }
+    if (!ts.isEmpty() && qAbs(ts.first() - t0) > 0.001) {
+        qWarning("first timestamp %.6f, expect %.6f", ts.first(), t0);
+        ++errors;
+    }
+    for (int i = 1; i < ts.size(); ++i) {
+        const qreal d = ts.at(i) - ts.at(i-1);
+        if (qAbs(d - dt/2.0) > 0.001) {
+            qWarning("timestamp %d: %.6f - %.6f = %.6f, expect %.6f", i, ts.at(i), ts.at(i-1), d, dt/2.0);
+            ++errors;
+        }
+    }
+    printf("%s\n", errors ? "FAIL" : "PASS");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/AudioOutput.h>
+#include <QtAV/ClockGroup.h>
+
+using namespace QtAV;
+
+// play files in a clock group without renderers and print inter-player skew statistics every second.
+// seeks to the middle of the duration once. usage: clockgroup [-t seconds] [-hz refresh_rate] file1 file2 ...
+class Monitor : public QObject
+{
+public:
+    Monitor(ClockGroup *group, int seconds) : m_group(group), m_seconds(seconds), m_elapsed(0) {
+        startTimer(1000);
+    }
+protected:
+    void timerEvent(QTimerEvent *) {
+        const ClockGroup::SkewStatistics s = m_group->skewStatistics();
+        qDebug("%.3fs skew current/avg/max: %.2f/%.2f/%.2fms samples: %lld drops: %lld repeats: %lld"
+               , m_group->value(), s.current*1000.0, s.average*1000.0, s.maximum*1000.0, s.samples, s.drops, s.repeats);
+        if (++m_elapsed == m_seconds/2) {
+            const qint64 pos = m_group->players().first()->duration()/2;
+            qDebug("seek to %lld", pos);
+            m_group->seek(pos);
+        } else if (m_elapsed >= m_seconds) {
+            m_group->stop();
+            qApp->quit();
+        }
+    }
+private:
+    ClockGroup *m_group;
+    int m_seconds;
+    int m_elapsed;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QStringList args = a.arguments();
+    args.removeFirst();
+    int seconds = 10;
+    int idx = args.indexOf(QLatin1String("-t"));
+    if (idx >= 0) {
+        seconds = args.at(idx + 1).toInt();
+        args.erase(args.begin() + idx, args.begin() + idx + 2);
+    }
+    qreal hz = 60;
+    idx = args.indexOf(QLatin1String("-hz"));
+    if (idx >= 0) {
+        hz = args.at(idx + 1).toDouble();
+        args.erase(args.begin() + idx, args.begin() + idx + 2);
+    }
+    if (args.isEmpty()) {
+        qWarning("usage: clockgroup [-t seconds] [-hz refresh_rate] file1 file2 ...");
+        return 1;
+    }
+    ClockGroup group;
+    group.setRefreshRate(hz);
+    foreach (const QString& file, args) {
+        AVPlayer *player = new AVPlayer(&group);
+        player->audio()->setBackends(QStringList() << QStringLiteral("null"));
+        player->setFile(file);
+        group.addPlayer(player);
+    }
+    QObject::connect(&group, SIGNAL(started()), &group, SLOT(resetStatistics()));
+    Monitor monitor(&group, seconds);
+    group.play();
+    return a.exec();
+}
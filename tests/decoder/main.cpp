@@ -9,9 +9,57 @@
 
 using namespace QtAV;
 
+// the discard levels must never decrease as the decoder gets slower, and only key frames are decoded from nbSkip. return false if failed
+static bool testSlowDiscardLevel(int nbFrameDrop, int nbSkip)
+{
+    bool ok = true;
+    bool graded = false; // loop filter is discarded before decoding key frames only
+    VideoDecoder::DiscardLevel last_frames = VideoDecoder::DiscardDefault, last_loop = VideoDecoder::DiscardDefault;
+    for (int slow = 0; slow <= nbSkip + 5; ++slow) {
+        VideoDecoder::DiscardLevel frames, loop_filter;
+        VideoDecoder::slowDiscardLevel(slow, nbFrameDrop, nbSkip, &frames, &loop_filter);
+        if (slow < nbFrameDrop && (frames != VideoDecoder::DiscardDefault || loop_filter != VideoDecoder::DiscardDefault)) {
+            printf("slow discard level: %d/%d slow frames discards frames: %d, loop filter: %d\n", slow, nbFrameDrop, frames, loop_filter);
+            ok = false;
+        }
+        if (slow == nbFrameDrop && frames != VideoDecoder::DiscardNonRef) {
+            printf("slow discard level: %d slow frames. expect non-ref frames discarded, got %d\n", slow, frames);
+            ok = false;
+        }
+        if (slow >= nbSkip && frames != VideoDecoder::DiscardNonKey) {
+            printf("slow discard level: %d/%d slow frames. expect key frames only, got %d\n", slow, nbSkip, frames);
+            ok = false;
+        }
+        if (frames < last_frames || loop_filter < last_loop) {
+            printf("slow discard level: %d slow frames. level decreased. frames: %d=>%d, loop filter: %d=>%d\n", slow, last_frames, frames, last_loop, loop_filter);
+            ok = false;
+        }
+        if (frames > VideoDecoder::DiscardNonKey || loop_filter > VideoDecoder::DiscardNonKey) {
+            printf("slow discard level: %d slow frames. key frames are discarded\n", slow);
+            ok = false;
+        }
+        if (frames < VideoDecoder::DiscardNonKey && loop_filter > VideoDecoder::DiscardDefault)
+            graded = true;
+        last_frames = frames;
+        last_loop = loop_filter;
+    }
+    if (!graded) {
+        printf("slow discard level: no level between non-ref frames and key frames only\n");
+        ok = false;
+    }
+    printf("slow discard level: frame drop %d, skip %d. %s\n", nbFrameDrop, nbSkip, ok ? "ok" : "failed");
+    return ok;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
+    // same as VideoThread, and 1 frame per level
+    if (!testSlowDiscardLevel(10, 20) || !testSlowDiscardLevel(10, 14)) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
     QString file = QString::fromLatin1("test.avi");
     int idx = a.arguments().indexOf(QLatin1String("-f"));
     if (idx > 0)
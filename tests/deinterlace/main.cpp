@@ -0,0 +1,127 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <stdio.h>
+#include <string.h>
+#include <QtAV/DeinterlaceFilter.h>
+#include <QtAV/VideoFrame.h>
+
+using namespace QtAV;
+
+// 3:2 pulldown of moving film frames. the frames after inverse telecine must be the film frames. return false if failed
+static bool testInverseTelecine(int w, int h)
+{
+    const VideoFormat fmt(VideoFormat::Format_YUV420P);
+    const int nb_film = 40; // 50 video frames
+    // film frame k: a different horizontal ramp. the same rows in a frame
+#define FILM_PIXEL(K, X) uchar((X)*4 + (K)*40)
+    DeinterlaceFilter f;
+    f.setInverseTelecine(true);
+    static const int kPulldown[5][2] = { {0, 0}, {1, 1}, {1, 2}, {2, 3}, {3, 3} }; // film frame of top, bottom field
+    int nb_out = 0;
+    qreal last_ts = -1;
+    bool ok = true;
+    for (int i = 0; i < nb_film*5/4; ++i) {
+        VideoFrame frame(VideoFrame::allocate(fmt, w, h));
+        const int k_top = i/5*4 + kPulldown[i%5][0];
+        const int k_bottom = i/5*4 + kPulldown[i%5][1];
+        for (int y = 0; y < h; ++y) {
+            uchar *p = frame.bits(0) + y*frame.bytesPerLine(0);
+            for (int x = 0; x < w; ++x)
+                p[x] = FILM_PIXEL((y & 1) ? k_bottom : k_top, x);
+        }
+        for (int c = 1; c < 3; ++c)
+            memset(frame.bits(c), 128, frame.bytesPerLine(c)*frame.planeHeight(c));
+        frame.setTimestamp(qreal(i)/30.0);
+        frame.setMetaData(QStringLiteral("interlaced"), true);
+        frame.setMetaData(QStringLiteral("top_field_first"), true);
+        QList<VideoFrame> out;
+        f.apply(0, frame, out);
+        foreach (const VideoFrame& o, out) {
+            ++nb_out;
+            if (o.timestamp() <= last_ts) {
+                printf("inverse telecine: timestamp %.3f after %.3f\n", o.timestamp(), last_ts);
+                ok = false;
+            }
+            last_ts = o.timestamp();
+            const uchar *p0 = o.constBits(0);
+            const uchar *p1 = o.constBits(0) + o.bytesPerLine(0);
+            if (memcmp(p0, p1, w)) {
+                printf("inverse telecine: combed output frame @%.3f\n", o.timestamp());
+                ok = false;
+            }
+        }
+    }
+#undef FILM_PIXEL
+    // 2 cycles to lock the cadence, then 4 frames for every 5 frames
+    const int expected = 2*5 + (nb_film*5/4 - 2*5)*4/5;
+    printf("inverse telecine: %d video frames -> %d frames. expected %d\n", nb_film*5/4, nb_out, expected);
+    return ok && nb_out == expected;
+}
+
+// test inverse telecine and benchmark DeinterlaceFilter. default input is 1080i50 yuv420p. usage: deinterlace [-n frames] [-fmt nv12] [-size 1920x1080]
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int count = 200;
+    int w = 1920, h = 1080;
+    VideoFormat fmt(VideoFormat::Format_YUV420P);
+    int idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = a.arguments().at(idx + 1).toInt();
+    idx = a.arguments().indexOf(QLatin1String("-fmt"));
+    if (idx > 0)
+        fmt = VideoFormat(a.arguments().at(idx + 1));
+    idx = a.arguments().indexOf(QLatin1String("-size"));
+    if (idx > 0) {
+        const QStringList s(a.arguments().at(idx + 1).split(QLatin1Char('x')));
+        w = s.first().toInt();
+        h = s.last().toInt();
+    }
+    // comb pattern with moving edges
+    int bytes = 0;
+    for (int i = 0; i < fmt.planeCount(); ++i)
+        bytes += fmt.bytesPerLine(fmt.width(w, i), i)*fmt.height(h, i);
+    QByteArray data(bytes, 0);
+    VideoFrame frame(w, h, fmt, data);
+    uchar *p = (uchar*)data.data();
+    for (int i = 0; i < fmt.planeCount(); ++i) {
+        const int stride = fmt.bytesPerLine(fmt.width(w, i), i);
+        frame.setBits(p, i);
+        frame.setBytesPerLine(stride, i);
+        for (int y = 0; y < frame.planeHeight(i); ++y) {
+            for (int x = 0; x < stride; ++x)
+                p[y*stride + x] = (y & 1) ? uchar(x + y) : uchar(255 - x);
+        }
+        p += stride*frame.planeHeight(i);
+    }
+    frame.setMetaData(QStringLiteral("interlaced"), true);
+    if (!testInverseTelecine(w, h)) {
+        printf("FAIL\n");
+        return 1;
+    }
+    qDebug("%dx%d %s, %d frames", w, h, fmt.name().toUtf8().constData(), count);
+    const char* modes[] = { "bob", "blend", "ela" };
+    for (int m = DeinterlaceFilter::Bob; m <= DeinterlaceFilter::EdgeAdaptive; ++m) {
+        for (int t = 1; t >= 0; --t) {
+            DeinterlaceFilter f;
+            f.setMode(DeinterlaceFilter::Mode(m));
+            f.setFieldRate(m != DeinterlaceFilter::LinearBlend);
+            f.setThreads(t);
+            int fields = 0;
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < count; ++i) {
+                frame.setTimestamp(qreal(i)*0.04);
+                QList<VideoFrame> out;
+                f.apply(0, frame, out);
+                fields += out.size();
+            }
+            const qint64 ms = qMax<qint64>(1, timer.elapsed());
+            printf("%s threads: %s, %.1f frames/s, %.1f output frames/s\n", modes[m], t == 1 ? "1" : "auto", count*1000.0/ms, fields*1000.0/ms);
+            fflush(0);
+        }
+    }
+    return 0;
+}
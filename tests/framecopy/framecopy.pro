@@ -0,0 +1,9 @@
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = framecopy
+
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+
+SOURCES += main.cpp
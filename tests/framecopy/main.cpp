@@ -0,0 +1,62 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtAV/VideoFrame.h>
+#include <string.h>
+
+using namespace QtAV;
+
+// benchmark VideoFrame::clone() and VideoFrame::fromGPU() with host memory sources against a single threaded memcpy. usage: framecopy [-n frames] [-fmt nv12]
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int count = 100;
+    VideoFormat fmt(VideoFormat::Format_NV12);
+    int idx = a.arguments().indexOf(QLatin1String("-n"));
+    if (idx > 0)
+        count = a.arguments().at(idx + 1).toInt();
+    idx = a.arguments().indexOf(QLatin1String("-fmt"));
+    if (idx > 0)
+        fmt = VideoFormat(a.arguments().at(idx + 1));
+    const QSize sizes[] = { QSize(640, 360), QSize(1920, 1080), QSize(3840, 2160), QSize(7680, 4320) };
+    qDebug("%s, %d frames", fmt.name().toUtf8().constData(), count);
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s) {
+        const int w = sizes[s].width(), h = sizes[s].height();
+        quint8 *src[3] = { 0, 0, 0 };
+        int pitch[3] = { 0, 0, 0 };
+        int bytes = 0;
+        for (int i = 0; i < fmt.planeCount(); ++i) {
+            pitch[i] = fmt.bytesPerLine(w, i);
+            bytes += pitch[i]*fmt.height(h, i);
+        }
+        QByteArray data(bytes, 1);
+        VideoFrame frame(w, h, fmt, data);
+        quint8 *p = (quint8*)data.data();
+        for (int i = 0; i < fmt.planeCount(); ++i) {
+            src[i] = p;
+            frame.setBits(p, i);
+            frame.setBytesPerLine(pitch[i], i);
+            p += pitch[i]*fmt.height(h, i);
+        }
+        QByteArray dst(bytes, 0);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < count; ++i)
+            memcpy(dst.data(), data.constData(), bytes);
+        const qint64 memcpy_ms = qMax<qint64>(1, timer.restart());
+        for (int i = 0; i < count; ++i)
+            frame.clone();
+        const qint64 clone_ms = qMax<qint64>(1, timer.restart());
+        for (int i = 0; i < count; ++i) {
+            int pitch_copy[3] = { pitch[0], pitch[1], pitch[2] };
+            quint8 *src_copy[3] = { src[0], src[1], src[2] };
+            VideoFrame::fromGPU(fmt, w, h, h, src_copy, pitch_copy, true);
+        }
+        const qint64 gpu_ms = qMax<qint64>(1, timer.elapsed());
+        const double mb = double(bytes)*count/1024.0/1024.0;
+        printf("%dx%d: memcpy %.0f MB/s, clone %.0f MB/s, fromGPU %.0f MB/s\n", w, h, mb*1000.0/memcpy_ms, mb*1000.0/clone_ms, mb*1000.0/gpu_ms);
+        fflush(0);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtAV/QualityGovernor.h>
+
+using namespace QtAV;
+
+// synthetic load generator for QualityGovernor policies. no decoding. every step is 1 governor interval:
+// cpu usage and lateness of the tiles are computed from the cost of their current levels, then the policy runs once.
+// usage: governor [-tiles n] [-cores n] [-steps n]
+struct Tile {
+    QObject owner;
+    int id;
+    qreal cost; // cores used at full quality
+};
+
+// relative cost of each level. lowres is about 1/4 decoding, half rate saves the presentation, key frames only decodes a few frames
+static const qreal kLevelCost[] = { 1.0, 0.7, 0.35, 0.28, 0.05 };
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int nb_tiles = 9;
+    int cores = 8;
+    int steps = 60;
+    int idx = a.arguments().indexOf(QLatin1String("-tiles"));
+    if (idx > 0)
+        nb_tiles = a.arguments().at(idx + 1).toInt();
+    idx = a.arguments().indexOf(QLatin1String("-cores"));
+    if (idx > 0)
+        cores = a.arguments().at(idx + 1).toInt();
+    idx = a.arguments().indexOf(QLatin1String("-steps"));
+    if (idx > 0)
+        steps = a.arguments().at(idx + 1).toInt();
+
+    QualityGovernor &g = QualityGovernor::instance();
+    g.setEnabled(true);
+    QVector<Tile*> tiles;
+    for (int i = 0; i < nb_tiles; ++i) {
+        Tile *t = new Tile();
+        t->id = g.addClient(&t->owner);
+        t->cost = 1.0; // 1 core per 1080p tile
+        // tile 0 is focused, the last third are background tiles
+        if (i == 0)
+            g.setPriority(&t->owner, QualityGovernor::Focused);
+        else if (i >= nb_tiles*2/3)
+            g.setPriority(&t->owner, QualityGovernor::Background);
+        tiles.append(t);
+    }
+    for (int s = 0; s < steps; ++s) {
+        // the focused tile switches to 4k in the middle, and back later
+        if (s == steps/3)
+            tiles[0]->cost = 4.0;
+        else if (s == steps*2/3)
+            tiles[0]->cost = 1.0;
+        qreal load = 0;
+        foreach (Tile *t, tiles) {
+            load += t->cost*kLevelCost[g.clientLevel(t->id)];
+        }
+        load /= qreal(cores);
+        g.setCpuUsage(qMin<qreal>(1.0, load));
+        // all tiles are late if overloaded
+        const qreal late = load > 1.0 ? (load - 1.0)*0.5 : 0.0;
+        foreach (Tile *t, tiles) {
+            for (int i = 0; i < 10; ++i)
+                g.reportLateness(t->id, late);
+        }
+        g.evaluate();
+        QString levels;
+        foreach (Tile *t, tiles) {
+            levels.append(QString::number(g.clientLevel(t->id)));
+        }
+        qDebug("step %2d load: %.2f late: %.3f levels: %s", s, load, late, levels.toLatin1().constData());
+    }
+    foreach (Tile *t, tiles) {
+        g.removeClient(t->id);
+        delete t;
+    }
+    return 0;
+}
@@ -2,7 +2,13 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     ao \
+    audioremix \
+    avfilter \
+    clockgroup \
     decoder \
+    deinterlace \
+    framecopy \
+    governor \
     subtitle \
     transcode
 